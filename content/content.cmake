@@ -9,7 +9,10 @@ function(copy_resources_to_target TARGET_NAME)
         add_custom_command(TARGET ${TARGET_NAME} POST_BUILD
                 COMMAND ${CMAKE_COMMAND} -E copy_directory
                 ${CONTENT_DIR}/resources ${RESOURCES_DEST_DIR}
+                # Compila os scripts Luau para bytecode, builds de release não compilam em tempo de execução
+                COMMAND $<TARGET_FILE:runtime_cook> ${CONTENT_DIR}/resources/scripts ${RESOURCES_DEST_DIR}/scripts
                 COMMENT "Copiando recursos para o diretório do executável"
         )
+        add_dependencies(${TARGET_NAME} runtime_cook)
     endif()
 endfunction()
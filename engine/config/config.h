@@ -1,6 +1,9 @@
 /* Build Data */
 #define ENGINE_BUILD_DEBUG
 /* #undef ENGINE_BUILD_RELEASE */
+#define ENGINE_PROFILER
+/* #undef ENGINE_ALLOCATION_TRACKER */
+#define ENGINE_SCRIPT_COMPILER
 
 /* Engine Data */
 #define ENGINE_NAME "Runa"
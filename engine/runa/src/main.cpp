@@ -3,15 +3,61 @@
 #include <memory>
 #include <runtime.h>
 #include <opengl/mesh.h>
+#include <ecs/transforms.h>
+#include <models/glft.h>
+#include <animation/animator.h>
+#include <scripting/script_scheduler.h>
 #include <utils/system.h>
 #include <settings.h>
 #include <io/handlers.h>
+#include <utils/logs.h>
 
 using namespace runa::runtime;
 using namespace runa::runtime::opengl;
 
 int main(int argc, char** argv) {
-    if (!render.init()) return -1;
+    // --headless renders offscreen without a display, --dump <dir> writes every frame as PNG,
+    // --frames <n> quits after n frames, --render-thread draws on a separate thread,
+    // --profile <file> records from the start and writes a Chrome trace on exit,
+    // --gpu-budget <MB> warns once tracked GPU memory goes over it,
+    // --record <file> saves the input of the run, --replay <file> plays one back at its recorded frame rate and quits,
+    // --wait only runs a frame when there is input or libuv work, --background-idle sleeps while unfocused,
+    // --fibers runs jobs on fibers so a job waiting on others parks instead of holding its worker,
+    // --model <file> draws a glTF model and plays the first animation of each skinned mesh
+    EDriver driver = core;
+    bool renderThread = false;
+    const char* dumpDirectory = nullptr;
+    const char* tracePath = nullptr;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* modelPath = nullptr;
+    uint64_t frameCount = 0;
+    io::EEventMode eventMode = io::pool;
+    jobs::EJobMode jobMode = jobs::threads;
+    for (int i = 1; i < argc; i++)
+    {
+        if (SDL_strcmp(argv[i], "--headless") == 0) driver = headless;
+        else if (SDL_strcmp(argv[i], "--render-thread") == 0) renderThread = true;
+        else if (SDL_strcmp(argv[i], "--dump") == 0 && i + 1 < argc) dumpDirectory = argv[++i];
+        else if (SDL_strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frameCount = SDL_strtoull(argv[++i], nullptr, 10);
+        else if (SDL_strcmp(argv[i], "--profile") == 0 && i + 1 < argc) tracePath = argv[++i];
+        else if (SDL_strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (SDL_strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replayPath = argv[++i];
+        else if (SDL_strcmp(argv[i], "--wait") == 0) eventMode = io::wait;
+        else if (SDL_strcmp(argv[i], "--fibers") == 0) jobMode = jobs::fibers;
+        else if (SDL_strcmp(argv[i], "--model") == 0 && i + 1 < argc) modelPath = argv[++i];
+        else if (SDL_strcmp(argv[i], "--background-idle") == 0) event.setIdleWhenUnfocused(true);
+        else if (SDL_strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc) gpuMemory.setTotalBudget(SDL_strtoull(argv[++i], nullptr, 10) << 20);
+    }
+    if (tracePath) profiler.setEnabled(true);
+    gpuMemory.onBudgetExceeded = [](uint8_t category, size_t bytes, size_t budget) {
+        const char* name = category < GpuMemoryStats::categories ? GpuMemory::categoryName((EGpuMemoryCategory)category) : "Total";
+        utils::Logs::warning("%s GPU memory over budget: %.1f of %.1f MB", name, bytes / 1048576.0, budget / 1048576.0);
+    };
+
+    if (!render.init(driver)) return -1;
+    if (!jobSystem.init(0, jobMode)) return -1;
+    if (!event.init()) return -1;
     //gameUserSettings.setVsync(disable);
     //gameUserSettings.setFramerateLimit(300);
 
@@ -78,12 +124,12 @@ int main(int argc, char** argv) {
 	// Texture data
 	std::string albedodir = currentDir + "resources/textures/planks.png";
 	std::string speculardir = currentDir + "resources/textures/planksSpec.png";
-    std::vector<Texture> textures;
-    textures.push_back(Texture());
-    textures.push_back(Texture());
-    if (!textures[0].init(albedodir.c_str(), "diffuse", 0, 0, GL_UNSIGNED_BYTE))
+    std::vector<resources::TextureHandle> textures;
+    textures.push_back(resourceManager.loadTexture(albedodir.c_str(), "diffuse"));
+    textures.push_back(resourceManager.loadTexture(speculardir.c_str(), "specular"));
+    if (!resourceManager.get(textures[0]))
         return -1;
-    if(!textures[1].init(speculardir.c_str(), "specular", 1, 0, GL_UNSIGNED_BYTE))
+    if (!resourceManager.get(textures[1]))
         return -1;
 
     std::string vertShader = currentDir + "resources/shaders/default.vert";
@@ -120,62 +166,181 @@ int main(int argc, char** argv) {
 
     glm::vec4 lightColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
     glm::vec3 lightPos = glm::vec3(0.5f, 0.5f, 0.5f);
-    glm::mat4 lightModel = glm::identity<glm::mat4>();
-    lightModel = glm::translate(lightModel, lightPos);
 
-    glm::vec3 pyramidPos = glm::vec3(0.0f, 0.0f, 0.0f);
-    glm::mat4 pyramidModel = glm::identity<glm::mat4>();
-    pyramidModel = glm::translate(pyramidModel, pyramidPos);
+    // Everything drawn is an entity, model matrices come from its LocalToWorld
+    ecs::World scene;
+    ecs::TransformSystem transforms;
+    ecs::Transform lightTransform;
+    lightTransform.position = lightPos;
+    scene.create(ecs::Transform(), ecs::LocalToWorld(), ecs::MeshRenderer{ &floor, &shader });
+    ecs::Entity lightEntity = scene.create(lightTransform, ecs::LocalToWorld(), ecs::MeshRenderer{ &light, &lightShader });
+
+    // Scripts step with the fixed update, replays see the same deltas. Their writes land in script
+    // order whatever the worker count
+    scripting::ScriptScheduler scripts;
+    if (!scripts.init(&scene, &jobSystem)) return -1;
+    std::string lightScript = currentDir + "resources/scripts/light.luau";
+    scripts.load(lightScript.c_str(), lightEntity);
+
+    // Skinned meshes play their skeleton's first clip, the animators skin on the workers every frame
+    models::gltf model;
+    animation::AnimationSystem animations;
+    if (modelPath)
+    {
+        if (!model.init(modelPath)) return -1;
+        for (size_t i = 0; i < model.getMeshes().size(); i++)
+        {
+            animation::Animator* animator = model.getAnimator(i);
+            if (!animator) continue;
+            const std::vector<animation::AnimationClip>& clips = model.getClips(model.getMeshSkin(i));
+            if (!clips.empty()) animator->play(&clips[0]);
+            animations.add(animator);
+        }
+    }
 
     lightShader.use();
-    glUniformMatrix4fv(glGetUniformLocation(lightShader.getID(), "model"), 1, GL_FALSE, glm::value_ptr(lightModel));
     glUniform4f(glGetUniformLocation(lightShader.getID(), "lightColor"), lightColor.x, lightColor.y, lightColor.z, lightColor.w);
     shader.use();
-    glUniformMatrix4fv(glGetUniformLocation( shader.getID(), "model"), 1, GL_FALSE, glm::value_ptr(pyramidModel));
     glUniform4f(glGetUniformLocation( shader.getID(), "lightColor"), lightColor.x, lightColor.y, lightColor.z, lightColor.w);
     glUniform3f(glGetUniformLocation( shader.getID(), "lightPos"), lightPos.x, lightPos.y, lightPos.z);
 
     bool shouldClose = false;
-    event.onEvent = [&](SDL_Event &e) {
-        if (e.type == SDL_EVENT_WINDOW_RESIZED)
+    event.subscribe(SDL_EVENT_QUIT, [&](SDL_Event &e) { shouldClose = true; });
+    event.subscribe(SDL_EVENT_MOUSE_MOTION, [&](SDL_Event &e) { camera.inputs(e); });
+    render.onImGuiRender = [&](ImGuiIO &io) {
+        ImGui::Begin("teste");
+        ImGui::Text("FPS: %f", 1.0f / io.DeltaTime);
+        resources::ResourceStats stats = resourceManager.getStats();
+        ImGui::Text("Textures: %zu (%zu loading, %zu failed) refs: %zu", stats.textures, stats.texturesLoading, stats.texturesFailed, stats.textureRefs);
+        ImGui::Text("Meshes: %zu refs: %zu", stats.meshes, stats.meshRefs);
+        ImGui::Text("Cache hits/misses: textures %llu/%llu meshes %llu/%llu",
+            (unsigned long long)stats.textureHits, (unsigned long long)stats.textureMisses,
+            (unsigned long long)stats.meshHits, (unsigned long long)stats.meshMisses);
+        jobs::JobStats jobStats = jobSystem.getStats();
+        ImGui::Text("Jobs: %u workers, %llu executed, %llu stolen", jobSystem.getWorkerCount(),
+            (unsigned long long)jobStats.executed, (unsigned long long)jobStats.stolen);
+        RenderStats renderStats = render.getStats();
+        ImGui::Text("Render %s: frame %.2f ms record %.2f ms wait %.2f ms draw %.2f ms latency %.2f ms",
+            render.getMode() == threaded ? "threaded" : "immediate",
+            renderStats.frameNS / 1e6, renderStats.recordNS / 1e6, renderStats.waitNS / 1e6,
+            renderStats.executeNS / 1e6, renderStats.latencyNS / 1e6);
+        FramePacingStats pacing = render.getPacingStats();
+        ImGui::Text("Frame pacing: p50 %.2f p95 %.2f p99 %.2f max %.2f jitter %.2f ms, %llu missed",
+            pacing.p50NS / 1e6, pacing.p95NS / 1e6, pacing.p99NS / 1e6, pacing.maxNS / 1e6,
+            pacing.jitterNS / 1e6, (unsigned long long)pacing.missed);
+        ImGui::Text("Simulation: %u Hz step %llu alpha %.2f dropped %.1f ms", tick.getFixedRate(),
+            (unsigned long long)tick.getStep(), tick.alpha(), tick.getDroppedNS() / 1e6);
+        io::EventStats events = event.getStats();
+        ImGui::Text("Events: %llu received, %llu motion coalesced, %llu dispatched",
+            (unsigned long long)events.received, (unsigned long long)events.coalesced, (unsigned long long)events.dispatched);
+        ImGui::Text("Loop: %llu passes, %llu over budget, %llu waits %.1f ms",
+            (unsigned long long)events.loopPasses, (unsigned long long)events.overBudget,
+            (unsigned long long)events.waits, events.waitNS / 1e6);
+        ecs::WorldStats sceneStats = scene.getStats();
+        ImGui::Text("Scene: %zu entities, %zu archetypes, %zu chunks, %u recomposed",
+            sceneStats.entities, sceneStats.archetypes, sceneStats.chunks, transforms.getUpdatedChunks());
+        scripting::ScriptStats scriptStats = scripts.getStats();
+        ImGui::Text("Scripts: %zu running on %u VMs, %zu timers, %zu KB, update %.3f ms (apply %.3f ms), %llu writes, %llu messages, %llu errors",
+            scriptStats.scripts, scriptStats.vms, scriptStats.timers, scriptStats.memoryBytes / 1024, scriptStats.updateNS / 1e6,
+            scriptStats.applyNS / 1e6, (unsigned long long)scriptStats.writes, (unsigned long long)scriptStats.messages,
+            (unsigned long long)scriptStats.errors);
+        animation::AnimationStats animationStats = animations.getStats();
+        ImGui::Text("Animation: %u animators, %llu vertices, update %.3f ms (sample %.3f blend %.3f palette %.3f skin %.3f ms)",
+            animationStats.animators, (unsigned long long)animationStats.vertices, animationStats.updateNS / 1e6,
+            animationStats.sampleNS / 1e6, animationStats.blendNS / 1e6, animationStats.paletteNS / 1e6, animationStats.skinNS / 1e6);
+        memory::ArenaStats arena = frameArenas.getStats();
+        ImGui::Text("Frame arenas: %zu/%zu KB peak %zu KB, %llu allocations, %llu heap blocks",
+            arena.used / 1024, arena.capacity / 1024, arena.peak / 1024,
+            (unsigned long long)arena.allocations, (unsigned long long)arena.heapAllocations);
+        if (memory::AllocationTracker::isCompiled())
         {
-            int viewportWidth, viewportHeight;
-            if (SDL_GetWindowSizeInPixels(render.getBackend().getWindow(), &viewportWidth, &viewportHeight))
+            memory::AllocationStats allocations = allocationTracker.getStats();
+            for (uint8_t tag = 0; tag < memory::AllocationStats::tags; tag++)
             {
-                glViewport(0, 0, viewportWidth, viewportHeight);
+                ImGui::Text("%s: %zu live (%zu KB), %llu allocations %zu KB last frame",
+                    memory::AllocationTracker::tagName((memory::EAllocationTag)tag), allocations.liveCount[tag], allocations.liveBytes[tag] / 1024,
+                    (unsigned long long)allocations.frameAllocations[tag], allocations.frameBytes[tag] / 1024);
             }
+            if (allocations.badFrees > 0) ImGui::Text("Bad frees: %llu", (unsigned long long)allocations.badFrees);
         }
-        if (e.type == SDL_EVENT_QUIT)
-        {
-            shouldClose = true;
-        }
-        camera.inputs(e);
-    };
-    render.onImGuiRender = [&](ImGuiIO &io) {
-        ImGui::Begin("teste");
-        ImGui::Text("FPS: %f", 1.0f / io.DeltaTime);
         ImGui::End();
+        render.getImGuiBackend().drawProfiler();
+        render.getImGuiBackend().drawGpuMemory();
     };
-    render.onRender= [&](double delta) {
-        shader.use();
-
-        camera.tick((float)delta);
+    // Camera moves at the fixed rate, frames in between draw it interpolated
+    glm::vec3 previousCameraPos = camera.pos;
+    tick.onFixedUpdate = [&](double step) {
+        previousCameraPos = camera.pos;
+        camera.tick((float)step);
+        scripts.update(step);
+    };
+    render.onRecord = [&](double delta, CommandBuffer& commands) {
+        glm::vec3 simulatedPos = camera.pos;
+        camera.pos = previousCameraPos + (simulatedPos - previousCameraPos) * (float)tick.alpha();
         camera.updateMatrix(60.0f, 0.1f, 100.0f);
 
-    	// Draws different meshes
-    	floor.draw(shader, camera);
-    	light.draw(lightShader, camera);
+        transforms.update(scene, &jobSystem);
+        scene.each<const ecs::LocalToWorld, const ecs::MeshRenderer>([&](ecs::Entity, const ecs::LocalToWorld& world, const ecs::MeshRenderer& renderer) {
+            commands.drawMesh(*renderer.mesh, *renderer.shader, camera, world.matrix);
+        });
+        if (modelPath)
+        {
+            animations.update((float)delta, &jobSystem);
+            model.draw(commands, shader, camera);
+        }
+        camera.pos = simulatedPos;
     };
 
+    // Everything GL is created by now, drawing can move to its own thread
+    if (renderThread && !render.setMode(threaded))
+    {
+        utils::Logs::warning("Render thread unavailable, drawing on the main thread");
+    }
+    render.dumpFrames(dumpDirectory);
+
+    io::InputRecorder& recorder = event.getRecorder();
+    if (replayPath)
+    {
+        if (!recorder.startReplay(replayPath)) return -1;
+        tick.setFrameDeltaNS(recorder.getFrameDeltaNS());
+    }
+    else if (recordPath && !recorder.startRecording(recordPath))
+    {
+        return -1;
+    }
+
     while (!shouldClose)
     {
         tick.updateCurrentTick();
-        event.run(io::pool);
-        render.poll();
+        event.run(eventMode);
+        camera.updateInputs();
+        tick.update();
+        // Nothing to see, the next run blocks instead of drawing
+        if (!event.isIdle()) render.poll();
         tick.updateDeltaTime();
+        if (frameCount > 0 && render.getFrame() >= frameCount) shouldClose = true;
+        if (recorder.isFinished()) shouldClose = true;
     }
 
+    recorder.stopRecording();
+    // Back to this thread before any GL object is destroyed
+    render.setMode(immediate);
+    if (tracePath) profiler.exportChromeTrace(tracePath);
+    scripts.deinit();
+    for (size_t i = 0; i < model.getMeshes().size(); i++) animations.remove(model.getAnimator(i));
+    model.deinit();
+    floor.deinit();
+    light.deinit();
+    for (const resources::TextureHandle& texture : textures)
+    {
+        resourceManager.release(texture);
+    }
+    resourceManager.deinit();
+    event.deinit();
+    jobSystem.deinit();
     render.deinit();
+    // Globals still hold their memory, anything past what they own is a leak
+    allocationTracker.reportLeaks();
 
     return 0;
 }
@@ -0,0 +1,260 @@
+#include "bench.h"
+#include "utils/logs.h"
+#include <SDL3/SDL.h>
+#include <simdjson.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <unordered_map>
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        double median(std::vector<double>& values)
+        {
+            std::sort(values.begin(), values.end());
+            size_t middle = values.size() / 2;
+            if (values.size() % 2 == 1) return values[middle];
+            return (values[middle - 1] + values[middle]) / 2.0;
+        }
+
+        uint64_t timeRun(const BenchFunction& function, uint64_t iterations)
+        {
+            uint64_t start = SDL_GetTicksNS();
+            function(iterations);
+            return SDL_GetTicksNS() - start;
+        }
+    }
+
+    ThreadTeam::ThreadTeam(uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++) threads.emplace_back([this, i]() { loop(i); });
+    }
+
+    ThreadTeam::~ThreadTeam()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (std::thread& thread : threads) thread.join();
+    }
+
+    void ThreadTeam::start(std::function<void(uint32_t index)> fn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            function = std::move(fn);
+            running = size();
+            arrived = 0;
+            generation++;
+        }
+        condition.notify_all();
+    }
+
+    void ThreadTeam::wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return running == 0; });
+    }
+
+    void ThreadTeam::loop(uint32_t index)
+    {
+        uint64_t seen = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this, seen]() { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+
+            // Start barrier, the last one to wake up releases the others
+            arrived.fetch_add(1);
+            while (arrived.load() < size()) std::this_thread::yield();
+            function(index);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0) condition.notify_all();
+        }
+    }
+
+    void Runner::add(std::string name, BenchSetup setup, uint64_t ops)
+    {
+        cases.push_back({ std::move(name), std::move(setup), ops });
+    }
+
+    void Runner::list() const
+    {
+        for (const BenchCase& benchCase : cases) std::printf("%s\n", benchCase.name.c_str());
+    }
+
+    int Runner::run(const BenchOptions& options)
+    {
+        std::vector<BenchResult> results;
+        bool failed = false;
+
+        std::printf("%-48s %14s %12s %12s %10s %14s\n", "case", "iterations", "median ns", "mad ns", "min ns", "ops/s");
+        for (const BenchCase& benchCase : cases)
+        {
+            if (options.filter && benchCase.name.find(options.filter) == std::string::npos) continue;
+
+            BenchFunction function = benchCase.setup();
+            if (!function)
+            {
+                utils::Logs::error("Failed to set up %s", benchCase.name.c_str());
+                failed = true;
+                continue;
+            }
+
+            BenchResult result = measure(benchCase.name, function, options);
+            result.ops = benchCase.ops;
+            if (result.ops > 0 && result.medianNS > 0.0) result.opsPerSecond = 1e9 * (double)result.ops / result.medianNS;
+            std::printf("%-48s %14llu %12.2f %12.2f %10.2f", result.name.c_str(),
+                (unsigned long long)result.iterations, result.medianNS, result.madNS, result.minNS);
+            if (result.ops > 0) std::printf(" %14.4g", result.opsPerSecond);
+            std::printf("\n");
+            std::fflush(stdout);
+            results.push_back(std::move(result));
+        }
+
+        if (options.jsonPath && !writeJson(options.jsonPath, options, results)) failed = true;
+
+        bool regressed = false;
+        if (options.baselinePath && !compare(options.baselinePath, options, results, regressed)) failed = true;
+
+        return failed || regressed ? 1 : 0;
+    }
+
+    BenchResult Runner::measure(const std::string& name, const BenchFunction& function, const BenchOptions& options)
+    {
+        // Grow the batch until one sample is long enough for the clock to not matter
+        uint64_t iterations = 1;
+        for (;;)
+        {
+            uint64_t elapsed = timeRun(function, iterations);
+            if (elapsed >= options.sampleNS) break;
+
+            uint64_t grow = elapsed > 0 ? options.sampleNS * 12 / (elapsed * 10) : 10;
+            iterations *= std::clamp<uint64_t>(grow, 2, 10);
+        }
+
+        // Caches, branch predictors and frequency scaling settle before anything is kept
+        uint64_t warmupStart = SDL_GetTicksNS();
+        while (SDL_GetTicksNS() - warmupStart < options.warmupNS) timeRun(function, iterations);
+
+        std::vector<double> samples(std::max(options.samples, 1u));
+        for (double& sample : samples) sample = (double)timeRun(function, iterations) / (double)iterations;
+
+        BenchResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.samples = (uint32_t)samples.size();
+        result.minNS = *std::min_element(samples.begin(), samples.end());
+        result.medianNS = median(samples);
+
+        // Robust to the odd preempted sample, unlike the standard deviation
+        for (double& sample : samples) sample = std::abs(sample - result.medianNS);
+        result.madNS = median(samples);
+        return result;
+    }
+
+    bool Runner::writeJson(const char* path, const BenchOptions& options, const std::vector<BenchResult>& results)
+    {
+        SDL_IOStream* file = SDL_IOFromFile(path, "w");
+        if (!file)
+        {
+            utils::Logs::sdlError();
+            return false;
+        }
+
+        SDL_IOprintf(file, "{\n  \"samples\": %u,\n  \"sampleNS\": %llu,\n  \"results\": [", options.samples,
+            (unsigned long long)options.sampleNS);
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const BenchResult& result = results[i];
+            // Case names are plain identifiers and sizes, nothing to escape
+            SDL_IOprintf(file, "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"samples\": %u, \"medianNS\": %.4f, \"madNS\": %.4f, \"minNS\": %.4f",
+                i == 0 ? "" : ",", result.name.c_str(), (unsigned long long)result.iterations, result.samples,
+                result.medianNS, result.madNS, result.minNS);
+            // Informational, baselines are compared on the times only
+            if (result.ops > 0) SDL_IOprintf(file, ", \"ops\": %llu, \"opsPerSecond\": %.4f", (unsigned long long)result.ops, result.opsPerSecond);
+            SDL_IOprintf(file, "}");
+        }
+        SDL_IOprintf(file, "\n  ]\n}\n");
+
+        if (!SDL_CloseIO(file))
+        {
+            utils::Logs::sdlError();
+            return false;
+        }
+        return true;
+    }
+
+    bool Runner::compare(const char* path, const BenchOptions& options, const std::vector<BenchResult>& results, bool& regressed)
+    {
+        simdjson::dom::parser parser;
+        simdjson::dom::element document;
+        if (auto error = parser.load(path).get(document))
+        {
+            utils::Logs::error("Failed to read baseline %s: %s", path, simdjson::error_message(error));
+            return false;
+        }
+
+        simdjson::dom::array entries;
+        if (document["results"].get_array().get(entries))
+        {
+            utils::Logs::error("Baseline %s has no results", path);
+            return false;
+        }
+
+        std::unordered_map<std::string, BenchResult> baseline;
+        for (simdjson::dom::element entry : entries)
+        {
+            std::string_view name;
+            BenchResult result;
+            if (entry["name"].get_string().get(name) || entry["medianNS"].get_double().get(result.medianNS) ||
+                entry["madNS"].get_double().get(result.madNS))
+            {
+                continue;
+            }
+            baseline[std::string(name)] = result;
+        }
+
+        std::printf("\n%-48s %12s %12s %9s\n", "case", "baseline ns", "current ns", "change");
+        for (const BenchResult& result : results)
+        {
+            auto it = baseline.find(result.name);
+            if (it == baseline.end())
+            {
+                std::printf("%-48s %12s %12.2f %9s\n", result.name.c_str(), "-", result.medianNS, "new");
+                continue;
+            }
+
+            const BenchResult& base = it->second;
+            double change = base.medianNS > 0.0 ? result.medianNS / base.medianNS - 1.0 : 0.0;
+            // Differences inside a few MADs of either run are noise, whatever the ratio says
+            double noise = 3.0 * std::max(result.madNS, base.madNS);
+            double difference = result.medianNS - base.medianNS;
+
+            const char* verdict = "";
+            if (change > options.threshold && difference > noise)
+            {
+                verdict = "  REGRESSED";
+                regressed = true;
+            }
+            else if (change < -options.threshold && -difference > noise)
+            {
+                verdict = "  improved";
+            }
+            std::printf("%-48s %12.2f %12.2f %+8.1f%%%s\n", result.name.c_str(), base.medianNS, result.medianNS,
+                change * 100.0, verdict);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace runa::bench
+{
+    // Keeps the compiler from dropping a result that is never read
+    template <typename T>
+    inline void doNotOptimize(const T& value)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        static const void* volatile sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    // Runs the measured code iterations times
+    using BenchFunction = std::function<void(uint64_t iterations)>;
+    // Called right before the case is measured, state captured by the returned function is freed after it
+    using BenchSetup = std::function<BenchFunction()>;
+
+    struct BenchOptions
+    {
+        // Substring of the case names to run, nullptr runs everything
+        const char* filter = nullptr;
+        uint32_t samples = 21;
+        uint64_t warmupNS = 100000000;
+        // Every sample runs enough iterations to take at least this long
+        uint64_t sampleNS = 5000000;
+        const char* jsonPath = nullptr;
+        const char* baselinePath = nullptr;
+        // Slower than the baseline by more than this fraction, and by more than the noise, is a regression
+        double threshold = 0.05;
+    };
+
+    // Per iteration times
+    struct BenchResult
+    {
+        std::string name;
+        uint64_t iterations = 0;
+        uint32_t samples = 0;
+        double medianNS = 0.0;
+        // Median absolute deviation of the samples
+        double madNS = 0.0;
+        double minNS = 0.0;
+        // Operations the case declared per iteration, and how many of them run per second at the median
+        uint64_t ops = 0;
+        double opsPerSecond = 0.0;
+    };
+
+    // Threads created once per case for contended measurements, so creating them stays out of the
+    // measured time and thread local state (caches, ids) is not churned every sample.
+    // start() releases them all through a barrier, wait() returns once every one has finished
+    class ThreadTeam
+    {
+    public:
+        explicit ThreadTeam(uint32_t count);
+        ~ThreadTeam();
+
+        // fn(index) on every thread, the calling thread is free to consume meanwhile
+        void start(std::function<void(uint32_t index)> fn);
+        void wait();
+
+        uint32_t size() const { return (uint32_t)threads.size(); }
+
+        ThreadTeam(const ThreadTeam&) = delete;
+        ThreadTeam& operator=(const ThreadTeam&) = delete;
+    private:
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::function<void(uint32_t)> function;
+        uint64_t generation = 0;
+        uint32_t running = 0;
+        bool stopping = false;
+        // Threads spin here until all of them woke up, then start together
+        std::atomic<uint32_t> arrived = 0;
+
+        void loop(uint32_t index);
+    };
+
+    class Runner
+    {
+    public:
+        // ops is how many operations (calls, entities) one iteration performs, non zero adds their rate
+        // per second to the report
+        void add(std::string name, BenchSetup setup, uint64_t ops = 0);
+
+        void list() const;
+        // Exit code, non zero when a case failed to set up or regressed against the baseline
+        int run(const BenchOptions& options);
+    private:
+        struct BenchCase
+        {
+            std::string name;
+            BenchSetup setup;
+            uint64_t ops = 0;
+        };
+
+        std::vector<BenchCase> cases;
+
+        static BenchResult measure(const std::string& name, const BenchFunction& function, const BenchOptions& options);
+        static bool writeJson(const char* path, const BenchOptions& options, const std::vector<BenchResult>& results);
+        static bool compare(const char* path, const BenchOptions& options, const std::vector<BenchResult>& results, bool& regressed);
+    };
+
+    void registerAssets(Runner& runner);
+    void registerMath(Runner& runner);
+    void registerInput(Runner& runner);
+    void registerJobs(Runner& runner);
+    void registerQueues(Runner& runner);
+    void registerMemory(Runner& runner);
+    void registerEcs(Runner& runner);
+    void registerAnimation(Runner& runner);
+    void registerScripting(Runner& runner);
+}
@@ -0,0 +1,130 @@
+#include "bench.h"
+#include "animation/animator.h"
+#include "jobs/job_system.h"
+#include <cmath>
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        constexpr uint32_t jointCount = 64;
+        constexpr uint32_t keyCount = 60;
+        constexpr uint32_t vertexCount = 2000;
+        constexpr uint32_t crowdSize = 200;
+
+        struct Crowd
+        {
+            animation::Skeleton skeleton;
+            animation::SkinnedVertices vertices;
+            animation::AnimationClip walk;
+            animation::AnimationClip run;
+            std::vector<animation::Animator> animators;
+            animation::AnimationSystem system;
+            jobs::JobSystem jobs;
+        };
+
+        // Two seconds at 30 keys a second on every joint, like a baked locomotion clip
+        void bakeClip(animation::AnimationClip& clip, float speed)
+        {
+            std::vector<float> times(keyCount);
+            std::vector<float> translations(keyCount * 3);
+            std::vector<float> rotations(keyCount * 4);
+            for (uint32_t joint = 0; joint < jointCount; joint++)
+            {
+                for (uint32_t key = 0; key < keyCount; key++)
+                {
+                    float angle = (float)key / keyCount * 6.2831853f * speed + joint;
+                    times[key] = key / 30.0f;
+                    translations[key * 3 + 0] = std::sin(angle) * 0.1f;
+                    translations[key * 3 + 1] = 1.0f;
+                    translations[key * 3 + 2] = std::cos(angle) * 0.1f;
+                    rotations[key * 4 + 0] = std::sin(angle * 0.5f);
+                    rotations[key * 4 + 1] = 0.0f;
+                    rotations[key * 4 + 2] = 0.0f;
+                    rotations[key * 4 + 3] = std::cos(angle * 0.5f);
+                }
+                clip.addTrack((uint16_t)joint, animation::translationPath, times.data(), translations.data(), keyCount);
+                clip.addTrack((uint16_t)joint, animation::rotationPath, times.data(), rotations.data(), keyCount);
+            }
+        }
+
+        std::shared_ptr<Crowd> crowd(uint32_t size, bool parallel, bool fading)
+        {
+            auto scene = std::make_shared<Crowd>();
+            if (parallel && !scene->jobs.init()) return nullptr;
+
+            // Four chains of 16 joints hanging from the first one
+            scene->skeleton.parents.resize(jointCount);
+            for (uint32_t joint = 0; joint < jointCount; joint++)
+            {
+                scene->skeleton.parents[joint] = joint == 0 ? animation::noParent : (joint % 16 == 1 ? 0 : (int32_t)joint - 1);
+            }
+            if (!scene->skeleton.finalize()) return nullptr;
+
+            for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+            {
+                scene->vertices.positions.push_back(glm::vec3((float)(vertex % 20), (float)(vertex / 20), 0.0f));
+                scene->vertices.normals.push_back(glm::vec3(0.0f, 0.0f, 1.0f));
+                for (uint32_t i = 0; i < 4; i++) scene->vertices.joints.push_back((uint16_t)((vertex + i * 7) % jointCount));
+                scene->vertices.weights.push_back(glm::vec4(0.4f, 0.3f, 0.2f, 0.1f));
+            }
+            bakeClip(scene->walk, 1.0f);
+            bakeClip(scene->run, 2.0f);
+
+            scene->animators.resize(size);
+            for (uint32_t i = 0; i < size; i++)
+            {
+                animation::Animator& animator = scene->animators[i];
+                animator.init(&scene->skeleton, &scene->vertices);
+                animator.play(&scene->walk);
+                // Spreads the characters over the clip
+                animation::AnimationStats ignored;
+                animator.update(i * 0.01f, ignored);
+                // Long enough to never finish while measured
+                if (fading) animator.crossFade(&scene->run, 1.0e9f);
+                scene->system.add(&animator);
+            }
+            return scene;
+        }
+
+        BenchFunction animateCrowd(bool parallel, bool fading)
+        {
+            std::shared_ptr<Crowd> scene = crowd(crowdSize, parallel, fading);
+            if (!scene) return nullptr;
+
+            return [scene, parallel](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    scene->system.update(1.0f / 60.0f, parallel ? &scene->jobs : nullptr);
+                    doNotOptimize(scene->system.getStats().vertices);
+                }
+            };
+        }
+    }
+
+    void registerAnimation(Runner& runner)
+    {
+        runner.add("AnimationClip::sample 64 joints", []() -> BenchFunction {
+            auto clip = std::make_shared<animation::AnimationClip>();
+            bakeClip(*clip, 1.0f);
+            auto pose = std::make_shared<animation::Pose>();
+            pose->resize(jointCount);
+            auto cursors = std::make_shared<std::vector<uint32_t>>(clip->getTrackCount(), 0);
+            return [clip, pose, cursors](uint64_t iterations) {
+                float time = 0.0f;
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    time = std::fmod(time + 1.0f / 60.0f, clip->getDuration());
+                    clip->sample(time, *pose, cursors->data());
+                    doNotOptimize(pose->rotations[0]);
+                }
+            };
+        });
+
+        runner.add("AnimationSystem 200 characters", []() { return animateCrowd(false, false); });
+        runner.add("AnimationSystem 200 characters parallel", []() { return animateCrowd(true, false); });
+        runner.add("AnimationSystem 200 characters cross fading", []() { return animateCrowd(false, true); });
+    }
+}
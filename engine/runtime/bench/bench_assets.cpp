@@ -0,0 +1,215 @@
+#include "bench.h"
+#include "utils/system.h"
+#include "io/fs.h"
+#include "io/handlers.h"
+#include "utils/logs.h"
+#include <SDL3/SDL.h>
+#include <cgltf.h>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        std::string tempPath(const char* name)
+        {
+            return (std::filesystem::temp_directory_path() / name).string();
+        }
+
+        // Files a case wrote to the temp directory, removed when the case is torn down
+        struct TempFiles
+        {
+            std::vector<std::string> paths;
+
+            ~TempFiles()
+            {
+                std::error_code code;
+                for (const std::string& path : paths) std::filesystem::remove(path, code);
+            }
+        };
+
+        bool writeBytes(const std::string& path, const void* data, size_t size)
+        {
+            SDL_IOStream* file = SDL_IOFromFile(path.c_str(), "wb");
+            if (!file) return false;
+            bool written = SDL_WriteIO(file, data, size) == size;
+            return SDL_CloseIO(file) && written;
+        }
+
+        // Grid of side * side vertices with positions, normals, texcoords and 32 bit indices,
+        // the layout exporters write for a static mesh
+        // The .bin goes next to the model
+        bool writeGridModel(const std::string& gltfPath, const std::string& binName, uint32_t side)
+        {
+            uint32_t vertices = side * side;
+            uint32_t indices = (side - 1) * (side - 1) * 6;
+
+            std::vector<float> positions, normals, texCoords;
+            positions.reserve(vertices * 3);
+            normals.reserve(vertices * 3);
+            texCoords.reserve(vertices * 2);
+            for (uint32_t y = 0; y < side; y++)
+            {
+                for (uint32_t x = 0; x < side; x++)
+                {
+                    float u = (float)x / (side - 1), v = (float)y / (side - 1);
+                    positions.insert(positions.end(), { u * 2.0f - 1.0f, 0.0f, v * 2.0f - 1.0f });
+                    normals.insert(normals.end(), { 0.0f, 1.0f, 0.0f });
+                    texCoords.insert(texCoords.end(), { u, v });
+                }
+            }
+
+            std::vector<uint32_t> elements;
+            elements.reserve(indices);
+            for (uint32_t y = 0; y + 1 < side; y++)
+            {
+                for (uint32_t x = 0; x + 1 < side; x++)
+                {
+                    uint32_t i = y * side + x;
+                    elements.insert(elements.end(), { i, i + side, i + 1, i + 1, i + side, i + side + 1 });
+                }
+            }
+
+            size_t positionBytes = positions.size() * sizeof(float);
+            size_t normalBytes = normals.size() * sizeof(float);
+            size_t texCoordBytes = texCoords.size() * sizeof(float);
+            size_t indexBytes = elements.size() * sizeof(uint32_t);
+
+            std::vector<uint8_t> bin(positionBytes + normalBytes + texCoordBytes + indexBytes);
+            uint8_t* cursor = bin.data();
+            SDL_memcpy(cursor, positions.data(), positionBytes);
+            SDL_memcpy(cursor += positionBytes, normals.data(), normalBytes);
+            SDL_memcpy(cursor += normalBytes, texCoords.data(), texCoordBytes);
+            SDL_memcpy(cursor += texCoordBytes, elements.data(), indexBytes);
+
+            std::string binPath = (std::filesystem::path(gltfPath).parent_path() / binName).string();
+            if (!writeBytes(binPath, bin.data(), bin.size())) return false;
+
+            char json[2048];
+            int length = SDL_snprintf(json, sizeof(json),
+                "{\"asset\":{\"version\":\"2.0\"},"
+                "\"buffers\":[{\"uri\":\"%s\",\"byteLength\":%zu}],"
+                "\"bufferViews\":["
+                "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%zu,\"target\":34962},"
+                "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu,\"target\":34962},"
+                "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu,\"target\":34962},"
+                "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu,\"target\":34963}],"
+                "\"accessors\":["
+                "{\"bufferView\":0,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\",\"min\":[-1,0,-1],\"max\":[1,0,1]},"
+                "{\"bufferView\":1,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\"},"
+                "{\"bufferView\":2,\"componentType\":5126,\"count\":%u,\"type\":\"VEC2\"},"
+                "{\"bufferView\":3,\"componentType\":5125,\"count\":%u,\"type\":\"SCALAR\"}],"
+                "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+                "\"nodes\":[{\"mesh\":0}],\"scenes\":[{\"nodes\":[0]}],\"scene\":0}",
+                binName.c_str(), bin.size(),
+                positionBytes,
+                positionBytes, normalBytes,
+                positionBytes + normalBytes, texCoordBytes,
+                positionBytes + normalBytes + texCoordBytes, indexBytes,
+                vertices, vertices, vertices, indices);
+            return length > 0 && (size_t)length < sizeof(json) && writeBytes(gltfPath, json, (size_t)length);
+        }
+
+        // Parsed with its buffers loaded, nullptr on failure
+        cgltf_data* loadModel(const std::string& path)
+        {
+            cgltf_options options = {};
+            cgltf_data* data = nullptr;
+            if (cgltf_parse_file(&options, path.c_str(), &data) != cgltf_result_success) return nullptr;
+            if (cgltf_load_buffers(&options, data, path.c_str()) != cgltf_result_success)
+            {
+                cgltf_free(data);
+                return nullptr;
+            }
+            return data;
+        }
+
+        task_c<void> readWhole(fs_c& fs, std::string path, size_t& size)
+        {
+            fs_file_t file = co_await fs.read(std::move(path));
+            size = file.result < 0 ? 0 : file.data.size();
+        }
+    }
+
+    void registerAssets(Runner& runner)
+    {
+        runner.add("utils::readFile 4MB", []() -> BenchFunction {
+            auto files = std::make_shared<TempFiles>();
+            std::string path = files->paths.emplace_back(tempPath("runa_bench_4mb.bin"));
+            std::vector<uint8_t> content(4 << 20, 0x5a);
+            if (!writeBytes(path, content.data(), content.size())) return nullptr;
+
+            return [files, path, data = std::vector<uint8_t>()](uint64_t iterations) mutable {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    utils::readFile(path.c_str(), data);
+                    doNotOptimize(data.data());
+                }
+            };
+        });
+
+        runner.add("fs_c::read 4MB", []() -> BenchFunction {
+            auto files = std::make_shared<TempFiles>();
+            std::string path = files->paths.emplace_back(tempPath("runa_bench_4mb.bin"));
+            std::vector<uint8_t> content(4 << 20, 0x5a);
+            if (!writeBytes(path, content.data(), content.size())) return nullptr;
+
+            auto loop = std::make_shared<loop_c>();
+            return [files, path, loop](uint64_t iterations) {
+                fs_c fs(*loop);
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    size_t size = 0;
+                    readWhole(fs, path, size).detach();
+                    loop->run();
+                    doNotOptimize(size);
+                }
+            };
+        });
+
+        // models::gltf needs a GL context for its meshes, this is the decode half it runs before upload
+        runner.add("cgltf decode 64k vertices", []() -> BenchFunction {
+            auto files = std::make_shared<TempFiles>();
+            std::string path = files->paths.emplace_back(tempPath("runa_bench_grid.gltf"));
+            files->paths.push_back(tempPath("runa_bench_grid.bin"));
+            if (!writeGridModel(path, "runa_bench_grid.bin", 256)) return nullptr;
+
+            // A model that does not decode here would make every iteration measure nothing
+            cgltf_data* checked = loadModel(path);
+            bool valid = checked && checked->meshes_count > 0 && checked->meshes[0].primitives_count > 0 && checked->meshes[0].primitives[0].indices;
+            if (checked) cgltf_free(checked);
+            if (!valid) return nullptr;
+
+            return [files, path, floats = std::vector<float>(), indices = std::vector<uint32_t>()](uint64_t iterations) mutable {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    cgltf_data* data = loadModel(path);
+                    if (!data)
+                    {
+                        // Decoded at setup, the file changed under the bench and its results mean nothing
+                        utils::Logs::error("Failed to decode %s while measuring", path.c_str());
+                        std::abort();
+                    }
+
+                    const cgltf_primitive& primitive = data->meshes[0].primitives[0];
+                    for (cgltf_size a = 0; a < primitive.attributes_count; a++)
+                    {
+                        const cgltf_accessor* accessor = primitive.attributes[a].data;
+                        floats.resize(accessor->count * cgltf_num_components(accessor->type));
+                        cgltf_accessor_unpack_floats(accessor, floats.data(), floats.size());
+                        doNotOptimize(floats.data());
+                    }
+                    indices.resize(primitive.indices->count);
+                    cgltf_accessor_unpack_indices(primitive.indices, indices.data(), sizeof(uint32_t), indices.size());
+                    doNotOptimize(indices.data());
+
+                    cgltf_free(data);
+                }
+            };
+        });
+    }
+}
@@ -0,0 +1,184 @@
+#include "bench.h"
+#include "ecs/transforms.h"
+#include "jobs/job_system.h"
+#include "memory/allocation_tracker.h"
+#include "opengl/command_buffer.h"
+#include "utils/logs.h"
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        constexpr uint32_t sceneSize = 1000000;
+
+        struct Velocity
+        {
+            glm::vec3 value;
+        };
+
+        struct Scene
+        {
+            ecs::World world;
+            ecs::TransformSystem transforms;
+            jobs::JobSystem jobs;
+            std::vector<ecs::Entity> entities;
+        };
+
+        std::shared_ptr<Scene> transformScene(bool parallel)
+        {
+            auto scene = std::make_shared<Scene>();
+            if (parallel && !scene->jobs.init()) return nullptr;
+
+            scene->entities.reserve(sceneSize);
+            for (uint32_t i = 0; i < sceneSize; i++)
+            {
+                ecs::Transform transform;
+                transform.position = glm::vec3((float)(i % 1000), 0.0f, (float)(i / 1000));
+                scene->entities.push_back(scene->world.create(transform, ecs::LocalToWorld(), Velocity{ glm::vec3(0.0f, 1.0f, 0.0f) }));
+            }
+            // Everything starts dirty, the first update is not what a frame costs
+            scene->transforms.update(scene->world, parallel ? &scene->jobs : nullptr);
+            return scene;
+        }
+
+        // Every entity moves and gets its matrix recomposed, a full frame of 1M transforms
+        BenchFunction moveAll(bool parallel)
+        {
+            std::shared_ptr<Scene> scene = transformScene(parallel);
+            if (!scene) return nullptr;
+
+            return [scene, parallel](uint64_t iterations) {
+                jobs::JobSystem* jobs = parallel ? &scene->jobs : nullptr;
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    // Parallel queries take their chunk list from the frame arena
+                    frameArenas.beginFrame();
+                    auto move = [](const ecs::Entity*, uint32_t count, ecs::Transform* transforms, const Velocity* velocities) {
+                        for (uint32_t e = 0; e < count; e++) transforms[e].position += velocities[e].value * 0.016f;
+                    };
+                    if (jobs) scene->world.parallelEachChunk<ecs::Transform, const Velocity>(*jobs, move);
+                    else scene->world.eachChunk<ecs::Transform, const Velocity>(move);
+                    scene->transforms.update(scene->world, jobs);
+                }
+            };
+        }
+
+        // 10k neighbours move, the chunks of everything else are skipped by their version
+        BenchFunction moveSparse()
+        {
+            std::shared_ptr<Scene> scene = transformScene(false);
+            if (!scene) return nullptr;
+
+            return [scene](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    uint32_t first = (uint32_t)(i * 10000 % sceneSize);
+                    for (uint32_t e = first; e < first + 10000; e++)
+                    {
+                        scene->world.get<ecs::Transform>(scene->entities[e])->position.y += 0.016f;
+                    }
+                    scene->transforms.update(scene->world);
+                }
+            };
+        }
+        // What runa does every frame: move, recompose and record a draw per chunk. Setup fails when the
+        // allocation tracker is compiled in and a frame past the first few still allocates
+        BenchFunction steadyFrame()
+        {
+            struct Frame
+            {
+                std::shared_ptr<Scene> scene;
+                opengl::CommandBuffer commands;
+            };
+
+            auto frame = std::make_shared<Frame>();
+            frame->scene = transformScene(true);
+            if (!frame->scene) return nullptr;
+
+            auto run = [](Frame& state) {
+                frameArenas.beginFrame();
+                allocationTracker.frame();
+                Scene& scene = *state.scene;
+                auto move = [](const ecs::Entity*, uint32_t count, ecs::Transform* transforms, const Velocity* velocities) {
+                    for (uint32_t e = 0; e < count; e++) transforms[e].position += velocities[e].value * 0.016f;
+                };
+                scene.world.parallelEachChunk<ecs::Transform, const Velocity>(scene.jobs, move);
+                scene.transforms.update(scene.world, &scene.jobs);
+
+                state.commands.reset();
+                scene.world.eachChunk<const ecs::LocalToWorld>([&state](const ecs::Entity*, uint32_t count, const ecs::LocalToWorld* matrices) {
+                    state.commands.record([matrices, count]() { doNotOptimize(matrices[count - 1]); });
+                });
+            };
+
+            // Containers reach their final capacity during the first frames
+            for (uint32_t i = 0; i < 4; i++) run(*frame);
+            run(*frame);
+            allocationTracker.frame();
+            if (memory::AllocationTracker::isCompiled())
+            {
+                memory::AllocationStats stats = allocationTracker.getStats();
+                uint64_t allocations = 0;
+                size_t bytes = 0;
+                for (size_t tag = 0; tag < memory::AllocationStats::tags; tag++)
+                {
+                    allocations += stats.frameAllocations[tag];
+                    bytes += stats.frameBytes[tag];
+                }
+                if (allocations > 0)
+                {
+                    utils::Logs::error("Steady frame made %llu heap allocations (%zu bytes)", (unsigned long long)allocations, bytes);
+                    return nullptr;
+                }
+            }
+
+            return [frame, run](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) run(*frame);
+            };
+        }
+    }
+
+    void registerEcs(Runner& runner)
+    {
+        runner.add("World::create 1M", []() -> BenchFunction {
+            return [](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    ecs::World world;
+                    for (uint32_t e = 0; e < sceneSize; e++) world.create(ecs::Transform(), ecs::LocalToWorld());
+                    doNotOptimize(world.getStats().entities);
+                }
+            };
+        });
+
+        runner.add("World::each 1M read", []() -> BenchFunction {
+            std::shared_ptr<Scene> scene = transformScene(false);
+            return [scene](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    float sum = 0.0f;
+                    scene->world.each<const ecs::Transform>([&sum](ecs::Entity, const ecs::Transform& transform) { sum += transform.position.x; });
+                    doNotOptimize(sum);
+                }
+            };
+        });
+
+        runner.add("World::add/remove 10k", []() -> BenchFunction {
+            std::shared_ptr<Scene> scene = transformScene(false);
+            return [scene](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    for (uint32_t e = 0; e < 10000; e++) scene->world.remove<Velocity>(scene->entities[e]);
+                    for (uint32_t e = 0; e < 10000; e++) scene->world.add<Velocity>(scene->entities[e]);
+                }
+            };
+        });
+
+        runner.add("TransformSystem 1M moving", []() { return moveAll(false); });
+        runner.add("TransformSystem 1M moving parallel", []() { return moveAll(true); });
+        runner.add("TransformSystem 1M, 10k moving", []() { return moveSparse(); });
+        runner.add("Steady frame 1M moving parallel", []() { return steadyFrame(); });
+    }
+}
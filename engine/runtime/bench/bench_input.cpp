@@ -0,0 +1,95 @@
+#include "bench.h"
+#include "input.h"
+#include <SDL3/SDL.h>
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        // What a game holds after a few seconds of play, a dozen keys and two buttons seen
+        std::shared_ptr<Input> playedInput()
+        {
+            auto state = std::make_shared<Input>();
+            const SDL_Scancode keys[] = {
+                SDL_SCANCODE_W, SDL_SCANCODE_A, SDL_SCANCODE_S, SDL_SCANCODE_D, SDL_SCANCODE_SPACE, SDL_SCANCODE_LCTRL,
+                SDL_SCANCODE_LSHIFT, SDL_SCANCODE_E, SDL_SCANCODE_Q, SDL_SCANCODE_R, SDL_SCANCODE_1, SDL_SCANCODE_ESCAPE,
+            };
+            for (size_t i = 0; i < SDL_arraysize(keys); i++)
+            {
+                SDL_Event event = {};
+                event.type = SDL_EVENT_KEY_DOWN;
+                event.key.scancode = keys[i];
+                event.key.down = i % 2 == 0;
+                state->updateEvent(event);
+            }
+            for (uint8_t button = SDL_BUTTON_LEFT; button <= SDL_BUTTON_RIGHT; button += 2)
+            {
+                SDL_Event event = {};
+                event.type = SDL_EVENT_MOUSE_BUTTON_DOWN;
+                event.button.button = button;
+                event.button.down = true;
+                state->updateEvent(event);
+            }
+            return state;
+        }
+    }
+
+    void registerInput(Runner& runner)
+    {
+        runner.add("Input::keyHeld", []() -> BenchFunction {
+            return [state = playedInput()](uint64_t iterations) {
+                // Seen and never seen keys, both paths are taken every frame
+                const SDL_Scancode keys[] = { SDL_SCANCODE_W, SDL_SCANCODE_F, SDL_SCANCODE_SPACE, SDL_SCANCODE_TAB };
+                for (uint64_t i = 0; i < iterations; i++) doNotOptimize(state->keyHeld(keys[i & 3]));
+            };
+        });
+
+        runner.add("Input::inputVector", []() -> BenchFunction {
+            return [state = playedInput()](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    doNotOptimize(state->inputVector(SDL_SCANCODE_D, SDL_SCANCODE_A, SDL_SCANCODE_W, SDL_SCANCODE_S));
+                }
+            };
+        });
+
+        runner.add("Input::updateEvent", []() -> BenchFunction {
+            return [state = playedInput()](uint64_t iterations) {
+                SDL_Event event = {};
+                event.type = SDL_EVENT_KEY_DOWN;
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    event.key.scancode = (i & 1) ? SDL_SCANCODE_W : SDL_SCANCODE_D;
+                    event.key.down = (i & 2) != 0;
+                    state->updateEvent(event);
+                }
+                doNotOptimize(state.get());
+            };
+        });
+
+        // A frame of a game with a typical action map, resolved once and queried a few times
+        runner.add("Input::resolveActions 16 actions", []() -> BenchFunction {
+            auto state = playedInput();
+            InputAction first = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                char name[16];
+                SDL_snprintf(name, sizeof(name), "action%d", i);
+                InputAction action = state->addAction(name);
+                state->bind(action, { (SDL_Scancode)(SDL_SCANCODE_A + i), 0 });
+                state->bind(action, { SDL_SCANCODE_UNKNOWN, (uint8_t)(i % 3 + 1) });
+                if (i == 0) first = action;
+            }
+            return [state, first](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    state->beginFrame();
+                    state->resolveActions();
+                    doNotOptimize(state->actionVector(first, first + 1, first + 2, first + 3));
+                }
+            };
+        });
+    }
+}
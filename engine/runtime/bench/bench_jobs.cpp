@@ -0,0 +1,169 @@
+#include "bench.h"
+#include "jobs/job_system.h"
+#include "io/task.h"
+#include "resources/resource_pool.h"
+#include <cmath>
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        BenchFunction parallelFor(jobs::EJobMode mode)
+        {
+            auto system = std::make_shared<jobs::JobSystem>();
+            if (!system->init(0, mode)) return nullptr;
+
+            auto values = std::make_shared<std::vector<float>>(1 << 20, 1.0f);
+            return [system, values](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    float* data = values->data();
+                    system->parallelFor((uint32_t)values->size(), [data](uint32_t begin, uint32_t end) {
+                        for (uint32_t v = begin; v < end; v++) data[v] = std::sqrt(data[v] * 1.0001f + 1.0f);
+                    }, 4096);
+                    doNotOptimize(data[0]);
+                }
+            };
+        }
+
+        BenchFunction emptyJobs(jobs::EJobMode mode)
+        {
+            auto system = std::make_shared<jobs::JobSystem>();
+            if (!system->init(0, mode)) return nullptr;
+
+            // Per job overhead, 256 jobs per batch
+            return [system](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    jobs::Counter counter;
+                    for (int j = 0; j < 256; j++) system->run([](void*, uint32_t, uint32_t) {}, nullptr, &counter);
+                    system->wait(counter);
+                }
+            };
+        }
+
+        // Jobs that wait inside a job: 32 parents each split 64 children and wait on them. Fibers park
+        // the parent and the worker moves on, threads run other jobs on top of the waiting one
+        BenchFunction nestedWaits(jobs::EJobMode mode)
+        {
+            auto system = std::make_shared<jobs::JobSystem>();
+            if (!system->init(0, mode)) return nullptr;
+
+            struct Work
+            {
+                jobs::JobSystem* system;
+                float values[64 * 256];
+            };
+            auto work = std::make_shared<std::vector<Work>>(32);
+            for (Work& parent : *work) parent.system = system.get();
+
+            return [system, work](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    jobs::Counter parents;
+                    for (Work& parent : *work)
+                    {
+                        system->run([](void* data, uint32_t, uint32_t) {
+                            Work& parent = *static_cast<Work*>(data);
+                            jobs::Counter children;
+                            for (uint32_t child = 0; child < 64; child++)
+                            {
+                                parent.system->run([](void* values, uint32_t begin, uint32_t end) {
+                                    float* v = static_cast<float*>(values);
+                                    for (uint32_t k = begin; k < end; k++) v[k] = std::sqrt(v[k] * 1.0001f + 1.0f);
+                                }, parent.values, child * 256, child * 256 + 256, &children);
+                            }
+                            parent.system->wait(children);
+                        }, &parent, &parents);
+                    }
+                    system->wait(parents);
+                    doNotOptimize((*work)[0].values[0]);
+                }
+            };
+        }
+
+        // Raw cost of one switch, two fibers passing control back and forth
+        struct PingPong
+        {
+            jobs::Fiber thread;
+            jobs::Fiber fiber;
+        };
+
+        void pingPongEntry(void* arg)
+        {
+            PingPong& pair = *static_cast<PingPong*>(arg);
+            for (;;) pair.fiber.switchTo(pair.thread);
+        }
+
+        task_c<int> leaf(int value)
+        {
+            co_return value + 1;
+        }
+
+        task_c<void> chain(int count, int& result)
+        {
+            for (int i = 0; i < count; i++) result = co_await leaf(result);
+        }
+
+        struct Payload
+        {
+            uint64_t data[8] = {};
+        };
+    }
+
+    void registerJobs(Runner& runner)
+    {
+        runner.add("JobSystem::parallelFor 1M threads", []() { return parallelFor(jobs::threads); });
+        runner.add("JobSystem::parallelFor 1M fibers", []() { return parallelFor(jobs::fibers); });
+        runner.add("JobSystem::run 256 empty threads", []() { return emptyJobs(jobs::threads); });
+        runner.add("JobSystem::run 256 empty fibers", []() { return emptyJobs(jobs::fibers); });
+        runner.add("JobSystem nested waits 32x64 threads", []() { return nestedWaits(jobs::threads); });
+        runner.add("JobSystem nested waits 32x64 fibers", []() { return nestedWaits(jobs::fibers); });
+
+        // Two switches per iteration, there and back
+        runner.add("Fiber::switchTo round trip", []() -> BenchFunction {
+            auto pair = std::make_shared<PingPong>();
+            if (!pair->thread.initFromThread() || !pair->fiber.init(64 * 1024, pingPongEntry, pair.get())) return nullptr;
+            return [pair](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) pair->thread.switchTo(pair->fiber);
+            };
+        });
+
+        runner.add("frame_allocator_c 256B", []() -> BenchFunction {
+            return [](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    void* frame = frame_allocator_c::allocate(256);
+                    doNotOptimize(frame);
+                    frame_allocator_c::deallocate(frame, 256);
+                }
+            };
+        });
+
+        // Frame allocation, resume and symmetric transfer back, 64 awaits per iteration
+        runner.add("task_c await 64", []() -> BenchFunction {
+            return [](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    int result = 0;
+                    chain(64, result).detach();
+                    doNotOptimize(result);
+                }
+            };
+        });
+
+        runner.add("ResourcePool create/release", []() -> BenchFunction {
+            auto pool = std::make_shared<resources::ResourcePool<Payload>>();
+            return [pool](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    resources::Handle<Payload> handle = pool->create(i + 1);
+                    doNotOptimize(pool->get(handle));
+                    pool->release(handle);
+                }
+            };
+        });
+    }
+}
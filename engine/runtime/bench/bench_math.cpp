@@ -0,0 +1,122 @@
+#include "bench.h"
+#include "opengl/camera.h"
+#include "utils/hash.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        struct Bounds
+        {
+            glm::vec3 center;
+            glm::vec3 extents;
+        };
+
+        // Gribb/Hartmann planes of a view projection matrix, normals point inside
+        void extractPlanes(const glm::mat4& matrix, glm::vec4 planes[6])
+        {
+            glm::vec4 row0(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+            glm::vec4 row1(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+            glm::vec4 row2(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+            glm::vec4 row3(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+            planes[0] = row3 + row0;
+            planes[1] = row3 - row0;
+            planes[2] = row3 + row1;
+            planes[3] = row3 - row1;
+            planes[4] = row3 + row2;
+            planes[5] = row3 - row2;
+        }
+
+        bool visible(const glm::vec4 planes[6], const Bounds& bounds)
+        {
+            for (int i = 0; i < 6; i++)
+            {
+                glm::vec3 normal(planes[i]);
+                float radius = glm::dot(bounds.extents, glm::abs(normal));
+                if (glm::dot(normal, bounds.center) + planes[i].w < -radius) return false;
+            }
+            return true;
+        }
+
+        std::vector<Bounds> scatterBounds(size_t count)
+        {
+            std::mt19937 random(42);
+            std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+            std::uniform_real_distribution<float> size(0.1f, 2.0f);
+
+            std::vector<Bounds> bounds(count);
+            for (Bounds& b : bounds)
+            {
+                b.center = glm::vec3(position(random), position(random), position(random));
+                b.extents = glm::vec3(size(random));
+            }
+            return bounds;
+        }
+    }
+
+    void registerMath(Runner& runner)
+    {
+        runner.add("Camera::updateMatrix", []() -> BenchFunction {
+            return [](uint64_t iterations) {
+                opengl::Camera camera(glm::vec3(0.0f, 0.5f, 2.0f));
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    camera.pos.x = (float)(i & 255) * 0.01f;
+                    camera.updateMatrix(60.0f, 0.1f, 100.0f, 1920, 1080);
+                    doNotOptimize(camera.cameraMatrix);
+                }
+            };
+        });
+
+        runner.add("utils::hash 64B path", []() -> BenchFunction {
+            return [](uint64_t iterations) {
+                std::string path = "resources/textures/environment/forest/planks_diffuse_2k.png";
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    path[0] = (char)('a' + (i & 15));
+                    doNotOptimize(utils::hash(path));
+                }
+            };
+        });
+
+        // Nothing in the runtime culls yet, this is the reference kernel scene code will be measured against
+        runner.add("frustum cull 10k bounds", []() -> BenchFunction {
+            auto bounds = std::make_shared<std::vector<Bounds>>(scatterBounds(10000));
+            return [bounds](uint64_t iterations) {
+                opengl::Camera camera(glm::vec3(0.0f, 0.0f, 0.0f));
+                camera.updateMatrix(60.0f, 0.1f, 100.0f, 1920, 1080);
+                glm::vec4 planes[6];
+                extractPlanes(camera.cameraMatrix, planes);
+
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    uint32_t count = 0;
+                    for (const Bounds& b : *bounds) count += visible(planes, b) ? 1 : 0;
+                    doNotOptimize(count);
+                }
+            };
+        });
+
+        runner.add("mat4 model view projection 1k", []() -> BenchFunction {
+            auto models = std::make_shared<std::vector<glm::mat4>>(1000);
+            for (size_t i = 0; i < models->size(); i++)
+            {
+                (*models)[i] = glm::translate(glm::mat4(1.0f), glm::vec3((float)i, 0.0f, -(float)i));
+            }
+            return [models, results = std::vector<glm::mat4>(1000)](uint64_t iterations) mutable {
+                opengl::Camera camera(glm::vec3(0.0f, 0.5f, 2.0f));
+                camera.updateMatrix(60.0f, 0.1f, 100.0f, 1920, 1080);
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    for (size_t m = 0; m < models->size(); m++) results[m] = camera.cameraMatrix * (*models)[m];
+                    doNotOptimize(results.data());
+                }
+            };
+        });
+    }
+}
@@ -0,0 +1,110 @@
+#include "bench.h"
+#include "memory/frame_arena.h"
+#include "memory/pool.h"
+#include <uv.h>
+#include <vector>
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        constexpr uint32_t threads = 4;
+        // Requests in flight while streaming, the oldest is freed for every new one
+        constexpr uint32_t window = 256;
+
+        template <typename Allocate, typename Free>
+        void churn(uint64_t iterations, Allocate allocate, Free free)
+        {
+            uv_fs_t* live[window] = {};
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                uv_fs_t*& slot = live[i % window];
+                if (slot) free(slot);
+                slot = allocate();
+                slot->result = (ssize_t)i;
+                doNotOptimize(slot);
+            }
+            for (uv_fs_t* request : live) if (request) free(request);
+        }
+
+        // The team's threads live as long as the case, so their thread caches are kept between samples
+        template <typename Allocate, typename Free>
+        void contended(ThreadTeam& team, uint64_t iterations, Allocate allocate, Free free)
+        {
+            uint64_t share = iterations / team.size() + 1;
+            team.start([&allocate, &free, share](uint32_t) { churn(share, allocate, free); });
+            team.wait();
+        }
+    }
+
+    void registerMemory(Runner& runner)
+    {
+        runner.add("uv_fs_t new/delete", []() -> BenchFunction {
+            return [](uint64_t iterations) {
+                churn(iterations, []() { return new uv_fs_t(); }, [](uv_fs_t* request) { delete request; });
+            };
+        });
+
+        runner.add("uv_fs_t ObjectPool", []() -> BenchFunction {
+            auto pool = std::make_shared<memory::ObjectPool<uv_fs_t>>();
+            return [pool](uint64_t iterations) {
+                churn(iterations, [&pool]() { return pool->create(); }, [&pool](uv_fs_t* request) { pool->destroy(request); });
+            };
+        });
+
+        runner.add("uv_fs_t new/delete 4 threads", []() -> BenchFunction {
+            auto team = std::make_shared<ThreadTeam>(threads);
+            return [team](uint64_t iterations) {
+                contended(*team, iterations, []() { return new uv_fs_t(); }, [](uv_fs_t* request) { delete request; });
+            };
+        });
+
+        runner.add("uv_fs_t ObjectPool 4 threads", []() -> BenchFunction {
+            auto pool = std::make_shared<memory::ObjectPool<uv_fs_t>>();
+            auto team = std::make_shared<ThreadTeam>(threads);
+            return [pool, team](uint64_t iterations) {
+                contended(*team, iterations, [&pool]() { return pool->create(); }, [&pool](uv_fs_t* request) { pool->destroy(request); });
+            };
+        });
+
+        runner.add("uv_fs_t ObjectPool thread caches 4 threads", []() -> BenchFunction {
+            auto pool = std::make_shared<memory::ObjectPool<uv_fs_t>>(64, true);
+            auto team = std::make_shared<ThreadTeam>(threads);
+            return [pool, team](uint64_t iterations) {
+                contended(*team, iterations, [&pool]() { return pool->create(); }, [&pool](uv_fs_t* request) { pool->destroy(request); });
+            };
+        });
+
+        // A frame worth of temporary lists
+        runner.add("std::vector 64 lists", []() -> BenchFunction {
+            return [](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    for (uint32_t list = 0; list < 64; list++)
+                    {
+                        std::vector<uint32_t> values;
+                        for (uint32_t v = 0; v < 100; v++) values.push_back(v);
+                        doNotOptimize(values.data());
+                    }
+                }
+            };
+        });
+
+        runner.add("FrameResource 64 lists", []() -> BenchFunction {
+            return [](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    frameArenas.beginFrame();
+                    for (uint32_t list = 0; list < 64; list++)
+                    {
+                        std::pmr::vector<uint32_t> values(memory::frameResource());
+                        for (uint32_t v = 0; v < 100; v++) values.push_back(v);
+                        doNotOptimize(values.data());
+                    }
+                }
+            };
+        });
+    }
+}
@@ -0,0 +1,110 @@
+#include "bench.h"
+#include "io/mpsc_queue.h"
+#include <SDL3/SDL.h>
+#include <string>
+#include <thread>
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        // Producer counts of the contended cases, loops feeding on a job system or a thread pool see 8 and more
+        constexpr uint32_t producerCounts[] = { 8, 16 };
+        constexpr uint32_t batch = 64;
+        // Messages each producer pushes per iteration of the contended cases, waking the team is paid once for all of them
+        constexpr uint64_t perProducer = 1024;
+
+        SDL_Event userEvent(uint64_t value)
+        {
+            SDL_Event event = {};
+            event.type = SDL_EVENT_USER;
+            event.user.code = (Sint32)value;
+            return event;
+        }
+
+        // The team's producers push their share while the calling thread drains, like a loop consuming
+        template <typename Push, typename Drain>
+        void contended(ThreadTeam& team, uint64_t iterations, Push push, Drain drain)
+        {
+            uint64_t messages = perProducer * iterations;
+            team.start([&push, messages](uint32_t) {
+                for (uint64_t i = 0; i < messages; i++)
+                {
+                    while (!push(i)) std::this_thread::yield();
+                }
+            });
+
+            uint64_t received = 0;
+            while (received < messages * team.size()) received += drain();
+            team.wait();
+        }
+    }
+
+    void registerQueues(Runner& runner)
+    {
+        runner.add("mpsc_queue_c push/pop", []() -> BenchFunction {
+            auto queue = std::make_shared<mpsc_queue_c<SDL_Event>>(1024);
+            return [queue](uint64_t iterations) {
+                SDL_Event event;
+                for (uint64_t i = 0; i < iterations; i += batch)
+                {
+                    for (uint32_t b = 0; b < batch; b++) queue->push(userEvent(b));
+                    while (queue->pop(event)) doNotOptimize(event);
+                }
+            };
+        });
+
+        runner.add("SDL_PushEvent/SDL_PeepEvents", []() -> BenchFunction {
+            return [](uint64_t iterations) {
+                SDL_Event events[batch];
+                for (uint64_t i = 0; i < iterations; i += batch)
+                {
+                    for (uint32_t b = 0; b < batch; b++)
+                    {
+                        SDL_Event event = userEvent(b);
+                        SDL_PushEvent(&event);
+                    }
+                    while (SDL_PeepEvents(events, batch, SDL_GETEVENT, SDL_EVENT_USER, SDL_EVENT_USER) > 0) doNotOptimize(events);
+                }
+            };
+        });
+
+        for (uint32_t producers : producerCounts)
+        {
+            // Per iteration every producer pushes perProducer messages
+            std::string messages = std::to_string(producers) + " producers x" + std::to_string(perProducer);
+            runner.add("mpsc_queue_c " + messages, [producers]() -> BenchFunction {
+                auto queue = std::make_shared<mpsc_queue_c<SDL_Event>>(4096);
+                auto team = std::make_shared<ThreadTeam>(producers);
+                return [queue, team](uint64_t iterations) {
+                    contended(*team, iterations,
+                        [&queue](uint64_t value) { return queue->push(userEvent(value)); },
+                        [&queue]() {
+                            uint64_t count = 0;
+                            SDL_Event event;
+                            while (queue->pop(event)) count++;
+                            return count;
+                        });
+                };
+            });
+
+            runner.add("SDL_PushEvent " + messages, [producers]() -> BenchFunction {
+                auto team = std::make_shared<ThreadTeam>(producers);
+                return [team](uint64_t iterations) {
+                    contended(*team, iterations,
+                        [](uint64_t value) {
+                            SDL_Event event = userEvent(value);
+                            return SDL_PushEvent(&event);
+                        },
+                        []() {
+                            SDL_Event events[batch];
+                            int count = SDL_PeepEvents(events, batch, SDL_GETEVENT, SDL_EVENT_USER, SDL_EVENT_USER);
+                            return (uint64_t)(count > 0 ? count : 0);
+                        });
+                };
+            });
+        }
+    }
+}
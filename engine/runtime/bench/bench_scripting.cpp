@@ -0,0 +1,200 @@
+#include "bench.h"
+#include "ecs/components.h"
+#include "memory/allocation_tracker.h"
+#include "scripting/compiler.h"
+#include "scripting/script_scheduler.h"
+#include "scripting/script_system.h"
+#include "utils/logs.h"
+
+namespace runa::bench
+{
+    using namespace runa::runtime;
+
+    namespace
+    {
+        constexpr uint32_t sceneSize = 10000;
+        constexpr uint32_t crowdScripts = 4000;
+
+        struct ScriptScene
+        {
+            ecs::World world;
+            scripting::ScriptSystem scripts;
+        };
+
+        // Every iteration is one update of a script whose update(delta) holds the measured loop, the case
+        // declares the calls that loop makes so the runner reports calls per second
+        BenchFunction runScript(const char* source)
+        {
+            auto scene = std::make_shared<ScriptScene>();
+            ecs::Entity first;
+            for (uint32_t i = 0; i < sceneSize; i++)
+            {
+                ecs::Transform transform;
+                transform.position = glm::vec3((float)i, 0.0f, 0.0f);
+                ecs::Entity entity = scene->world.create(transform, ecs::LocalToWorld());
+                if (i == 0) first = entity;
+            }
+
+            std::string bytecode, error;
+            if (!scripting::compile(source, bytecode, error) || !scene->scripts.init(&scene->world)) return nullptr;
+            if (scene->scripts.loadBytecode("bench", bytecode, first) == scripting::noScript) return nullptr;
+
+            return [scene](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) scene->scripts.update(0.0);
+                doNotOptimize(scene->scripts.getStats().errors);
+            };
+        }
+
+        struct ScriptCrowd
+        {
+            ecs::World world;
+            jobs::JobSystem jobs;
+            scripting::ScriptSystem single;
+            scripting::ScriptScheduler scheduler;
+        };
+
+        // One small script per entity that moves it and sends it a message every update. The message is
+        // routed through the outboxes like one to any other entity
+        constexpr const char* crowdSource = R"(
+            local angle = 0
+            local pings = 0
+            function onMessage(from, name, value)
+                pings += value
+            end
+            function update(delta)
+                angle += delta
+                local position = transform.position(entity)
+                transform.setPosition(entity, position + vector.create(math.cos(angle), 0, math.sin(angle)) * 0.01)
+                message.send(entity, "ping", 1)
+            end
+        )";
+
+        BenchFunction runCrowd(bool scheduled)
+        {
+            auto scene = std::make_shared<ScriptCrowd>();
+            std::vector<ecs::Entity> entities;
+            for (uint32_t i = 0; i < crowdScripts; i++) entities.push_back(scene->world.create(ecs::Transform(), ecs::LocalToWorld()));
+
+            std::string bytecode, error;
+            if (!scripting::compile(crowdSource, bytecode, error)) return nullptr;
+            if (scheduled && (!scene->jobs.init() || !scene->scheduler.init(&scene->world, &scene->jobs))) return nullptr;
+            if (!scheduled && !scene->single.init(&scene->world)) return nullptr;
+
+            for (uint32_t i = 0; i < crowdScripts; i++)
+            {
+                scripting::ScriptId id = scheduled ? scene->scheduler.loadBytecode("crowd", bytecode, entities[i])
+                    : scene->single.loadBytecode("crowd", bytecode, entities[i]);
+                if (id == scripting::noScript) return nullptr;
+            }
+
+            auto update = [scheduled](ScriptCrowd& crowd) {
+                if (scheduled) crowd.scheduler.update(1.0 / 60.0);
+                else crowd.single.update(1.0 / 60.0);
+            };
+
+            // Inboxes, outboxes and the message names reach their final size during the first updates,
+            // after that an update only allocates inside the VMs
+            for (uint32_t i = 0; i < 4; i++) update(*scene);
+            allocationTracker.frame();
+            update(*scene);
+            allocationTracker.frame();
+            if (memory::AllocationTracker::isCompiled())
+            {
+                memory::AllocationStats stats = allocationTracker.getStats();
+                uint64_t allocations = 0;
+                size_t bytes = 0;
+                for (size_t tag = 0; tag < memory::AllocationStats::tags; tag++)
+                {
+                    allocations += stats.frameAllocations[tag];
+                    bytes += stats.frameBytes[tag];
+                }
+                if (allocations > 0)
+                {
+                    utils::Logs::error("Steady script update made %llu heap allocations (%zu bytes)", (unsigned long long)allocations, bytes);
+                    return nullptr;
+                }
+            }
+
+            return [scene, update, scheduled](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) update(*scene);
+                doNotOptimize(scheduled ? scene->scheduler.getStats().errors : scene->single.getStats().errors);
+            };
+        }
+    }
+
+    void registerScripting(Runner& runner)
+    {
+        runner.add("Luau transform.position x1000", []() {
+            return runScript(R"(
+                function update()
+                    local sum = vector.zero
+                    for i = 1, 1000 do sum += transform.position(entity) end
+                end
+            )");
+        }, 1000);
+
+        runner.add("Luau transform.setPosition x1000", []() {
+            return runScript(R"(
+                local position = vector.create(1, 2, 3)
+                function update()
+                    for i = 1, 1000 do transform.setPosition(entity, position) end
+                end
+            )");
+        }, 1000);
+
+        runner.add("Luau input.held x1000", []() {
+            return runScript(R"(
+                local key = input.key("W")
+                function update()
+                    local held = 0
+                    for i = 1, 1000 do if input.held(key) then held += 1 end end
+                end
+            )");
+        }, 1000);
+
+        // The same 10k positions read one call per entity, then in one call through a view. Both report
+        // positions per second so they compare directly
+        runner.add("Luau 10k transform.position per entity", []() {
+            return runScript(R"(
+                local view = transform.view()
+                local entities = table.create(view:count())
+                for i = 0, view:count() - 1 do entities[i + 1] = view:entity(i) end
+                function update()
+                    local sum = vector.zero
+                    for _, e in entities do sum += transform.position(e) end
+                end
+            )");
+        }, sceneSize);
+
+        runner.add("Luau 10k view:positions", []() {
+            return runScript(R"(
+                local view = transform.view()
+                local positions = buffer.create(view:count() * 12)
+                function update()
+                    local count = view:positions(positions)
+                    local sum = 0
+                    for i = 0, count - 1 do sum += buffer.readf32(positions, i * 12) end
+                end
+            )");
+        }, sceneSize);
+
+        runner.add("Luau 10k view:positions move and setPositions", []() {
+            return runScript(R"(
+                local view = transform.view()
+                local positions = buffer.create(view:count() * 12)
+                function update()
+                    local count = view:positions(positions)
+                    for i = 0, count - 1 do
+                        local offset = i * 12 + 4
+                        buffer.writef32(positions, offset, buffer.readf32(positions, offset) + 0.01)
+                    end
+                    view:setPositions(positions)
+                end
+            )");
+        }, sceneSize);
+
+        // The same crowd on one VM, then spread over one VM per worker
+        runner.add("ScriptSystem 4000 scripts", []() { return runCrowd(false); }, crowdScripts);
+        runner.add("ScriptScheduler 4000 scripts", []() { return runCrowd(true); }, crowdScripts);
+    }
+}
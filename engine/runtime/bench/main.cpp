@@ -0,0 +1,52 @@
+#include "bench.h"
+#include "utils/logs.h"
+#include <SDL3/SDL.h>
+
+using namespace runa::bench;
+
+int main(int argc, char** argv) {
+    // --filter <text> runs the matching cases, --samples <n> repetitions per case, --list prints the cases,
+    // --json <file> saves the results, --baseline <file> compares against saved results,
+    // --threshold <percent> slowdown that counts as a regression
+    BenchOptions options;
+    bool listOnly = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (SDL_strcmp(argv[i], "--filter") == 0 && i + 1 < argc) options.filter = argv[++i];
+        else if (SDL_strcmp(argv[i], "--samples") == 0 && i + 1 < argc) options.samples = (uint32_t)SDL_strtoul(argv[++i], nullptr, 10);
+        else if (SDL_strcmp(argv[i], "--json") == 0 && i + 1 < argc) options.jsonPath = argv[++i];
+        else if (SDL_strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) options.baselinePath = argv[++i];
+        else if (SDL_strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) options.threshold = SDL_strtod(argv[++i], nullptr) / 100.0;
+        else if (SDL_strcmp(argv[i], "--list") == 0) listOnly = true;
+        else
+        {
+            runa::runtime::utils::Logs::error("Unknown argument %s", argv[i]);
+            return 2;
+        }
+    }
+
+    // SDL_PushEvent needs the event queue, nothing here opens a window
+    if (!SDL_Init(SDL_INIT_EVENTS))
+    {
+        runa::runtime::utils::Logs::sdlError();
+        return 2;
+    }
+
+    Runner runner;
+    registerAssets(runner);
+    registerMath(runner);
+    registerInput(runner);
+    registerJobs(runner);
+    registerQueues(runner);
+    registerMemory(runner);
+    registerEcs(runner);
+    registerAnimation(runner);
+    registerScripting(runner);
+
+    int result = 0;
+    if (listOnly) runner.list();
+    else result = runner.run(options);
+
+    SDL_Quit();
+    return result;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "animation/clip.h"
+#include "animation/skeleton.h"
+#include "jobs/job_system.h"
+#include <atomic>
+
+namespace runa::runtime::animation
+{
+    // CPU time of each stage summed over every animator, plus the wall time of the whole update
+    struct AnimationStats
+    {
+        uint64_t sampleNS = 0;
+        uint64_t blendNS = 0;
+        uint64_t paletteNS = 0;
+        uint64_t skinNS = 0;
+        uint64_t updateNS = 0;
+        uint32_t animators = 0;
+        uint64_t vertices = 0;
+    };
+
+    // One animated character: plays a clip, cross fades to the next one, computes the joint palette
+    // and skins its vertices when it has any. Skeleton, vertices and clips must outlive it
+    class Animator
+    {
+    public:
+        Animator() = default;
+
+        void init(const Skeleton* skeleton, const SkinnedVertices* vertices = nullptr);
+        void play(const AnimationClip* clip, float speed = 1.0f, bool loop = true);
+        // Blends from what is playing to clip over seconds
+        void crossFade(const AnimationClip* clip, float seconds, float speed = 1.0f, bool loop = true);
+
+        // Adds the time of each stage to stats
+        void update(float delta, AnimationStats& stats);
+
+        const Pose& getPose() const { return pose; }
+        // Model space joint matrices times the inverse bind matrices, what a skinning shader takes
+        const std::vector<glm::mat4>& getPalette() const { return palette; }
+        const std::vector<glm::mat4>& getJointMatrices() const { return models; }
+        const std::vector<glm::vec3>& getSkinnedPositions() const { return positions; }
+        const std::vector<glm::vec3>& getSkinnedNormals() const { return normals; }
+        bool isFading() const { return fadeDuration > 0.0f; }
+    private:
+        struct Layer
+        {
+            const AnimationClip* clip = nullptr;
+            float time = 0.0f;
+            float speed = 1.0f;
+            bool loop = true;
+            std::vector<uint32_t> cursors;
+        };
+
+        const Skeleton* skeleton = nullptr;
+        const SkinnedVertices* vertices = nullptr;
+        Layer current;
+        Layer previous;
+        float fade = 0.0f;
+        float fadeDuration = 0.0f;
+        Pose pose;
+        Pose previousPose;
+        std::vector<glm::mat4> models;
+        std::vector<glm::mat4> palette;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+
+        static void start(Layer& layer, const AnimationClip* clip, float speed, bool loop);
+        static void advance(Layer& layer, float delta);
+        void sample(Layer& layer, Pose& target);
+    };
+
+    // Updates every added animator, one job per animator when jobs is given
+    class AnimationSystem
+    {
+    public:
+        AnimationSystem() = default;
+
+        void add(Animator* animator);
+        void remove(Animator* animator);
+        void update(float delta, jobs::JobSystem* jobs = nullptr);
+
+        // Stats of the last update
+        AnimationStats getStats() const { return stats; }
+        size_t getCount() const { return animators.size(); }
+    private:
+        std::vector<Animator*> animators;
+        AnimationStats stats;
+    };
+}
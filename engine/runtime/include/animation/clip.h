@@ -0,0 +1,60 @@
+#pragma once
+
+#include "animation/skeleton.h"
+#include <string>
+
+namespace runa::runtime::animation
+{
+    enum EAnimationPath : uint8_t
+    {
+        translationPath = 0,
+        rotationPath = 1,
+        scalePath = 2
+    };
+
+    struct AnimationTrack
+    {
+        uint16_t joint = 0;
+        EAnimationPath path = translationPath;
+        bool step = false;
+        uint32_t keyCount = 0;
+        // Into the clip's times, and into its vectors or rotations counted in keys
+        uint32_t firstTime = 0;
+        uint32_t firstValue = 0;
+        // Translations and scales are stored as 16 bit fractions of [min, min + extent]
+        glm::vec3 min = glm::vec3(0.0f);
+        glm::vec3 extent = glm::vec3(0.0f);
+    };
+
+    // Keyframed joint curves of one skeleton. Values are quantized when added: rotations to 16 bit
+    // signed components, translations and scales to 16 bits of the track's range. Times stay floats
+    class AnimationClip
+    {
+    public:
+        std::string name;
+
+        // values holds count vec3 or count quat (x, y, z, w), times are seconds in increasing order
+        void addTrack(uint16_t joint, EAnimationPath path, const float* times, const float* values, uint32_t count, bool step = false);
+        void clear();
+
+        // Writes the joints that have tracks, the others keep what pose had. cursors holds one entry per
+        // track and remembers the last key, playing forward only moves each one by a key or two
+        void sample(float time, Pose& pose, uint32_t* cursors) const;
+
+        float getDuration() const { return duration; }
+        uint32_t getTrackCount() const { return (uint32_t)tracks.size(); }
+        // Memory used by the keys
+        size_t getBytes() const;
+    private:
+        std::vector<AnimationTrack> tracks;
+        std::vector<float> times;
+        // 3 per key
+        std::vector<uint16_t> vectors;
+        // 4 per key
+        std::vector<int16_t> rotations;
+        float duration = 0.0f;
+
+        glm::vec3 decodeVector(const AnimationTrack& track, uint32_t key) const;
+        glm::quat decodeRotation(const AnimationTrack& track, uint32_t key) const;
+    };
+}
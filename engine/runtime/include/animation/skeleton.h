@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace runa::runtime::animation
+{
+    constexpr int32_t noParent = -1;
+
+    // Local translation, rotation and scale of every joint, as arrays so sampling and blending stream
+    struct Pose
+    {
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+
+        void resize(uint32_t joints);
+        uint32_t size() const { return (uint32_t)translations.size(); }
+    };
+
+    // Joints in the order the skinned vertices index them, parents are not required to come first
+    struct Skeleton
+    {
+        std::vector<int32_t> parents;
+        // Mesh space to the joint's space in the bind pose
+        std::vector<glm::mat4> inverseBinds;
+        // Model space of whatever is above a root joint, identity for the others
+        std::vector<glm::mat4> bases;
+        Pose bindPose;
+        // Parents before children, filled by finalize
+        std::vector<uint16_t> order;
+
+        uint32_t size() const { return (uint32_t)parents.size(); }
+        // Sorts the joints by depth, false if the parents loop or point outside the skeleton
+        bool finalize();
+    };
+
+    // Up to four joints per vertex, weights add up to one
+    struct SkinnedVertices
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        // 4 per vertex
+        std::vector<uint16_t> joints;
+        std::vector<glm::vec4> weights;
+
+        uint32_t size() const { return (uint32_t)positions.size(); }
+    };
+
+    // out = a when weight is 0 and b when it is 1, rotations take the short way
+    void blend(const Pose& a, const Pose& b, float weight, Pose& out);
+    // Model space matrix of every joint, then the palette that moves bind pose vertices along with them
+    void computePalette(const Skeleton& skeleton, const Pose& pose, glm::mat4* models, glm::mat4* palette);
+    // Skins vertices [begin, end) with SSE or NEON when the target has them. normals may be nullptr,
+    // they are renormalized but not corrected for non uniform scale
+    void skin(const SkinnedVertices& vertices, const glm::mat4* palette, uint32_t begin, uint32_t end,
+        glm::vec3* positions, glm::vec3* normals);
+}
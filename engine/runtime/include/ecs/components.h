@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace runa::runtime::opengl
+{
+    class Mesh;
+    class Shader;
+}
+
+namespace runa::runtime::ecs
+{
+    struct Transform
+    {
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 scale = glm::vec3(1.0f);
+    };
+
+    // Written by TransformSystem from Transform
+    struct LocalToWorld
+    {
+        glm::mat4 matrix = glm::mat4(1.0f);
+    };
+
+    // Both must outlive the entity and the frames it was drawn in
+    struct MeshRenderer
+    {
+        opengl::Mesh* mesh = nullptr;
+        const opengl::Shader* shader = nullptr;
+    };
+}
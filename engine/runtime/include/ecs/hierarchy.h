@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ecs/transforms.h"
+#include <cstdint>
+#include <vector>
+
+namespace runa::runtime::ecs
+{
+    using TransformNode = uint32_t;
+    constexpr TransformNode noNode = UINT32_MAX;
+
+    // Parent/child transforms kept in depth first order: a parent always comes before its children and
+    // the subtree of a node is the contiguous range [node, subtreeEnd). update() only walks the subtrees
+    // of nodes whose local matrix changed, the cost follows what moved instead of the hierarchy size.
+    class TransformHierarchy
+    {
+    public:
+        TransformHierarchy() = default;
+
+        // parent is noNode for a root, or the last added node or one of its ancestors.
+        // Returns noNode when the order would break
+        TransformNode add(TransformNode parent, const glm::mat4& local);
+        TransformNode add(TransformNode parent, const Transform& local) { return add(parent, compose(local)); }
+        void setLocal(TransformNode node, const glm::mat4& local);
+        void setLocal(TransformNode node, const Transform& local) { setLocal(node, compose(local)); }
+        void clear();
+
+        // Recomposes the world matrices under every changed node, returns how many nodes it touched
+        uint32_t update();
+
+        uint32_t size() const { return (uint32_t)parents.size(); }
+        TransformNode getParent(TransformNode node) const { return parents[node]; }
+        TransformNode getSubtreeEnd(TransformNode node) const { return subtreeEnds[node]; }
+        const glm::mat4& getLocal(TransformNode node) const { return locals[node]; }
+        // As of the last update
+        const glm::mat4& getWorld(TransformNode node) const { return worlds[node]; }
+    private:
+        std::vector<TransformNode> parents;
+        std::vector<TransformNode> subtreeEnds;
+        std::vector<glm::mat4> locals;
+        std::vector<glm::mat4> worlds;
+        std::vector<uint8_t> dirty;
+        // Changed since the last update, ancestors of each other included
+        std::vector<TransformNode> dirtyRoots;
+    };
+}
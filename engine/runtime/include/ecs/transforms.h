@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ecs/world.h"
+#include "ecs/components.h"
+#include "jobs/job_system.h"
+#include <atomic>
+
+namespace runa::runtime::ecs
+{
+    // Translation * rotation * scale without building the three matrices
+    glm::mat4 compose(const Transform& transform);
+    // a * b with SSE or NEON when the target has them
+    glm::mat4 multiply(const glm::mat4& a, const glm::mat4& b);
+
+    // Recomposes LocalToWorld for the chunks whose Transform changed since the last update
+    class TransformSystem
+    {
+    public:
+        TransformSystem() = default;
+
+        // Spreads the chunks over the workers when jobs is given
+        void update(World& world, jobs::JobSystem* jobs = nullptr);
+
+        // Chunks recomposed by the last update
+        uint32_t getUpdatedChunks() const { return updatedChunks; }
+    private:
+        uint32_t lastVersion = 0;
+        std::atomic<uint32_t> updatedChunks = 0;
+    };
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+#include "jobs/job_system.h"
+#include "memory/frame_arena.h"
+#include "memory/pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace runa::runtime::ecs
+{
+    constexpr uint32_t maxComponents = 64;
+    // One bit per component id
+    using ComponentMask = uint64_t;
+    using ComponentId = uint32_t;
+
+    // Index into the entity records plus the generation of the slot, destroyed entities stop resolving
+    struct Entity
+    {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+
+        bool isValid() const { return generation != 0; }
+
+        bool operator==(const Entity&) const = default;
+    };
+
+    struct ComponentInfo
+    {
+        uint32_t size = 0;
+        uint32_t alignment = 0;
+    };
+
+    // Ids are handed out the first time a type is used, they are the same for every World
+    class ComponentRegistry
+    {
+    public:
+        template <typename T>
+        static ComponentId id()
+        {
+            static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                "Components are moved between chunks as bytes");
+            static_assert(alignof(T) <= memory::cacheLine, "Component is over aligned");
+            static const ComponentId value = add(sizeof(T), alignof(T));
+            return value;
+        }
+
+        static const ComponentInfo& info(ComponentId id);
+        static uint32_t count();
+    private:
+        static ComponentId add(uint32_t size, uint32_t alignment);
+    };
+
+    template <typename... Ts>
+    ComponentMask maskOf()
+    {
+        return (ComponentMask(0) | ... | (ComponentMask(1) << ComponentRegistry::id<std::remove_const_t<Ts>>()));
+    }
+
+    // Fixed size block holding up to capacity entities of one archetype as arrays, one per component.
+    // The data starts with the version every column was last written in
+    struct Chunk
+    {
+        std::byte* data = nullptr;
+        uint32_t count = 0;
+
+        uint32_t* versions() const { return reinterpret_cast<uint32_t*>(data); }
+    };
+
+    // Every entity with exactly the same set of components
+    struct Archetype
+    {
+        static constexpr uint8_t noColumn = 0xFF;
+
+        ComponentMask mask = 0;
+        // Sorted by id, column i holds components[i]
+        std::vector<ComponentId> components;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> sizes;
+        uint8_t columnOf[maxComponents];
+        uint32_t entityOffset = 0;
+        uint32_t capacity = 0;
+        uint32_t count = 0;
+        // Only the last one is partially filled
+        std::vector<Chunk> chunks;
+        // Archetype reached by adding or removing a component, filled on first use
+        Archetype* addEdges[maxComponents] = {};
+        Archetype* removeEdges[maxComponents] = {};
+
+        bool has(ComponentId id) const { return columnOf[id] != noColumn; }
+        Entity* entities(const Chunk& chunk) const { return reinterpret_cast<Entity*>(chunk.data + entityOffset); }
+    };
+
+    struct QueryFilter
+    {
+        ComponentMask without = 0;
+        ComponentMask changed = 0;
+        uint32_t since = 0;
+
+        // Skips archetypes having T
+        template <typename T>
+        QueryFilter& exclude()
+        {
+            without |= maskOf<T>();
+            return *this;
+        }
+
+        // Only chunks where any of the changed components was written in version or later
+        template <typename T>
+        QueryFilter& changedSince(uint32_t version)
+        {
+            changed |= maskOf<T>();
+            since = version;
+            return *this;
+        }
+    };
+
+    struct WorldStats
+    {
+        size_t entities = 0;
+        size_t archetypes = 0;
+        size_t chunks = 0;
+        size_t chunkBytes = 0;
+    };
+
+    // Archetype based entity component system. Components are trivially copyable structs stored as
+    // arrays in 16 KB chunks, queries walk the chunks of every archetype that has the requested types.
+    // Writes stamp the chunk column with the world version, systems call advance() when they start and
+    // pass the version their previous run got to changedSince() to only visit what changed since.
+    // Creating, destroying, adding or removing is not allowed while a query is running.
+    class World
+    {
+    public:
+        static constexpr uint32_t chunkBytes = 16 * 1024;
+
+        World();
+        ~World();
+
+        template <typename... Ts>
+        Entity create(const Ts&... components)
+        {
+            Entity entity = create(maskOf<Ts...>());
+            if (!entity.isValid()) return entity;
+            (write<Ts>(entity, components), ...);
+            return entity;
+        }
+        bool destroy(Entity entity);
+        bool isAlive(Entity entity) const;
+
+        template <typename T>
+        bool add(Entity entity, const T& component = T())
+        {
+            ComponentId id = ComponentRegistry::id<T>();
+            if (!isAlive(entity)) return false;
+            if (!records[entity.index].archetype->has(id) && !move(entity, addTarget(records[entity.index].archetype, id))) return false;
+            write<T>(entity, component);
+            return true;
+        }
+
+        template <typename T>
+        bool remove(Entity entity)
+        {
+            ComponentId id = ComponentRegistry::id<T>();
+            if (!isAlive(entity) || !records[entity.index].archetype->has(id)) return false;
+            return move(entity, removeTarget(records[entity.index].archetype, id));
+        }
+
+        template <typename T>
+        bool has(Entity entity) const
+        {
+            return isAlive(entity) && records[entity.index].archetype->has(ComponentRegistry::id<T>());
+        }
+
+        // Marks the component changed, nullptr if the entity does not have it
+        template <typename T>
+        T* get(Entity entity)
+        {
+            return static_cast<T*>(component(entity, ComponentRegistry::id<T>(), true));
+        }
+
+        template <typename T>
+        const T* read(Entity entity) const
+        {
+            return static_cast<const T*>(const_cast<World*>(this)->component(entity, ComponentRegistry::id<T>(), false));
+        }
+
+        // fn(Entity, Ts&...) for every matching entity, const types are read only and do not mark changes
+        template <typename... Ts, typename F>
+        void each(F&& fn, const QueryFilter& filter = {})
+        {
+            eachChunk<Ts...>([&fn](const Entity* entities, uint32_t count, Ts*... columns) {
+                for (uint32_t i = 0; i < count; i++) fn(entities[i], columns[i]...);
+            }, filter);
+        }
+
+        // fn(const Entity*, count, Ts*...) once per chunk, the arrays are cache line aligned
+        template <typename... Ts, typename F>
+        void eachChunk(F&& fn, const QueryFilter& filter = {})
+        {
+            const std::vector<Archetype*>& archetypes = match(maskOf<Ts...>(), filter.without);
+            iterating++;
+            for (Archetype* archetype : archetypes)
+            {
+                for (Chunk& chunk : archetype->chunks) visit<Ts...>(*archetype, chunk, fn, filter);
+            }
+            iterating--;
+        }
+
+        // Same as each with chunks spread over the workers, fn runs concurrently on different entities.
+        // The chunk list lives in the frame arena, callers outside the main loop call frameArenas.beginFrame()
+        template <typename... Ts, typename F>
+        void parallelEach(jobs::JobSystem& jobs, F&& fn, const QueryFilter& filter = {})
+        {
+            parallelEachChunk<Ts...>(jobs, [&fn](const Entity* entities, uint32_t count, Ts*... columns) {
+                for (uint32_t i = 0; i < count; i++) fn(entities[i], columns[i]...);
+            }, filter);
+        }
+
+        template <typename... Ts, typename F>
+        void parallelEachChunk(jobs::JobSystem& jobs, F&& fn, const QueryFilter& filter = {})
+        {
+            const std::vector<Archetype*>& archetypes = match(maskOf<Ts...>(), filter.without);
+            // Rebuilt every call, the frame arena keeps it off the heap
+            std::pmr::vector<std::pair<Archetype*, Chunk*>> chunks(memory::frameResource());
+            for (Archetype* archetype : archetypes)
+            {
+                for (Chunk& chunk : archetype->chunks) chunks.push_back({ archetype, &chunk });
+            }
+
+            iterating++;
+            jobs.parallelFor((uint32_t)chunks.size(), [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++) visit<Ts...>(*chunks[i].first, *chunks[i].second, fn, filter);
+            }, 1);
+            iterating--;
+        }
+
+        // eachChunk over const types that several threads may run at once while nothing changes the
+        // world. Matches the archetypes itself instead of going through the query cache, in the same order
+        template <typename... Ts, typename F>
+        void readChunks(F&& fn) const
+        {
+            static_assert((std::is_const_v<Ts> && ...), "readChunks only reads");
+            ComponentMask all = maskOf<Ts...>();
+            for (const Archetype* archetype : archetypes)
+            {
+                if ((archetype->mask & all) != all) continue;
+                for (const Chunk& chunk : archetype->chunks)
+                {
+                    if (chunk.count == 0) continue;
+                    fn(const_cast<const Entity*>(archetype->entities(chunk)), chunk.count,
+                        reinterpret_cast<Ts*>(chunk.data + archetype->offsets[archetype->columnOf[ComponentRegistry::id<std::remove_const_t<Ts>>()]])...);
+                }
+            }
+        }
+
+        // Starts a new version and returns it, see changedSince
+        uint32_t advance() { return ++version; }
+        uint32_t getVersion() const { return version; }
+        WorldStats getStats() const;
+
+        World(const World&) = delete;
+        World& operator=(const World&) = delete;
+    private:
+        struct EntityRecord
+        {
+            Archetype* archetype = nullptr;
+            uint32_t chunk = 0;
+            uint32_t row = 0;
+            uint32_t generation = 1;
+        };
+
+        struct CachedQuery
+        {
+            ComponentMask all = 0;
+            ComponentMask without = 0;
+            // Archetypes are never destroyed, only the ones created since the last use are checked
+            size_t checked = 0;
+            std::vector<Archetype*> archetypes;
+        };
+
+        // First, chunks are only returned to it with the world
+        memory::PoolAllocator chunkPool;
+        std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> archetypeMap;
+        std::vector<Archetype*> archetypes;
+        std::vector<EntityRecord> records;
+        std::vector<uint32_t> freeIndices;
+        std::vector<std::unique_ptr<CachedQuery>> queries;
+        size_t alive = 0;
+        uint32_t version = 1;
+        uint32_t iterating = 0;
+
+        Entity create(ComponentMask mask);
+        Archetype* getArchetype(ComponentMask mask);
+        Archetype* addTarget(Archetype* archetype, ComponentId id);
+        Archetype* removeTarget(Archetype* archetype, ComponentId id);
+        // Appends a row for entity, the record is left to the caller
+        void pushRow(Archetype& archetype, Entity entity, uint32_t& chunk, uint32_t& row);
+        // Fills the hole with the last row of the archetype
+        void removeRow(Archetype& archetype, uint32_t chunk, uint32_t row);
+        bool move(Entity entity, Archetype* target);
+        void* component(Entity entity, ComponentId id, bool write);
+        const std::vector<Archetype*>& match(ComponentMask all, ComponentMask without);
+        bool structural(const char* operation) const;
+
+        template <typename T>
+        void write(Entity entity, const T& value)
+        {
+            std::memcpy(component(entity, ComponentRegistry::id<T>(), true), &value, sizeof(T));
+        }
+
+        template <typename T>
+        T* column(const Archetype& archetype, const Chunk& chunk)
+        {
+            uint8_t index = archetype.columnOf[ComponentRegistry::id<std::remove_const_t<T>>()];
+            if constexpr (!std::is_const_v<T>) chunk.versions()[index] = version;
+            return reinterpret_cast<T*>(chunk.data + archetype.offsets[index]);
+        }
+
+        static bool changed(const Archetype& archetype, const Chunk& chunk, const QueryFilter& filter)
+        {
+            if (filter.changed == 0) return true;
+            for (size_t i = 0; i < archetype.components.size(); i++)
+            {
+                if (((filter.changed >> archetype.components[i]) & 1) && chunk.versions()[i] >= filter.since) return true;
+            }
+            return false;
+        }
+
+        template <typename... Ts, typename F>
+        void visit(const Archetype& archetype, const Chunk& chunk, F& fn, const QueryFilter& filter)
+        {
+            if (chunk.count == 0 || !changed(archetype, chunk, filter)) return;
+            fn(const_cast<const Entity*>(archetype.entities(chunk)), chunk.count, column<Ts>(archetype, chunk)...);
+        }
+    };
+}
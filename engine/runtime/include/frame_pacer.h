@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+
+namespace runa::runtime
+{
+    struct FramePacingStats
+    {
+        uint64_t targetNS = 0;
+        uint64_t predictedCostNS = 0;
+        // Present to present intervals over the last historySize frames
+        uint64_t p50NS = 0;
+        uint64_t p95NS = 0;
+        uint64_t p99NS = 0;
+        uint64_t maxNS = 0;
+        // Mean absolute deviation from the target, or from the median without a target
+        uint64_t jitterNS = 0;
+        uint64_t missed = 0;
+        uint32_t samples = 0;
+    };
+
+    // Keeps presents on a fixed cadence. Instead of sleeping after the swap, the frame start is
+    // delayed so the predicted work ends right at the deadline, which also keeps input latency low,
+    // and the swap itself waits for the deadline when the frame finished early.
+    // Waiting sleeps while the deadline is far and spins the last stretch, the spin window follows
+    // how much the OS has been oversleeping.
+    class FramePacer
+    {
+    public:
+        FramePacer() = default;
+
+        // 0 disables waiting, intervals are still measured
+        void setTarget(uint64_t frameNS);
+        uint64_t getTarget() const { return targetNS; }
+
+        // Blocks until the frame should start
+        void wait();
+        // Work is done and the frame is about to be presented, blocks until the deadline so
+        // frames that finished early do not show up early
+        void waitPresent();
+        // Frame is done, time is now
+        void endFrame(uint64_t now);
+        // A frame reached the screen at time
+        void presented(uint64_t time);
+
+        FramePacingStats getStats() const;
+
+    private:
+        static constexpr uint32_t historySize = 256;
+
+        uint64_t targetNS = 0;
+        uint64_t deadlineNS = 0;
+        uint64_t frameStartNS = 0;
+        // Set by waitPresent, the wait itself is not part of the frame cost
+        uint64_t workEndNS = 0;
+        uint64_t predictedCostNS = 0;
+        uint64_t spinNS = 1000000;
+        uint64_t lastPresentNS = 0;
+        uint64_t missed = 0;
+
+        uint64_t intervals[historySize] = {};
+        uint32_t intervalCount = 0;
+        uint32_t intervalNext = 0;
+
+        void sleepUntil(uint64_t time);
+    };
+}
@@ -1,25 +1,91 @@
 #pragma once
 
-#include <map>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
 #include <SDL3/SDL.h>
 #include <glm/common.hpp>
 #include <glm/vec2.hpp>
 
 namespace runa::runtime {
-    class Input 
+    using InputAction = uint16_t;
+
+    // A key, a mouse button, or both
+    struct InputBinding
+    {
+        SDL_Scancode key = SDL_SCANCODE_UNKNOWN;
+        uint8_t mouseButton = 0;
+    };
+
+    // Key and button state in flat bitsets indexed by scancode and button. Held is the state after the
+    // last event, pressed, released and repeated collect the edges of the current frame so a tap shorter
+    // than a frame is still seen. Actions map bindings to names and are resolved once per frame.
+    class Input
     {
     public:
+        static constexpr uint8_t mouseButtons = 8;
+        static constexpr uint8_t maxBindings = 4;
+
         Input() = default;
 
+        // Clears the edges of the previous frame, called before the events of a frame
+        void beginFrame();
         void updateEvent(SDL_Event &event);
+        // Called after the events of a frame
+        void resolveActions();
+
+        bool keyHeld(SDL_Scancode scancode) const { return valid(scancode) && held[scancode]; }
+        bool keyPressed(SDL_Scancode scancode) const { return valid(scancode) && pressed[scancode]; }
+        bool keyReleased(SDL_Scancode scancode) const { return valid(scancode) && released[scancode]; }
+        bool keyRepeated(SDL_Scancode scancode) const { return valid(scancode) && repeated[scancode]; }
 
-        bool mouseButtonPressed(int mouseflag);
-        bool keyPressed(SDL_Scancode scancode);
+        bool mouseButtonHeld(int button) const { return button >= 0 && button < mouseButtons && (mouseHeld >> button & 1); }
+        bool mouseButtonPressed(int button) const { return button >= 0 && button < mouseButtons && (mousePressed >> button & 1); }
+        bool mouseButtonReleased(int button) const { return button >= 0 && button < mouseButtons && (mouseReleased >> button & 1); }
 
-        glm::vec2 inputVector(SDL_Scancode positiveX, SDL_Scancode negativeX, SDL_Scancode positiveY, SDL_Scancode negativeY);
-        float inputAxis(SDL_Scancode positive, SDL_Scancode negative);
+        glm::vec2 inputVector(SDL_Scancode positiveX, SDL_Scancode negativeX, SDL_Scancode positiveY, SDL_Scancode negativeY) const;
+        float inputAxis(SDL_Scancode positive, SDL_Scancode negative) const;
+
+        // Returns the existing action when the name is taken
+        InputAction addAction(const char* name);
+        bool bind(InputAction action, InputBinding binding);
+        void clearBindings(InputAction action);
+        // UINT16_MAX when there is none
+        InputAction findAction(const char* name) const;
+
+        bool actionHeld(InputAction action) const { return actionState(action) & heldBit; }
+        bool actionPressed(InputAction action) const { return actionState(action) & pressedBit; }
+        bool actionReleased(InputAction action) const { return actionState(action) & releasedBit; }
+        float actionAxis(InputAction positive, InputAction negative) const;
+        glm::vec2 actionVector(InputAction positiveX, InputAction negativeX, InputAction positiveY, InputAction negativeY) const;
     private:
-        std::map<SDL_Scancode, SDL_KeyboardEvent> scancodes;
-        std::map<int, SDL_MouseButtonEvent> mouseflags;
+        enum EActionBit : uint8_t {
+            heldBit = 1,
+            pressedBit = 2,
+            releasedBit = 4,
+        };
+
+        struct Action
+        {
+            std::string name;
+            InputBinding bindings[maxBindings];
+            uint8_t bindingCount = 0;
+        };
+
+        std::bitset<SDL_SCANCODE_COUNT> held;
+        std::bitset<SDL_SCANCODE_COUNT> pressed;
+        std::bitset<SDL_SCANCODE_COUNT> released;
+        std::bitset<SDL_SCANCODE_COUNT> repeated;
+        uint8_t mouseHeld = 0;
+        uint8_t mousePressed = 0;
+        uint8_t mouseReleased = 0;
+
+        std::vector<Action> actions;
+        // EActionBit flags per action, rebuilt by resolveActions
+        std::vector<uint8_t> actionStates;
+
+        static bool valid(SDL_Scancode scancode) { return scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_SCANCODE_COUNT; }
+        uint8_t actionState(InputAction action) const { return action < actionStates.size() ? actionStates[action] : 0; }
     };
 }
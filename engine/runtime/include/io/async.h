@@ -0,0 +1,153 @@
+#pragma once
+
+#include "io/handlers.h"
+#include "io/task.h"
+#include <coroutine>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace runa::runtime
+{
+    // Awaiters keep their libuv handle or request inside the awaiting coroutine frame,
+    // so nothing is allocated per operation and they can not be copied or moved.
+    // Every completion callback runs on the loop thread, which is where the coroutine resumes.
+
+    class timer_awaiter_c
+    {
+    public:
+        timer_awaiter_c(uv_loop_t* loop, uint64_t timeout) : loop_handler(loop), timeout(timeout) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            awaiting = h;
+            handle.data = this;
+            status = uv_timer_init(loop_handler, &handle);
+            if (status < 0) return false;
+            status = uv_timer_start(&handle, timer_cb, timeout, 0);
+            if (status < 0)
+            {
+                // Handle is initialized, it has to be closed before the frame goes away
+                uv_close((uv_handle_t*)&handle, close_cb);
+            }
+            return true;
+        }
+
+        // 0 or a libuv error code
+        int await_resume() const noexcept { return status; }
+
+        timer_awaiter_c(const timer_awaiter_c&) = delete;
+        timer_awaiter_c& operator=(const timer_awaiter_c&) = delete;
+
+    private:
+        uv_loop_t* loop_handler;
+        uint64_t timeout;
+        uv_timer_t handle;
+        std::coroutine_handle<> awaiting;
+        int status = 0;
+
+        static void timer_cb(uv_timer_t* h)
+        {
+            uv_close((uv_handle_t*)h, close_cb);
+        }
+
+        // Resuming before the close completes would free the handle while libuv still owns it
+        static void close_cb(uv_handle_t* h)
+        {
+            static_cast<timer_awaiter_c*>(h->data)->awaiting.resume();
+        }
+    };
+
+    template <typename F>
+    class work_awaiter_c
+    {
+    public:
+        using result_t = std::invoke_result_t<F&>;
+
+        work_awaiter_c(uv_loop_t* loop, F&& fn) : loop_handler(loop), function(std::forward<F>(fn)) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            awaiting = h;
+            req.data = this;
+            status = uv_queue_work(loop_handler, &req, work_cb, after_work_cb);
+            return status >= 0;
+        }
+
+        // void fn gives the libuv status, otherwise the result of fn which is empty
+        // when the work could not be queued or was cancelled
+        auto await_resume()
+        {
+            if constexpr (std::is_void_v<result_t>)
+            {
+                return status;
+            }
+            else
+            {
+                return std::move(result);
+            }
+        }
+
+        work_awaiter_c(const work_awaiter_c&) = delete;
+        work_awaiter_c& operator=(const work_awaiter_c&) = delete;
+
+    private:
+        struct empty_t {};
+
+        uv_loop_t* loop_handler;
+        std::decay_t<F> function;
+        std::conditional_t<std::is_void_v<result_t>, empty_t, std::optional<result_t>> result;
+        uv_work_t req;
+        std::coroutine_handle<> awaiting;
+        int status = 0;
+
+        // Runs on the libuv thread pool
+        static void work_cb(uv_work_t* r)
+        {
+            auto* self = static_cast<work_awaiter_c*>(r->data);
+            if constexpr (std::is_void_v<result_t>)
+            {
+                self->function();
+            }
+            else
+            {
+                self->result.emplace(self->function());
+            }
+        }
+
+        static void after_work_cb(uv_work_t* r, int status)
+        {
+            auto* self = static_cast<work_awaiter_c*>(r->data);
+            self->status = status;
+            self->awaiting.resume();
+        }
+    };
+
+    // co_await timer(loop, ms) suspends the coroutine for ms milliseconds
+    inline timer_awaiter_c timer(loop_c& loop, uint64_t timeout)
+    {
+        return timer_awaiter_c(loop.get(), timeout);
+    }
+
+    inline timer_awaiter_c timer(uv_loop_t* loop, uint64_t timeout)
+    {
+        return timer_awaiter_c(loop, timeout);
+    }
+
+    // co_await work(loop, fn) runs fn on the libuv thread pool and resumes on the loop thread
+    template <typename F>
+    work_awaiter_c<F> work(loop_c& loop, F&& fn)
+    {
+        return work_awaiter_c<F>(loop.get(), std::forward<F>(fn));
+    }
+
+    template <typename F>
+    work_awaiter_c<F> work(uv_loop_t* loop, F&& fn)
+    {
+        return work_awaiter_c<F>(loop, std::forward<F>(fn));
+    }
+}
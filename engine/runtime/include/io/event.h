@@ -1,24 +1,151 @@
 #pragma once
 
+#include "io/input_recorder.h"
+#include "io/handlers.h"
 #include <SDL3/SDL.h>
+#include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace runa::runtime::io
 {
     enum EEventMode : uint8_t {
+        // Never blocks, for games drawing every frame
         pool = 0,
+        // Blocks until there is input or libuv work, for tools
         wait = 1,
     };
 
+    using EventHandler = std::function<void(SDL_Event&)>;
+
+    struct EventStats
+    {
+        // Taken from SDL
+        uint64_t received = 0;
+        // Mouse motion folded into the motion before it
+        uint64_t coalesced = 0;
+        uint64_t dispatched = 0;
+        // uv_run passes over the loop
+        uint64_t loopPasses = 0;
+        // Frames that stopped passing because the budget ran out
+        uint64_t overBudget = 0;
+        // Frames that blocked for input or libuv work, and the time spent blocked
+        uint64_t waits = 0;
+        uint64_t waitNS = 0;
+    };
+
+    // One frame of the main thread: SDL events first, then the libuv loop (timers, fs completions,
+    // async wakeups, channels) for as long as the budget allows.
     class Event
     {
     public:
+        static constexpr int batchSize = 64;
+        // Without a backend fd to watch, waits wake up this often to run libuv
+        static constexpr int maxWaitMS = 100;
+
         Event() = default;
+        ~Event();
 
+        // Starts the thread that wakes a blocked frame when libuv has work, after SDL is initialized
+        bool init();
+        void deinit();
+
+        // Drains the SDL queue in batches. Input, subscribers of the event type and onEvent see each
+        // event in order, consecutive mouse motion arrives as one event with the summed deltas.
+        // wait, or pool while idle, first blocks until there is an event or libuv work to run
         void run(EEventMode mode);
 
+        // Loop the engine runs its libuv work on, driven by run()
+        uv_loop_t* getLoop() const { return loop.get(); }
+        // Later passes over the loop in one frame stop once this much time has passed,
+        // a single callback running longer is not interrupted. 0 runs one pass per frame
+        void setLoopBudgetNS(uint64_t ns) { loopBudgetNS = ns; }
+        uint64_t getLoopBudgetNS() const { return loopBudgetNS; }
+
+        // Minimized, hidden or occluded, and unfocused when asked to. The game should not draw
+        bool isIdle() const { return minimized || hidden || occluded || (idleWhenUnfocused && !focused); }
+        // Tools in the background can sleep until they get input
+        void setIdleWhenUnfocused(bool idle) { idleWhenUnfocused = idle; }
+        // Any thread, ends the wait of a blocked frame
+        void wake();
+
+        // Handlers only run for the type they subscribed to, returns an id for unsubscribe.
+        // Both are safe from inside a handler. One subscribed there gets events from the next frame,
+        // one unsubscribed gets no further event, from inside a handler it is destroyed at the end of the frame
+        uint32_t subscribe(uint32_t type, EventHandler handler);
+        void unsubscribe(uint32_t id);
+
+        void setCoalesceMotion(bool coalesce) { coalesceMotion = coalesce; }
+        EventStats getStats() const { return stats; }
+
+        // While replaying, live input events are dropped and the recorded ones are fed instead
+        InputRecorder& getRecorder() { return recorder; }
+
+        // Receives every event
         std::function<void(SDL_Event&)> onEvent;
     private:
+        struct Subscriber
+        {
+            uint32_t id;
+            EventHandler handler;
+            // Unsubscribed while handlers ran, skipped until updateSubscribers erases it
+            bool removed = false;
+        };
+
+        struct PendingSubscriber
+        {
+            uint32_t type;
+            Subscriber subscriber;
+        };
+
         SDL_Event event;
+        SDL_Event batch[batchSize];
+        loop_c loop;
+        uint64_t loopBudgetNS = 2000000;
+        // Private event type the watcher pushes, 0 until init
+        uint32_t wakeEvent = 0;
+        bool initialized = false;
+
+        bool minimized = false;
+        bool hidden = false;
+        bool occluded = false;
+        bool focused = true;
+        bool idleWhenUnfocused = false;
+
+        // Blocks on the libuv backend fd while the main thread waits in SDL, then pushes wakeEvent
+        thread_c watcher;
+        std::unique_ptr<async_c> wakeup;
+        std::mutex watchMutex;
+        std::condition_variable watchCondition;
+        int backendFd = -1;
+        bool watching = false;
+        bool armed = false;
+        bool stopping = false;
+
+        SDL_Event motion;
+        bool pendingMotion = false;
+        bool coalesceMotion = true;
+        InputRecorder recorder;
+        EventStats stats;
+
+        std::unordered_map<uint32_t, std::vector<Subscriber>> subscribers;
+        std::vector<PendingSubscriber> pending;
+        uint32_t nextSubscriber = 1;
+        bool dispatching = false;
+        bool unsubscribed = false;
+
+        void block();
+        void runLoop();
+        void watch();
+        void trackWindow(const SDL_Event& received);
+        void drain(bool replay);
+        void receive(SDL_Event& received, bool replay);
+        void flushMotion();
+        void dispatch(SDL_Event& dispatched);
+        // Applies what handlers changed while events were dispatched
+        void updateSubscribers();
     };
-}
\ No newline at end of file
+}
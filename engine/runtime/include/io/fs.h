@@ -1,8 +1,14 @@
 #pragma once
 
+#include "io/handlers.h"
+#include "io/task.h"
 #include <uv.h>
 #include <SDL3/SDL.h>
+#include <coroutine>
+#include <cstdint>
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace runa::runtime
 {
@@ -62,4 +68,99 @@ namespace runa::runtime
         static void read_cb(uv_fs_t* req);
         static void close_cb(uv_fs_t* req);
     };
-}
\ No newline at end of file
+
+    enum fs_op_t : uint8_t
+    {
+        FS_OPEN = 0,
+        FS_CLOSE,
+        FS_READ,
+        FS_WRITE,
+        FS_STAT,
+        FS_FSTAT
+    };
+
+    struct fs_args_t
+    {
+        const char* path = nullptr;
+        int flags = 0;
+        int mode = 0;
+        uv_file file = -1;
+        uv_buf_t buf{};
+        int64_t offset = -1;
+    };
+
+    // Single libuv fs request awaited from a coroutine, the request lives in the coroutine frame
+    class fs_awaiter_c
+    {
+    public:
+        fs_awaiter_c(uv_loop_t* loop, fs_op_t op, const fs_args_t& args) : loop_handler(loop), op(op), args(args) {}
+        ~fs_awaiter_c();
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h);
+        // Result of the request, negative libuv error code on failure
+        ssize_t await_resume() const noexcept { return result; }
+
+        fs_awaiter_c(const fs_awaiter_c&) = delete;
+        fs_awaiter_c& operator=(const fs_awaiter_c&) = delete;
+
+    protected:
+        uv_loop_t* loop_handler;
+        fs_op_t op;
+        uv_fs_t req;
+        bool started = false;
+        std::coroutine_handle<> awaiting;
+        ssize_t result = 0;
+        fs_args_t args;
+        uv_stat_t statbuf{};
+
+        static void fs_cb(uv_fs_t* req);
+    };
+
+    struct fs_stat_t
+    {
+        ssize_t result = 0;
+        uv_stat_t stat{};
+    };
+
+    class fs_stat_awaiter_c : public fs_awaiter_c
+    {
+    public:
+        using fs_awaiter_c::fs_awaiter_c;
+
+        fs_stat_t await_resume() const noexcept { return { result, statbuf }; }
+    };
+
+    struct fs_file_t
+    {
+        // Bytes read, negative libuv error code on failure
+        ssize_t result = 0;
+        std::vector<uint8_t> data;
+    };
+
+    // Coroutine front end for libuv fs, every call resumes the awaiting coroutine on the loop thread
+    //   fs_c fs(loop);
+    //   fs_file_t file = co_await fs.read("assets/scene.gltf");
+    class fs_c
+    {
+    public:
+        explicit fs_c(loop_c& loop) : loop_handler(loop.get()) {}
+        explicit fs_c(uv_loop_t* loop) : loop_handler(loop) {}
+
+        // path must stay valid until the awaiter resumes
+        fs_awaiter_c open(const char* path, int flags, int mode = 0);
+        fs_awaiter_c close(uv_file file);
+        fs_awaiter_c read(uv_file file, void* buffer, size_t size, int64_t offset = -1);
+        fs_awaiter_c write(uv_file file, const void* buffer, size_t size, int64_t offset = -1);
+        fs_stat_awaiter_c stat(const char* path);
+        fs_stat_awaiter_c fstat(uv_file file);
+
+        // Whole file in one buffer sized from fstat
+        task_c<fs_file_t> read(std::string path);
+
+        uv_loop_t* get_loop() const { return loop_handler; }
+
+    private:
+        uv_loop_t* loop_handler;
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace runa::runtime::io
+{
+    enum EInputRecorderMode : uint8_t {
+        idle = 0,
+        recording = 1,
+        replaying = 2,
+    };
+
+    // What is kept of an SDL event, only the types that drive input
+    struct RecordedEvent
+    {
+        uint32_t frame;
+        uint32_t type;
+        // Since the recording started
+        uint64_t timestampNS;
+        union
+        {
+            struct
+            {
+                uint32_t scancode;
+                uint32_t key;
+                uint16_t mod;
+                uint8_t down;
+                uint8_t repeat;
+            } key;
+            struct
+            {
+                float x;
+                float y;
+                uint8_t button;
+                uint8_t down;
+                uint8_t clicks;
+            } button;
+            struct
+            {
+                float x;
+                float y;
+                float xrel;
+                float yrel;
+            } motion;
+            struct
+            {
+                float x;
+                float y;
+                float mouseX;
+                float mouseY;
+            } wheel;
+        };
+    };
+    static_assert(sizeof(RecordedEvent) == 32, "RecordedEvent is written to disk as is");
+
+    // Records the input events of every frame to a binary file and plays them back frame by frame.
+    // Files are little endian, a header followed by the events in frame order.
+    class InputRecorder
+    {
+    public:
+        InputRecorder() = default;
+
+        bool startRecording(const char* path);
+        // Writes the file, also called by the destructor of a recording never stopped
+        bool stopRecording();
+        bool startReplay(const char* path);
+        void stopReplay();
+
+        EInputRecorderMode getMode() const { return mode; }
+        // Average frame time of the recording, replays advance Tick by it every frame
+        uint64_t getFrameDeltaNS() const { return frameDeltaNS; }
+        bool isFinished() const { return mode == replaying && next >= events.size() && frame >= frames; }
+
+        // Called once per frame before its events
+        void beginFrame();
+        // Ignores event types that are not recorded
+        void record(const SDL_Event& event);
+        // Rebuilds the next recorded event of the current frame, false once the frame has none left
+        bool replay(SDL_Event& event);
+
+        static bool isRecorded(uint32_t type);
+
+        ~InputRecorder();
+        InputRecorder(const InputRecorder&) = delete;
+        InputRecorder& operator=(const InputRecorder&) = delete;
+    private:
+        struct FileHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint64_t frames;
+            uint64_t frameDeltaNS;
+            uint64_t events;
+        };
+
+        static constexpr char fileMagic[4] = { 'R', 'I', 'N', 'P' };
+        static constexpr uint32_t fileVersion = 1;
+
+        EInputRecorderMode mode = idle;
+        std::string path;
+        std::vector<RecordedEvent> events;
+        // Frame about to run, counting from the start of the recording or replay
+        uint64_t frame = 0;
+        uint64_t frames = 0;
+        uint64_t startNS = 0;
+        uint64_t frameDeltaNS = 0;
+        size_t next = 0;
+    };
+}
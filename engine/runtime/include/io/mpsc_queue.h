@@ -0,0 +1,191 @@
+#pragma once
+
+#include "io/handlers.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace runa::runtime
+{
+    // Bounded lock free queue, any number of producer threads and a single consumer.
+    // Each cell carries a sequence number telling producers and the consumer whose turn it is,
+    // so a push is one CAS on the tail and a pop touches no shared counter at all.
+    template <typename T>
+    class mpsc_queue_c
+    {
+    public:
+        // Rounded up to a power of two
+        explicit mpsc_queue_c(uint32_t capacity = 1024)
+        {
+            uint64_t size = 2;
+            while (size < capacity) size <<= 1;
+            mask = size - 1;
+            cells = std::make_unique<cell_t[]>(size);
+            for (uint64_t i = 0; i < size; i++)
+            {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~mpsc_queue_c()
+        {
+            T value;
+            while (pop(value)) {}
+        }
+
+        // Any thread, false when the queue is full
+        template <typename U>
+        bool push(U&& value)
+        {
+            cell_t* cell;
+            uint64_t position = tail.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                cell = &cells[position & mask];
+                uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+                int64_t difference = (int64_t)sequence - (int64_t)position;
+                if (difference == 0)
+                {
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                }
+                else if (difference < 0)
+                {
+                    // The consumer has not freed this cell since the last lap
+                    return false;
+                }
+                else
+                {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+
+            new (cell->storage) T(std::forward<U>(value));
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer thread only, false when empty or the next message is still being written
+        bool pop(T& value)
+        {
+            cell_t* cell = &cells[head & mask];
+            if (cell->sequence.load(std::memory_order_acquire) != head + 1) return false;
+
+            T* stored = std::launder(reinterpret_cast<T*>(cell->storage));
+            value = std::move(*stored);
+            stored->~T();
+            cell->sequence.store(head + mask + 1, std::memory_order_release);
+            head++;
+            return true;
+        }
+
+        uint32_t capacity() const { return (uint32_t)(mask + 1); }
+
+        mpsc_queue_c(const mpsc_queue_c&) = delete;
+        mpsc_queue_c& operator=(const mpsc_queue_c&) = delete;
+
+    private:
+        struct cell_t
+        {
+            std::atomic<uint64_t> sequence;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        std::unique_ptr<cell_t[]> cells;
+        uint64_t mask = 0;
+        // Producers and the consumer on separate cache lines
+        alignas(64) std::atomic<uint64_t> tail = 0;
+        alignas(64) uint64_t head = 0;
+    };
+
+    struct channel_stats_t
+    {
+        uint64_t posted = 0;
+        uint64_t dropped = 0;
+        uint64_t wakeups = 0;
+        uint64_t delivered = 0;
+    };
+
+    // Typed messages from any thread into a loop_c. Posting pushes on a mpsc_queue_c and only
+    // the first post after the loop drained sends the async, later posts ride the same wakeup.
+    // T is usually a std::variant of the messages one system accepts (asset ready, log line...).
+    template <typename T>
+    class channel_c
+    {
+    public:
+        channel_c(loop_c& loop, uint32_t capacity, std::function<void(T&)> cb) : channel_c(loop.get(), capacity, std::move(cb)) {}
+
+        channel_c(uv_loop_t* loop, uint32_t capacity, std::function<void(T&)> cb)
+            : queue(capacity), callback(std::move(cb)), async(loop, [this]() { drain(); })
+        {
+        }
+
+        // Any thread, false and the message is dropped when the queue is full
+        template <typename U>
+        bool post(U&& message)
+        {
+            if (!queue.push(std::forward<U>(message)))
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            posted.fetch_add(1, std::memory_order_relaxed);
+
+            if (!signaled.exchange(true, std::memory_order_acq_rel))
+            {
+                async.send();
+            }
+            return true;
+        }
+
+        void close() { async.close(); }
+
+        channel_stats_t get_stats() const
+        {
+            return {
+                posted.load(std::memory_order_relaxed),
+                dropped.load(std::memory_order_relaxed),
+                wakeups,
+                delivered
+            };
+        }
+
+        channel_c(const channel_c&) = delete;
+        channel_c& operator=(const channel_c&) = delete;
+
+    private:
+        mpsc_queue_c<T> queue;
+        std::function<void(T&)> callback;
+        std::atomic<bool> signaled = false;
+        std::atomic<uint64_t> posted = 0;
+        std::atomic<uint64_t> dropped = 0;
+        // Loop thread only
+        uint64_t wakeups = 0;
+        uint64_t delivered = 0;
+        async_c async;
+
+        void drain()
+        {
+            wakeups++;
+            // Cleared before popping, a post landing after this point sends a new wakeup
+            signaled.store(false, std::memory_order_seq_cst);
+
+            // At most one lap per wakeup so a flood of producers can not starve the loop
+            uint32_t budget = queue.capacity();
+            T message;
+            while (queue.pop(message))
+            {
+                delivered++;
+                if (callback) callback(message);
+                if (--budget == 0)
+                {
+                    // Whatever is left goes on the next loop iteration
+                    if (!signaled.exchange(true, std::memory_order_acq_rel)) async.send();
+                    return;
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace runa::runtime
+{
+    // Recycles coroutine frames through per-thread size classed free lists,
+    // so steady state awaiting never reaches the heap
+    class frame_allocator_c
+    {
+    public:
+        static void* allocate(size_t size);
+        static void deallocate(void* ptr, size_t size);
+
+        // Frames that could not be served from a free list since startup
+        static uint64_t heap_allocations();
+    };
+
+    template <typename T>
+    class task_c;
+
+    namespace detail
+    {
+        struct promise_base_c
+        {
+            std::coroutine_handle<> continuation;
+            bool detached = false;
+
+            static void* operator new(size_t size) { return frame_allocator_c::allocate(size); }
+            static void operator delete(void* ptr, size_t size) { frame_allocator_c::deallocate(ptr, size); }
+
+            struct final_awaiter_c
+            {
+                bool await_ready() const noexcept { return false; }
+
+                template <typename P>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept
+                {
+                    promise_base_c& promise = handle.promise();
+                    if (promise.continuation) return promise.continuation;
+                    if (promise.detached) handle.destroy();
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+
+            // Lazy, nothing runs until awaited or detached
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            final_awaiter_c final_suspend() const noexcept { return {}; }
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+
+        template <typename T>
+        struct promise_c : promise_base_c
+        {
+            std::optional<T> value;
+
+            task_c<T> get_return_object() noexcept;
+
+            template <typename U>
+            void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+        };
+
+        template <>
+        struct promise_c<void> : promise_base_c
+        {
+            task_c<void> get_return_object() noexcept;
+
+            void return_void() const noexcept {}
+        };
+    }
+
+    // Coroutine returned by async engine code. Awaiting it resumes the awaiting coroutine when it
+    // finishes, on the same thread, so code awaiting libuv operations stays on the owning loop_c.
+    template <typename T = void>
+    class task_c
+    {
+    public:
+        using promise_type = detail::promise_c<T>;
+
+        task_c() = default;
+        explicit task_c(std::coroutine_handle<promise_type> h) : handle(h) {}
+        ~task_c()
+        {
+            if (handle) handle.destroy();
+        }
+
+        task_c(task_c&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+        task_c& operator=(task_c&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+
+        task_c(const task_c&) = delete;
+        task_c& operator=(const task_c&) = delete;
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+
+        T await_resume()
+        {
+            if constexpr (!std::is_void_v<T>)
+            {
+                return std::move(*handle.promise().value);
+            }
+        }
+
+        // Starts the task without awaiting it, the frame frees itself when it completes
+        void detach()
+        {
+            std::coroutine_handle<promise_type> h = std::exchange(handle, {});
+            if (!h) return;
+            h.promise().detached = true;
+            h.resume();
+        }
+
+        bool done() const { return !handle || handle.done(); }
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        task_c<T> promise_c<T>::get_return_object() noexcept
+        {
+            return task_c<T>(std::coroutine_handle<promise_c<T>>::from_promise(*this));
+        }
+
+        inline task_c<void> promise_c<void>::get_return_object() noexcept
+        {
+            return task_c<void>(std::coroutine_handle<promise_c<void>>::from_promise(*this));
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <memory>
+#include <vector>
+
+#if !defined(_WIN32) && !(defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)))
+#define RUNA_FIBER_UCONTEXT
+#include <ucontext.h>
+#endif
+
+namespace runa::runtime::jobs
+{
+    using FiberFunction = void (*)(void* arg);
+
+    // Stackful execution context. x86-64 POSIX switches with a few instructions of assembly,
+    // Windows uses the Win32 fiber API and other platforms fall back to ucontext.
+    class Fiber
+    {
+    public:
+        Fiber() = default;
+        ~Fiber();
+
+        // Allocates a stack with a guard page, entry must never return
+        bool init(size_t stackSize, FiberFunction entry, void* arg);
+        // Wraps the running thread so a fiber can switch back to it
+        bool initFromThread();
+        void deinit();
+
+        // Saves the running context into this fiber and resumes target
+        void switchTo(Fiber& target);
+
+        Fiber(const Fiber&) = delete;
+        Fiber& operator=(const Fiber&) = delete;
+    private:
+        FiberFunction entry = nullptr;
+        void* arg = nullptr;
+        bool fromThread = false;
+#if defined(_WIN32)
+        void* handle = nullptr;
+#else
+        void* stack = nullptr;
+        size_t stackBytes = 0;
+#if defined(RUNA_FIBER_UCONTEXT)
+        ucontext_t context;
+#else
+        void* sp = nullptr;
+#endif
+#endif
+
+        static void start(Fiber* fiber);
+#if defined(RUNA_FIBER_UCONTEXT)
+        static void startContext(uint32_t low, uint32_t high);
+#elif defined(_WIN32)
+        static void __stdcall startWin32(void* fiber);
+#endif
+    };
+
+    // Fixed set of fibers created up front, so waiting jobs never allocate a stack
+    class FiberPool
+    {
+    public:
+        FiberPool() = default;
+        ~FiberPool();
+
+        bool init(uint32_t count, size_t stackSize, FiberFunction entry, void* arg);
+        void deinit();
+
+        // nullptr when every fiber is in use
+        Fiber* acquire();
+        void release(Fiber* fiber);
+
+        uint32_t available();
+        uint32_t size() const { return (uint32_t)fibers.size(); }
+    private:
+        std::vector<std::unique_ptr<Fiber>> fibers;
+        std::vector<Fiber*> freeList;
+        std::mutex mutex;
+    };
+}
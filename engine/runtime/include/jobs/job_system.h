@@ -0,0 +1,200 @@
+#pragma once
+
+#include "jobs/work_stealing_deque.h"
+#include "jobs/fiber.h"
+#include "io/handlers.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace runa::runtime::jobs
+{
+    enum EJobMode : uint8_t {
+        // wait() runs other jobs on the waiting job's stack
+        threads = 0,
+        // Jobs run on pooled fibers, wait() parks the fiber and the worker moves on
+        fibers = 1
+    };
+
+    // Receives the job data and the [begin, end) range it was submitted with
+    using JobFunction = void (*)(void* data, uint32_t begin, uint32_t end);
+
+    // Number of jobs still pending in a group, wait on it or use it as a dependency
+    class Counter
+    {
+    public:
+        Counter() = default;
+
+        bool isDone() const { return value.load(std::memory_order_acquire) == 0; }
+        int32_t pending() const { return value.load(std::memory_order_relaxed); }
+
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+    private:
+        friend class JobSystem;
+        std::atomic<int32_t> value = 0;
+    };
+
+    struct Job
+    {
+        JobFunction function = nullptr;
+        void* data = nullptr;
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        Counter* counter = nullptr;
+        // Job is held back until this counter reaches zero
+        Counter* dependency = nullptr;
+    };
+
+    struct JobStats
+    {
+        uint64_t executed = 0;
+        uint64_t stolen = 0;
+        uint64_t sleeps = 0;
+        uint64_t switches = 0;
+        uint32_t waitingFibers = 0;
+    };
+
+    // Per-core workers with work stealing deques. The thread calling init becomes worker 0 and
+    // only runs jobs while it waits, so waiting on a counter helps instead of blocking.
+    // In fibers mode the other workers run jobs on pooled fibers and a job waiting on a counter
+    // is suspended until the counter reaches zero, then resumed by whichever worker finds it.
+    class JobSystem
+    {
+    public:
+        JobSystem() = default;
+        ~JobSystem();
+
+        // 0 uses one worker per logical core
+        bool init(uint32_t workerCount = 0, EJobMode mode = threads);
+        void deinit();
+
+        void run(JobFunction function, void* data, Counter* counter = nullptr);
+        void run(JobFunction function, void* data, uint32_t begin, uint32_t end, Counter* counter, Counter* dependency = nullptr);
+
+        // Splits [0, count) in chunks of at least minChunk and calls fn(begin, end) on each,
+        // fn must outlive the counter
+        template <typename F>
+        void parallelFor(uint32_t count, F& fn, Counter& counter, uint32_t minChunk = 64)
+        {
+            if (count == 0) return;
+            uint32_t chunk = chunkSize(count, minChunk);
+            for (uint32_t begin = 0; begin < count; begin += chunk)
+            {
+                uint32_t end = begin + chunk < count ? begin + chunk : count;
+                run([](void* data, uint32_t b, uint32_t e) { (*static_cast<F*>(data))(b, e); }, &fn, begin, end, &counter);
+            }
+        }
+
+        // Blocking version, the calling thread runs chunks too
+        template <typename F>
+        void parallelFor(uint32_t count, F&& fn, uint32_t minChunk = 64)
+        {
+            if (count <= minChunk || !initialized)
+            {
+                if (count > 0) fn(0u, count);
+                return;
+            }
+            Counter counter;
+            parallelFor(count, fn, counter, minChunk);
+            wait(counter);
+        }
+
+        // Suspends the calling fiber, or runs other jobs, until counter reaches zero
+        void wait(Counter& counter);
+
+        bool isInitialized() const { return initialized; }
+        EJobMode getMode() const { return mode; }
+        uint32_t getWorkerCount() const { return (uint32_t)workers.size(); }
+        JobStats getStats() const;
+
+        // UINT32_MAX on threads that are not workers
+        static uint32_t getWorkerIndex();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+    private:
+        // Jobs queued per worker are bounded by the ring, a slot is reused once its job was taken
+        static constexpr uint32_t maxJobsPerWorker = 4096;
+        static constexpr uint32_t fiberCount = 128;
+        static constexpr size_t fiberStackSize = 128 * 1024;
+
+        // The deque holds pointers into the ring. busy is cleared by whoever took the job out of the
+        // deque once it copied it, until then the owner does not write the slot again
+        struct JobSlot
+        {
+            Job job;
+            std::atomic<bool> busy = false;
+        };
+
+        struct alignas(64) Worker
+        {
+            WorkStealingDeque<JobSlot> deque{ maxJobsPerWorker };
+            std::unique_ptr<JobSlot[]> ring = std::make_unique<JobSlot[]>(maxJobsPerWorker);
+            uint32_t allocated = 0;
+            uint32_t seed = 0;
+            std::atomic<uint64_t> executed = 0;
+            std::atomic<uint64_t> stolen = 0;
+            std::atomic<uint64_t> sleeps = 0;
+            std::atomic<uint64_t> switches = 0;
+            std::unique_ptr<thread_c> thread;
+        };
+
+        struct WaitingFiber
+        {
+            Fiber* fiber;
+            Counter* counter;
+        };
+
+        bool initialized = false;
+        EJobMode mode = threads;
+        std::atomic<bool> running = false;
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        // Submissions from threads that are not workers (libuv pool, SDL timers)
+        std::mutex injectMutex;
+        std::deque<Job> injected;
+        std::atomic<uint32_t> injectedCount = 0;
+
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        std::atomic<uint32_t> sleeping = 0;
+        std::atomic<int64_t> pendingJobs = 0;
+        // Counters reaching zero while fibers are parked, wakes a worker to resume them
+        std::atomic<uint32_t> resumeSignals = 0;
+
+        // Jobs whose dependency is not done yet, released when a counter reaches zero
+        std::mutex deferredMutex;
+        std::vector<Job> deferred;
+        std::atomic<uint32_t> deferredCount = 0;
+
+        FiberPool fiberPool;
+        std::mutex waitMutex;
+        std::vector<WaitingFiber> waiting;
+        std::atomic<uint32_t> waitingCount = 0;
+
+        uint32_t chunkSize(uint32_t count, uint32_t minChunk) const;
+        // Queues a job that can run now, on the calling worker's deque when there is room
+        void submit(const Job& job);
+        void defer(const Job& job);
+        void releaseDeferred();
+        void inject(const Job& job);
+        JobSlot* acquireSlot(Worker& worker);
+        bool tryRunOne(uint32_t index);
+        Job* fetch(uint32_t index, Job& local);
+        void execute(Job& job);
+        void wake();
+        void sleep(uint32_t index);
+        void workerLoop(uint32_t index);
+
+        Fiber* popResumable();
+        void switchFiber(Fiber* next, uint8_t action, Counter* counter);
+        void afterSwitch();
+        void fiberLoop();
+        static void fiberEntry(void* arg);
+    };
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace runa::runtime::jobs
+{
+    // Chase-Lev deque with a fixed power of two capacity.
+    // The owner thread pushes and pops at the bottom, any other thread steals from the top.
+    template <typename T>
+    class WorkStealingDeque
+    {
+    public:
+        explicit WorkStealingDeque(uint32_t capacity = 4096) : buffer(capacity), mask(capacity - 1)
+        {
+        }
+
+        // Owner only, when false a push succeeds, stealers only make room
+        bool full() const
+        {
+            return bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_acquire) > mask;
+        }
+
+        // Owner only, returns false when full
+        bool push(T* item)
+        {
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_acquire);
+            if (b - t > (int64_t)mask) return false;
+
+            buffer[b & mask].store(item, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Owner only, LIFO so recently pushed work stays hot in cache
+        T* pop()
+        {
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                // Empty
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T* item = buffer[b & mask].load(std::memory_order_relaxed);
+            if (t == b)
+            {
+                // Last item, race against stealers for it
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    item = nullptr;
+                }
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        // Any thread, FIFO from the owner's point of view
+        T* steal()
+        {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b) return nullptr;
+
+            T* item = buffer[t & mask].load(std::memory_order_acquire);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return item;
+        }
+
+        bool empty() const
+        {
+            return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    private:
+        // top and bottom on separate cache lines, stealers hammer one and the owner the other
+        alignas(64) std::atomic<int64_t> top = 0;
+        alignas(64) std::atomic<int64_t> bottom = 0;
+        std::vector<std::atomic<T*>> buffer;
+        int64_t mask;
+    };
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "config.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runa::runtime::memory
+{
+    enum EAllocationTag : uint8_t {
+        generalTag = 0,
+        renderTag = 1,
+        resourceTag = 2,
+        ioTag = 3,
+        jobTag = 4,
+    };
+
+    struct AllocationStats
+    {
+        static constexpr size_t tags = 5;
+
+        size_t liveBytes[tags] = {};
+        size_t liveCount[tags] = {};
+        uint64_t allocations[tags] = {};
+        // Over the last completed frame
+        uint64_t frameAllocations[tags] = {};
+        size_t frameBytes[tags] = {};
+        // Double frees, frees of memory operator new never returned and delete/delete[] mismatches
+        uint64_t badFrees = 0;
+    };
+
+    // Counts every operator new and delete by the tag of the calling thread, and keeps the callstack of
+    // one allocation in every sampleRate until it is freed. Only compiled in with ENGINE_ALLOCATION_TRACKER,
+    // otherwise everything stays zero. Replacing the global operators means it is live before main and
+    // after every static destructor, so it lives in constant initialized storage of its own.
+    class AllocationTracker
+    {
+    public:
+        static constexpr uint32_t maxFrames = 16;
+
+        constexpr AllocationTracker() = default;
+
+        static constexpr bool isCompiled()
+        {
+#if defined(ENGINE_ALLOCATION_TRACKER)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Called once per frame by the main loop
+        void frame();
+
+        // 0 stops sampling, stacks already taken are kept
+        void setSampleRate(uint32_t every) { sampleRate.store(every, std::memory_order_relaxed); }
+        uint32_t getSampleRate() const { return sampleRate.load(std::memory_order_relaxed); }
+
+        AllocationStats getStats() const;
+        // Logs what is still allocated per tag and the sampled stacks among it, returns the live count
+        size_t reportLeaks(size_t maxStacks = 32);
+
+        static const char* tagName(EAllocationTag tag);
+
+        // Used by the operator new and delete replacements
+        void* allocate(size_t size, size_t alignment, bool array);
+        void deallocate(void* pointer, bool array);
+
+        AllocationTracker(const AllocationTracker&) = delete;
+        AllocationTracker& operator=(const AllocationTracker&) = delete;
+    private:
+        struct TagCounters
+        {
+            std::atomic<size_t> liveBytes = 0;
+            std::atomic<size_t> liveCount = 0;
+            std::atomic<uint64_t> allocations = 0;
+            std::atomic<uint64_t> frameAllocations = 0;
+            std::atomic<size_t> frameBytes = 0;
+            std::atomic<uint64_t> lastFrameAllocations = 0;
+            std::atomic<size_t> lastFrameBytes = 0;
+        };
+
+        TagCounters counters[AllocationStats::tags];
+        std::atomic<uint64_t> badFrees = 0;
+        std::atomic<uint64_t> frames = 0;
+        std::atomic<uint32_t> sampleRate = 128;
+
+        void badFree(const char* reason, void* pointer);
+    };
+
+    // Tags the allocations of the calling thread until it goes out of scope
+    class AllocationScope
+    {
+    public:
+        explicit AllocationScope(EAllocationTag tag);
+        ~AllocationScope();
+
+        static EAllocationTag current();
+
+        AllocationScope(const AllocationScope&) = delete;
+        AllocationScope& operator=(const AllocationScope&) = delete;
+    private:
+        EAllocationTag previous;
+    };
+}
+
+namespace runa::runtime
+{
+    extern memory::AllocationTracker allocationTracker;
+}
+
+#define RUNA_ALLOCATION_CONCAT_INNER(a, b) a##b
+#define RUNA_ALLOCATION_CONCAT(a, b) RUNA_ALLOCATION_CONCAT_INNER(a, b)
+
+#if defined(ENGINE_ALLOCATION_TRACKER)
+#define RUNA_ALLOCATION_TAG(tag) ::runa::runtime::memory::AllocationScope RUNA_ALLOCATION_CONCAT(allocationScope, __LINE__)(tag)
+#else
+#define RUNA_ALLOCATION_TAG(tag)
+#endif
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace runa::runtime::memory
+{
+    struct ArenaStats
+    {
+        // Bytes handed out since the last reset
+        size_t used = 0;
+        size_t capacity = 0;
+        // Most bytes any frame used
+        size_t peak = 0;
+        uint64_t allocations = 0;
+        // Blocks taken from the heap since startup, stays flat once frames fit
+        uint64_t heapAllocations = 0;
+    };
+
+    // Bump allocator over a list of blocks, nothing is freed one by one. reset() keeps the memory
+    // and folds the blocks of a frame that overflowed into a single one big enough for it, so the
+    // following frames never go back to the heap.
+    class LinearArena
+    {
+    public:
+        explicit LinearArena(size_t blockSize = 256 * 1024);
+        ~LinearArena();
+
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+        // Never destroyed, only for types that do not need it
+        template <typename T, typename... Args>
+        T* create(Args&&... args)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+        template <typename T>
+        T* allocateArray(size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+        // Null terminated copy
+        const char* copyString(std::string_view text);
+
+        void reset();
+        const ArenaStats& getStats() const { return stats; }
+
+        LinearArena(const LinearArena&) = delete;
+        LinearArena& operator=(const LinearArena&) = delete;
+    private:
+        struct Block
+        {
+            std::byte* data;
+            size_t size;
+        };
+
+        size_t blockSize;
+        std::vector<Block> blocks;
+        size_t current = 0;
+        size_t offset = 0;
+        ArenaStats stats;
+
+        void addBlock(size_t minimum);
+        void freeBlocks();
+    };
+
+    // Two arenas per thread used on alternate frames, so memory allocated during frame N stays valid
+    // until frame N + 1 ends. That covers the render thread drawing a packet one frame behind.
+    // A thread resets its older arena the first time it allocates in a new frame.
+    class FrameArenas
+    {
+    public:
+        static constexpr size_t blockSize = 256 * 1024;
+
+        FrameArenas() = default;
+
+        // Called once per frame by the main loop
+        void beginFrame();
+        uint64_t getFrame() const { return frame.load(std::memory_order_relaxed); }
+
+        // Arena of the calling thread for the current frame
+        LinearArena& current();
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) { return current().allocate(size, alignment); }
+        const char* copyString(std::string_view text) { return current().copyString(text); }
+
+        // Summed over every thread, used is what the last completed frames needed
+        ArenaStats getStats();
+
+        FrameArenas(const FrameArenas&) = delete;
+        FrameArenas& operator=(const FrameArenas&) = delete;
+    private:
+        struct ThreadArenas
+        {
+            LinearArena arenas[2] = { LinearArena(blockSize), LinearArena(blockSize) };
+            uint64_t frame = 0;
+            // Published on reset, read by getStats from other threads
+            std::atomic<size_t> used = 0;
+            std::atomic<size_t> capacity = 0;
+            std::atomic<size_t> peak = 0;
+            std::atomic<uint64_t> allocations = 0;
+            std::atomic<uint64_t> heapAllocations = 0;
+        };
+
+        std::atomic<uint64_t> frame = 0;
+        std::mutex mutex;
+        // Kept after their thread exits, threads are few and long lived
+        std::vector<std::unique_ptr<ThreadArenas>> threads;
+
+        ThreadArenas* threadArenas();
+        static void publish(ThreadArenas& local, const LinearArena& arena);
+    };
+
+    // std::pmr adapter over one arena, deallocate does nothing
+    class ArenaResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit ArenaResource(LinearArena& arena) : arena(arena) {}
+    private:
+        LinearArena& arena;
+
+        void* do_allocate(size_t bytes, size_t alignment) override { return arena.allocate(bytes, alignment); }
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    // std::pmr adapter over the current frame arena of whichever thread allocates. Containers using it
+    // must not outlive the next frame, and must not be grown from another frame than the one they started in
+    class FrameResource : public std::pmr::memory_resource
+    {
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    FrameResource* frameResource();
+}
+
+namespace runa::runtime
+{
+    extern memory::FrameArenas frameArenas;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace runa::runtime::memory
+{
+    constexpr size_t cacheLine = 64;
+
+    struct PoolStats
+    {
+        size_t blockSize = 0;
+        // Blocks handed out and not returned yet
+        size_t live = 0;
+        size_t capacity = 0;
+        size_t slabs = 0;
+        uint64_t allocations = 0;
+        // Allocations served by a thread cache without taking the lock
+        uint64_t cacheHits = 0;
+    };
+
+    // Fixed size blocks carved out of slabs, freed blocks go on an intrusive free list and slabs are only
+    // released with the pool. With thread caches every thread keeps a few blocks of its own and only locks
+    // to move a batch between its cache and the shared list.
+    class PoolAllocator
+    {
+    public:
+        static constexpr uint32_t cacheSize = 32;
+        // Threads alive at once past this share the locked list, an exiting thread frees its index
+        static constexpr uint32_t maxCaches = 64;
+
+        PoolAllocator(size_t blockSize, size_t alignment = cacheLine, uint32_t blocksPerSlab = 64, bool threadCaches = false);
+        ~PoolAllocator();
+
+        void* allocate();
+        void deallocate(void* block);
+
+        size_t getBlockSize() const { return blockSize; }
+        PoolStats getStats();
+
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        // Only ever written by the thread owning its index, counters are atomic for getStats
+        struct alignas(cacheLine) ThreadCache
+        {
+            FreeBlock* blocks[cacheSize];
+            std::atomic<uint32_t> count = 0;
+            std::atomic<uint64_t> hits = 0;
+        };
+
+        size_t blockSize;
+        size_t alignment;
+        uint32_t blocksPerSlab;
+
+        std::mutex mutex;
+        FreeBlock* freeList = nullptr;
+        std::vector<std::byte*> slabs;
+        size_t live = 0;
+        uint64_t allocations = 0;
+        std::unique_ptr<ThreadCache[]> caches;
+
+        // Index of the calling thread into caches, on exit it flushes the caches of every pool and
+        // the index goes to the next thread
+        struct ThreadSlot;
+
+        ThreadCache* threadCache();
+        // Returns the blocks cached under index to the shared list
+        void flushCache(uint32_t index);
+        // Called with the lock held
+        FreeBlock* pop();
+        void addSlab();
+    };
+
+    // Typed pool constructing objects in place, blocks are cache line aligned so objects used
+    // from different threads never share a line
+    template <typename T>
+    class ObjectPool
+    {
+    public:
+        explicit ObjectPool(uint32_t blocksPerSlab = 64, bool threadCaches = false)
+            : pool(sizeof(T), std::max(alignof(T), cacheLine), blocksPerSlab, threadCaches) {}
+
+        template <typename... Args>
+        T* create(Args&&... args)
+        {
+            return new (pool.allocate()) T(std::forward<Args>(args)...);
+        }
+
+        void destroy(T* object)
+        {
+            if (!object) return;
+            object->~T();
+            pool.deallocate(object);
+        }
+
+        PoolStats getStats() { return pool.getStats(); }
+    private:
+        PoolAllocator pool;
+    };
+}
@@ -3,14 +3,19 @@
 #include "opengl/vertex_array.h"
 #include "opengl/texture.h"
 #include "opengl/mesh.h"
+#include "opengl/command_buffer.h"
+#include "resources/resource_manager.h"
+#include "ecs/hierarchy.h"
+#include "animation/animator.h"
+#include "animation/clip.h"
 #include <cgltf.h>
 #include <glad/glad.h>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <glm/ext/quaternion_float.hpp>
+#include <memory>
 #include <vector>
-#include <map>
 
 namespace runa::runtime::models
 {
@@ -20,25 +25,69 @@ namespace runa::runtime::models
         gltf() = default;
         ~gltf();
 
+        // Loads the meshes of the default scene (or every root node) with their node transforms
         bool init(const char* filepath);
         void deinit();
 
+        // World matrices are relative to the model, update() before reading them after a setLocal
+        ecs::TransformHierarchy& getHierarchy() { return hierarchy; }
+        const std::vector<resources::MeshHandle>& getMeshes() const { return meshes; }
+        // Node each mesh hangs from, same order as getMeshes
+        const std::vector<ecs::TransformNode>& getMeshNodes() const { return meshNodes; }
+        // Node of a cgltf node index, noNode if it is not in the loaded scene
+        ecs::TransformNode getNode(size_t gltfNode) const { return gltfNode < nodes.size() ? nodes[gltfNode] : ecs::noNode; }
+
+        // One skeleton per glTF skin, joints in the skin's order
+        const std::vector<animation::Skeleton>& getSkeletons() const { return skeletons; }
+        // Every glTF animation in file order, as clips of one skeleton. Channels on nodes outside of it are dropped
+        const std::vector<animation::AnimationClip>& getClips(size_t skin) const;
+        // Skeleton of a mesh, -1 if it is not skinned
+        int32_t getMeshSkin(size_t mesh) const { return mesh < meshSkins.size() ? meshSkins[mesh] : -1; }
+        // Bind pose vertices to skin, nullptr if the mesh is not skinned
+        const animation::SkinnedVertices* getSkinnedVertices(size_t mesh) const;
+        // Skins the mesh of this instance, nullptr if it is not skinned. Add it to an AnimationSystem to
+        // have it played, and remove it before deinit
+        animation::Animator* getAnimator(size_t mesh) { return mesh < animators.size() ? animators[mesh].get() : nullptr; }
+
+        // Every mesh at its node, model places the whole model. Skinned meshes upload what their
+        // animator skinned last and are placed by their joints instead of their node
+        void draw(opengl::CommandBuffer& commands, const opengl::Shader& shader, const opengl::Camera& camera, const glm::mat4& model = glm::mat4(1.0f));
+
     private:
         cgltf_data* data = nullptr;
         std::string dir;
+        std::string file;
+        // Hash of the normalized path, meshes are cached under it
+        uint64_t fileKey = 0;
 
-        std::map<const char*, opengl::Texture> modelTextures;
-        std::vector<opengl::Mesh> meshes;
-        std::vector<glm::vec3> translationsMeshes;
-        std::vector<glm::quat> rotationsMeshes;
-        std::vector<glm::vec3> scalesMeshes;
-        std::vector<glm::mat4> matricesMeshes;
+        std::vector<resources::MeshHandle> meshes;
+        std::vector<ecs::TransformNode> meshNodes;
+        ecs::TransformHierarchy hierarchy;
+        // Indexed by cgltf node
+        std::vector<ecs::TransformNode> nodes;
+        std::vector<animation::Skeleton> skeletons;
+        // Indexed by skin, then by glTF animation
+        std::vector<std::vector<animation::AnimationClip>> clips;
+        // Same order as meshes
+        std::vector<int32_t> meshSkins;
+        std::vector<animation::SkinnedVertices> skinnedVertices;
+        std::vector<std::unique_ptr<animation::Animator>> animators;
+        std::vector<resources::TextureHandle> textures;
+        bool texturesLoaded = false;
 
-        void loadMesh(unsigned int indMesh);
+        // Depth first, the order the hierarchy needs
+        void loadNode(cgltf_node* node, ecs::TransformNode parent);
+        void loadMesh(unsigned int indMesh, ecs::TransformNode node, const cgltf_skin* skin);
+        bool loadSkin(const cgltf_skin* skin, animation::Skeleton& skeleton);
+        void loadAnimation(const cgltf_animation* source, const cgltf_skin* skin, animation::AnimationClip& clip);
+        void loadSkinnedVertices(const cgltf_primitive* primitive, const cgltf_skin* skin, animation::SkinnedVertices& vertices);
+        // Joint of every cgltf node in skin, -1 for the others
+        std::vector<int32_t> jointsOf(const cgltf_skin* skin);
 	    std::vector<uint8_t> getData();
-        std::vector<float> getFloats(cgltf_accessor* accessor);
-        std::vector<GLuint> getIndices(cgltf_accessor* accessor);
-        std::vector<opengl::Texture> getTextures();
+        std::vector<float> getFloats(const cgltf_accessor* accessor);
+        std::vector<GLuint> getIndices(const cgltf_accessor* accessor);
+        // Loaded by the first mesh, holds a reference to each until deinit
+        const std::vector<resources::TextureHandle>& getTextures();
 
         std::vector<opengl::Vertex> assembleVertices(std::vector<glm::vec3> positions, std::vector<glm::vec3> normals, std::vector<glm::vec2> texCoords);
 
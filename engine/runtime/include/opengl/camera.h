@@ -1,3 +1,5 @@
+#pragma once
+
 #include "shader.h"
 #include <SDL3/SDL.h>
 #include <glm/glm.hpp>
@@ -23,6 +25,9 @@ namespace runa::runtime::opengl {
         // Prevents the camera from jumping around when first clicking left click
         bool firstClick = true;
 
+        // Right button held, the mouse is captured
+        bool grabbed = false;
+
         // Window w/h
         int width = 0;
         int height = 0;
@@ -33,8 +38,12 @@ namespace runa::runtime::opengl {
 
         // Updates and exports the camera matrix to the Vertex Shader
         void updateMatrix(float FOVdeg, float nearPlane, float farPlane);
+        // Same for a view of the given size instead of the window
+        void updateMatrix(float FOVdeg, float nearPlane, float farPlane, int viewWidth, int viewHeight);
         void matrix(const Shader &shader, const char *uniform) const;
-        // Handles camera inputs
+        // Movement keys and the right button grab, once per frame after the events
+        void updateInputs();
+        // Mouse look while grabbed, only needs mouse motion events
         void inputs(SDL_Event &event);
         void tick(float delta);
     };
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "opengl/mesh.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace runa::runtime::opengl
+{
+    // Render commands recorded on the game thread and executed on the thread owning the GL context.
+    // A command is a trivially copyable callable stored inline, so recording is a copy into a buffer
+    // that keeps its capacity from frame to frame. Anything a command points to must stay alive
+    // until the frame it was recorded in has been presented.
+    class CommandBuffer
+    {
+    public:
+        CommandBuffer() = default;
+
+        template <typename F>
+        void record(const F& fn)
+        {
+            static_assert(std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>,
+                "Commands are copied as bytes, capture values and pointers only");
+            static_assert(alignof(F) <= sizeof(Block), "Command is over aligned");
+
+            Header* header = allocate(sizeof(F));
+            header->execute = [](const void* payload) { (*static_cast<const F*>(payload))(); };
+            new (header + 1) F(fn);
+        }
+
+        void clear(const glm::vec4& color);
+        void viewport(int x, int y, int width, int height);
+        // Resolves the mesh textures now, the render thread never touches the resource manager
+        void drawMesh(Mesh& mesh, const Shader& shader, const Camera& camera);
+        // Sets the model uniform of shader first
+        void drawMesh(Mesh& mesh, const Shader& shader, const Camera& camera, const glm::mat4& model);
+        // Uploads new positions and normals to a dynamic mesh, its other attributes are kept. The
+        // vertices are copied to the frame arena, the arrays can change as soon as this returns.
+        // normals may be nullptr
+        void updateVertices(Mesh& mesh, const glm::vec3* positions, const glm::vec3* normals, size_t count);
+
+        void execute() const;
+        void reset();
+
+        uint32_t getCount() const { return count; }
+        size_t getBytes() const { return used * sizeof(Block); }
+
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+    private:
+        struct alignas(16) Block
+        {
+            std::byte data[16];
+        };
+
+        struct alignas(16) Header
+        {
+            void (*execute)(const void* payload);
+            // Header plus payload, in blocks
+            uint32_t blocks;
+        };
+
+        std::vector<Block> blocks;
+        size_t used = 0;
+        uint32_t count = 0;
+
+        Header* allocate(size_t payload);
+    };
+}
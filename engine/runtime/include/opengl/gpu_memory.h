@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace runa::runtime::opengl {
+    enum EGpuMemoryCategory : uint8_t {
+        vertexMemory = 0,
+        indexMemory = 1,
+        textureMemory = 2,
+        // Color and depth attachments of render targets
+        targetMemory = 3,
+        otherMemory = 4,
+    };
+
+    enum EGpuObject : uint8_t {
+        bufferObject = 0,
+        textureObject = 1,
+        renderbufferObject = 2,
+    };
+
+    struct GpuAllocation
+    {
+        EGpuObject object = bufferObject;
+        GLuint id = 0;
+        EGpuMemoryCategory category = otherMemory;
+        size_t bytes = 0;
+        std::string owner;
+    };
+
+    struct GpuMemoryStats
+    {
+        static constexpr size_t categories = 5;
+
+        size_t bytes[categories] = {};
+        size_t peak[categories] = {};
+        size_t count[categories] = {};
+        // 0 means no budget
+        size_t budget[categories] = {};
+        size_t total = 0;
+        size_t totalPeak = 0;
+        size_t totalBudget = 0;
+    };
+
+    // Size, category and owner of every buffer, texture and renderbuffer the runtime creates.
+    // Sizes are estimated from the storage that was asked for, drivers may pad or compress.
+    // Objects are created on whichever thread owns the context, so everything is locked.
+    class GpuMemory {
+    public:
+        GpuMemory() = default;
+
+        void track(EGpuObject object, GLuint id, EGpuMemoryCategory category, size_t bytes, const char* owner = nullptr);
+        // Forgets an object, fine to call for one that was never tracked
+        void untrack(EGpuObject object, GLuint id);
+
+        // Budgets are checked on every track(), 0 removes one
+        void setBudget(EGpuMemoryCategory category, size_t bytes);
+        void setTotalBudget(size_t bytes);
+
+        GpuMemoryStats getStats();
+        // Largest allocations first, at most max of them
+        void getAllocations(std::vector<GpuAllocation>& out, size_t max);
+
+        static size_t textureBytes(GLenum internalFormat, int width, int height, bool mipmaps);
+        static const char* categoryName(EGpuMemoryCategory category);
+
+        // Called once when a category goes over its budget, and again only after it came back under.
+        // category is otherMemory + 1 for the total. Runs on the thread that created the object, outside the lock
+        std::function<void(uint8_t category, size_t bytes, size_t budget)> onBudgetExceeded;
+
+        GpuMemory(const GpuMemory&) = delete;
+        GpuMemory& operator=(const GpuMemory&) = delete;
+    private:
+        std::mutex mutex;
+        std::unordered_map<uint64_t, GpuAllocation> allocations;
+        GpuMemoryStats stats;
+        bool over[GpuMemoryStats::categories + 1] = {};
+
+        static uint64_t key(EGpuObject object, GLuint id) { return (uint64_t)object << 32 | id; }
+    };
+}
+
+namespace runa::runtime
+{
+    extern opengl::GpuMemory gpuMemory;
+}
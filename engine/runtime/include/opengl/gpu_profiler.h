@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+
+namespace runa::runtime::opengl {
+    // GL timestamp queries around render passes, results are read a few frames later so the
+    // GPU is never waited on, then shown on the GPU track of utils::Profiler in CPU time.
+    // Everything except init() runs on the thread owning the context.
+    class GpuProfiler {
+    public:
+        static constexpr uint32_t framesInFlight = 4;
+        static constexpr uint32_t maxZones = 32;
+        static constexpr uint32_t maxDepth = 8;
+
+        GpuProfiler() = default;
+        ~GpuProfiler();
+
+        // False without timestamp queries (GLES), the profiler then stays inert
+        bool init();
+        void deinit();
+
+        bool isSupported() const { return supported; }
+
+        // Reads the oldest frame back and starts a new one, zones are recorded only while utils::Profiler is enabled
+        void beginFrame();
+        void begin(const char* name);
+        void end();
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+    private:
+        struct Zone {
+            const char* name;
+            uint32_t depth;
+            bool closed;
+        };
+
+        struct Frame {
+            GLuint queries[maxZones * 2] = {};
+            Zone zones[maxZones] = {};
+            uint32_t count = 0;
+            // CPU minus GPU clock when the frame started
+            int64_t offsetNS = 0;
+            bool pending = false;
+        };
+
+        bool supported = false;
+        bool active = false;
+        Frame frames[framesInFlight];
+        uint32_t current = 0;
+        uint32_t open[maxDepth] = {};
+        uint32_t depth = 0;
+
+        void resolve(Frame& frame);
+    };
+}
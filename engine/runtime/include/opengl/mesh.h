@@ -4,25 +4,53 @@
 #include "opengl/element_buffer.h"
 #include "opengl/camera.h"
 #include "opengl/texture.h"
+#include "resources/handle.h"
+#include <vector>
 
 namespace runa::runtime::opengl
 {
     class Mesh
     {
     public:
+        // Texture units a single draw binds
+        static constexpr size_t maxTextures = 8;
+
         Mesh() = default;
         ~Mesh();
 
-        bool init(std::vector<Vertex>& vertices, std::vector<GLuint>& indices, std::vector <Texture>& textures);
+        // A dynamic mesh takes new vertices every frame through updateVertices, skinned meshes are
+        bool init(std::vector<Vertex>& vertices, std::vector<GLuint>& indices, std::vector<resources::Handle<Texture>>& textures, bool dynamic = false);
         bool init(std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
         void deinit();
 
         void draw(const Shader& shader, const Camera& camera);
+        // Draws with textures resolved ahead of time, nullptr entries are skipped.
+        // Used by recorded commands, which must not touch the resource manager on the render thread
+        void draw(const Shader& shader, const glm::vec3& camPos, const glm::mat4& camMatrix, Texture* const* resolved, size_t count);
+
+        // Fills out with the loaded textures of this mesh, returns how many were written
+        size_t resolveTextures(Texture** out, size_t max) const;
+
+        // Vertices it was created with, never changed by updateVertices
+        const std::vector<Vertex>& getVertices() const { return vertices; }
+        bool isDynamic() const { return dynamic; }
+        // Replaces the first count vertices on the GPU, only for dynamic meshes. GL thread only,
+        // CommandBuffer::updateVertices records it
+        void updateVertices(const Vertex* updated, size_t count);
+
+        // Owns GL names, share meshes through resources::MeshHandle instead of copying
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
     private:
         std::vector <Vertex> vertices;
         std::vector <GLuint> indices;
-        std::vector <Texture> textures;
+        // One reference held on each texture until deinit
+        std::vector <resources::Handle<Texture>> textures;
         // Store VAO in public so it can be used in the Draw function
         VertexArray vao;
+        // Kept with the mesh so their memory is accounted for as long as the VAO uses them
+        VertexBuffer vbo;
+        ElementBuffer ebo;
+        bool dynamic = false;
     };
 }
\ No newline at end of file
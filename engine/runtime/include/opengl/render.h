@@ -1,14 +1,31 @@
 #pragma once
 
+#include "opengl/render_thread.h"
+#include "opengl/render_target.h"
+#include "opengl/gpu_profiler.h"
+#include "opengl/gpu_memory.h"
+#include "frame_pacer.h"
 #include <SDL3/SDL.h>
 #include <imgui.h>
+#include "utils/profiler.h"
 #include <string>
 #include <functional>
+#include <vector>
 
 namespace runa::runtime::opengl {
     enum EDriver : uint8_t {
         core = 0,
         es = 1,
+        // Desktop core profile on SDL's offscreen video driver (EGL pbuffer), no display or GPU
+        // required with Mesa llvmpipe. Frames are drawn into a RenderTarget
+        headless = 2,
+    };
+
+    enum ERenderMode : uint8_t {
+        // Records and draws on the calling thread
+        immediate = 0,
+        // Records on the calling thread, draws one frame behind on a render thread
+        threaded = 1,
     };
 
     class Backend
@@ -23,7 +40,9 @@ namespace runa::runtime::opengl {
         SDL_Window* getWindow() const;
         SDL_GLContext getContext() const;
         const char* getGlslVersion();
+        bool isHeadless() const { return driverType == headless; }
     private:
+        EDriver driverType = core;
         SDL_Window* windowPtr = nullptr;
         SDL_GLContext context = nullptr;
         const char* glslVersion = "";
@@ -41,9 +60,20 @@ namespace runa::runtime::opengl {
         bool isInitialized() const { return initialized; }
 
         ImGuiIO* getIO();
+
+        // Timeline of the last frames with every profiled thread, and trace export
+        void drawProfiler();
+        // Tracked GPU memory per category against the budgets, and the largest allocations
+        void drawGpuMemory();
     private:
         bool initialized = false;
         ImGuiIO* io = nullptr;
+        std::vector<utils::ProfileTrack> profileTracks;
+        int profileFrames = 4;
+        bool profilePaused = false;
+        uint64_t profileStartNS = 0;
+        uint64_t profileEndNS = 0;
+        std::vector<GpuAllocation> gpuAllocations;
     };
 
     class Render {
@@ -56,15 +86,50 @@ namespace runa::runtime::opengl {
 
         void poll();
 
+        // GL objects have to be created and destroyed in immediate mode, or from recorded commands
+        bool setMode(ERenderMode mode);
+        ERenderMode getMode() const { return mode; }
+        RenderStats getStats();
+        FramePacingStats getPacingStats() const { return pacer.getStats(); }
+
+        // Writes every frame as directory/frame_000000.png, nullptr stops
+        void dumpFrames(const char* directory);
+        // Writes the next frame to path
+        void captureFrame(const char* path);
+        uint64_t getFrame() const { return frames; }
+
         const Backend& getBackend() { return backend; }
-        const ImGuiBackend& getImGuiBackend() { return imguiBackend; }
+        ImGuiBackend& getImGuiBackend() { return imguiBackend; }
 
         std::function<void(SDL_Event&)> onEvent;
         std::function<void(ImGuiIO&)> onImGuiRender;
+        // Immediate mode only, draws straight to GL
         std::function<void(double)> onRender;
+        // Both modes, commands run wherever the context lives
+        std::function<void(double, CommandBuffer&)> onRecord;
     private:
         bool initialized = false;
+        ERenderMode mode = immediate;
         Backend backend;
         ImGuiBackend imguiBackend;
+        RenderThread renderThread;
+        CommandBuffer commands;
+        FramePacer pacer;
+        // Drawn into in headless mode or while frames are dumped, only touched from commands
+        RenderTarget target;
+        GpuProfiler gpuProfiler;
+        std::string dumpDirectory;
+        std::string capturePath;
+
+        int viewportWidth = 0;
+        int viewportHeight = 0;
+        uint64_t frames = 0;
+        uint64_t lastPollNS = 0;
+        RenderStats stats;
+
+        void record(CommandBuffer& buffer);
+        void recordTargetEnd(CommandBuffer& buffer);
+        void pollImmediate();
+        void pollThreaded();
     };
 }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+namespace runa::runtime::opengl {
+    // Offscreen color and depth attachments, what headless rendering draws into and frame dumps read from
+    class RenderTarget {
+    public:
+        RenderTarget() = default;
+        ~RenderTarget();
+
+        bool init(int width, int height);
+        void deinit();
+        // Keeps the target when the size did not change
+        bool resize(int width, int height);
+
+        void bind() const;
+        void unbind() const;
+        // Copies color into destination and leaves destination bound
+        void blit(GLuint destination, int destinationWidth, int destinationHeight) const;
+
+        // RGBA8, top row first
+        bool readPixels(std::vector<uint8_t>& pixels) const;
+        bool savePNG(const char* path) const;
+
+        bool isValid() const { return framebuffer != 0; }
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+        GLuint getColorTexture() const { return color; }
+
+        RenderTarget(const RenderTarget&) = delete;
+        RenderTarget& operator=(const RenderTarget&) = delete;
+    private:
+        GLuint framebuffer = 0;
+        GLuint color = 0;
+        GLuint depth = 0;
+        int width = 0;
+        int height = 0;
+    };
+}
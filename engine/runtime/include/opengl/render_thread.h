@@ -0,0 +1,101 @@
+#pragma once
+
+#include "opengl/command_buffer.h"
+#include "io/handlers.h"
+#include <SDL3/SDL.h>
+#include <imgui.h>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace runa::runtime::opengl
+{
+    class Backend;
+    class GpuProfiler;
+
+    // Everything the render thread needs to draw one frame
+    struct FramePacket
+    {
+        CommandBuffer commands;
+        // Owned by ImGui, valid until the game thread starts the next ImGui frame
+        ImDrawData* imgui = nullptr;
+        uint64_t frame = 0;
+        uint64_t submittedNS = 0;
+    };
+
+    struct RenderStats
+    {
+        uint64_t frames = 0;
+        // Game thread frame to frame
+        uint64_t frameNS = 0;
+        // Game thread recording the packet
+        uint64_t recordNS = 0;
+        // Game thread blocked on the render thread
+        uint64_t waitNS = 0;
+        // Render thread executing the packet, swap included
+        uint64_t executeNS = 0;
+        // Submit to present
+        uint64_t latencyNS = 0;
+        uint32_t commands = 0;
+    };
+
+    // Owns the GL context while running. The game thread records frame N into one packet while
+    // this thread draws frame N - 1 from the other, submit() hands a packet over and blocks only
+    // if the render thread has not finished the previous one yet.
+    class RenderThread
+    {
+    public:
+        RenderThread() = default;
+        ~RenderThread();
+
+        // Moves the context of backend from the calling thread to the render thread
+        bool init(Backend& backend, GpuProfiler* gpuProfiler = nullptr);
+        // Joins and makes the context current on the calling thread again
+        void deinit();
+
+        bool isRunning() const { return running; }
+
+        // Packet to record the next frame into, never the one being drawn
+        FramePacket& acquire();
+        // Returns the time spent blocked
+        uint64_t submit();
+        // Blocks until the ImGui draw data of the packet in flight has been rendered,
+        // ImGui must not start a new frame before that. Returns the time spent blocked
+        uint64_t waitImGui();
+        // Blocks until every submitted packet has been presented
+        void finish();
+
+        // Render thread side of the last presented frame
+        void getStats(RenderStats& stats);
+        // 0 until the first present
+        uint64_t getLastPresentNS();
+
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+    private:
+        Backend* backend = nullptr;
+        GpuProfiler* gpuProfiler = nullptr;
+        thread_c thread;
+        bool running = false;
+
+        FramePacket packets[2];
+        uint32_t writeIndex = 0;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        FramePacket* pending = nullptr;
+        bool busy = false;
+        bool imguiDone = true;
+        bool stopping = false;
+        // Set by the render thread once it tried to take the context
+        bool started = false;
+        bool contextFailed = false;
+
+        uint64_t executeNS = 0;
+        uint64_t latencyNS = 0;
+        uint64_t lastPresentNS = 0;
+
+        void loop();
+        void draw(FramePacket& packet);
+    };
+}
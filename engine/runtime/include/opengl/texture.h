@@ -1,6 +1,7 @@
 #pragma once
 
 #include "shader.h"
+#include <SDL3/SDL.h>
 #include <glad/glad.h>
 
 namespace runa::runtime::opengl {
@@ -10,17 +11,29 @@ namespace runa::runtime::opengl {
         ~Texture();
 
         bool init(const char* texturefile, const char* textype, GLenum slot, GLenum channels, GLenum pixeltype);
+        // Uploads an already decoded surface, so decoding can happen off the render thread.
+        // owner names the texture in GPU memory stats
+        bool init(SDL_Surface* surf, const char* textype, GLenum slot, GLenum channels, GLenum pixeltype, const char* owner = nullptr);
         void denit();
 
         void texUnit(const Shader& shader, const char* uniform, GLuint unit);
 
         void bind() const;
+        void bind(GLuint slot) const;
         void unbind() const;
 
         const char* getType();
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        // GL names are owned, copies would delete the same texture twice
+        Texture(const Texture&) = delete;
+        Texture& operator=(const Texture&) = delete;
     private:
         GLuint id = 0;
         const char* type = 0;
         GLuint unit = 0;
+        int width = 0;
+        int height = 0;
     };
 }
@@ -16,6 +16,6 @@ namespace runa::runtime::opengl {
         void unbind() const;
         void enableAttrib(const VertexBuffer &vertex_buffer, const GLuint layout, GLuint num, GLenum type, GLsizeiptr stride, void *offset) const;
     private:
-        GLuint id;
+        GLuint id = 0;
     };
 }
\ No newline at end of file
@@ -19,12 +19,15 @@ namespace runa::runtime::opengl {
         VertexBuffer() = default;
         ~VertexBuffer();
 
-        void init(const Vertex* vertices, GLsizeiptr count);
+        // GL_DYNAMIC_DRAW for buffers rewritten every frame with update
+        void init(const Vertex* vertices, GLsizeiptr count, GLenum usage = GL_STATIC_DRAW);
         void deinit();
+        // Overwrites the first count vertices
+        void update(const Vertex* vertices, GLsizeiptr count);
 
         void bind() const;
         void unbind() const;
     private:
-        GLuint id;
+        GLuint id = 0;
     };
 }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace runa::runtime::resources
+{
+    // Index into a ResourcePool plus the generation of the slot when it was handed out.
+    // A released slot bumps its generation, so stale handles resolve to nullptr instead of a reused resource.
+    template <typename T>
+    struct Handle
+    {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+
+        bool isValid() const { return generation != 0; }
+
+        bool operator==(const Handle&) const = default;
+    };
+}
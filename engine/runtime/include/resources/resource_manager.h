@@ -0,0 +1,79 @@
+#pragma once
+
+#include "resources/resource_pool.h"
+#include "opengl/texture.h"
+#include "opengl/mesh.h"
+#include "io/task.h"
+#include <uv.h>
+#include <string>
+#include <vector>
+
+namespace runa::runtime::resources
+{
+    using TextureHandle = Handle<opengl::Texture>;
+    using MeshHandle = Handle<opengl::Mesh>;
+
+    struct ResourceStats
+    {
+        size_t textures = 0;
+        size_t texturesLoading = 0;
+        size_t texturesFailed = 0;
+        size_t textureRefs = 0;
+        size_t meshes = 0;
+        size_t meshRefs = 0;
+        uint64_t textureHits = 0;
+        uint64_t textureMisses = 0;
+        uint64_t meshHits = 0;
+        uint64_t meshMisses = 0;
+    };
+
+    // Owns every texture and mesh created through it. Loads are deduplicated by the hash of
+    // the normalized path, so scenes sharing materials decode and upload each file once.
+    class ResourceManager
+    {
+    public:
+        ResourceManager() = default;
+        ~ResourceManager();
+
+        void deinit();
+
+        TextureHandle loadTexture(const char* filepath, const char* textype, GLenum channels = 0, GLenum pixeltype = GL_UNSIGNED_BYTE);
+        // Decodes an encoded image held in memory, like one embedded in a .glb. Cached under key the
+        // same way as createMesh, owner names the texture in GPU memory stats
+        TextureHandle loadTexture(uint64_t key, const void* bytes, size_t size, const char* textype, const char* owner, GLenum channels = 0, GLenum pixeltype = GL_UNSIGNED_BYTE);
+        // Decodes on the libuv thread pool and uploads in the after callback, on the thread running loop.
+        // The handle is usable immediately, get() returns nullptr until the state is loaded.
+        // Every async load must use the same loop, deinit runs it until the decodes are done
+        TextureHandle loadTextureAsync(uv_loop_t* loop, const char* filepath, const char* textype, GLenum channels = 0, GLenum pixeltype = GL_UNSIGNED_BYTE);
+        opengl::Texture* get(TextureHandle handle) const;
+        EResourceState getState(TextureHandle handle) const;
+        void retain(TextureHandle handle);
+        void release(TextureHandle handle);
+
+        // Key 0 creates a mesh nobody else can find, see utils::hash for keyed meshes. Dynamic meshes
+        // are rewritten every frame and should not be shared
+        MeshHandle createMesh(uint64_t key, std::vector<opengl::Vertex>& vertices, std::vector<GLuint>& indices, std::vector<TextureHandle>& textures, bool dynamic = false);
+        MeshHandle findMesh(uint64_t key);
+        opengl::Mesh* get(MeshHandle handle) const;
+        void retain(MeshHandle handle);
+        void release(MeshHandle handle);
+
+        ResourceStats getStats() const;
+
+        ResourceManager(const ResourceManager&) = delete;
+        ResourceManager& operator=(const ResourceManager&) = delete;
+    private:
+        ResourcePool<opengl::Texture> textures;
+        ResourcePool<opengl::Mesh> meshes;
+
+        uint64_t textureHits = 0;
+        uint64_t textureMisses = 0;
+        uint64_t meshHits = 0;
+        uint64_t meshMisses = 0;
+        uv_loop_t* decodeLoop = nullptr;
+        uint32_t pendingDecodes = 0;
+
+        static uint64_t textureKey(const char* filepath);
+        task_c<void> decodeTexture(uv_loop_t* loop, TextureHandle handle, std::string path, std::string textype, GLenum channels, GLenum pixeltype);
+    };
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "resources/handle.h"
+#include "memory/pool.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace runa::runtime::resources
+{
+    enum EResourceState : uint8_t {
+        unloaded = 0,
+        loading = 1,
+        loaded = 2,
+        failed = 3
+    };
+
+    // Generational slot storage with reference counting and key based deduplication.
+    // Resources live in slabs of their own so growing the pool never moves a GL object.
+    // Not thread safe, only touch it from the thread that owns the GL context.
+    template <typename T>
+    class ResourcePool
+    {
+    public:
+        ResourcePool() = default;
+        ~ResourcePool() { clear(); }
+
+        // Returns a new reference to the resource registered with key, or an invalid handle
+        Handle<T> find(uint64_t key)
+        {
+            auto it = lookup.find(key);
+            if (it == lookup.end()) return {};
+
+            Slot& slot = slots[it->second];
+            slot.refs++;
+            return { it->second, slot.generation };
+        }
+
+        // Allocates an empty resource with one reference. Key 0 creates an anonymous resource,
+        // a key already registered returns a new reference to that resource instead
+        Handle<T> create(uint64_t key)
+        {
+            if (key != 0)
+            {
+                Handle<T> existing = find(key);
+                if (existing.isValid()) return existing;
+            }
+
+            uint32_t index;
+            if (!freeSlots.empty())
+            {
+                index = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else
+            {
+                index = (uint32_t)slots.size();
+                slots.emplace_back();
+            }
+
+            Slot& slot = slots[index];
+            slot.resource = objects.create();
+            slot.key = key;
+            slot.refs = 1;
+            slot.state = unloaded;
+            if (key != 0) lookup[key] = index;
+            live++;
+
+            return { index, slot.generation };
+        }
+
+        T* get(Handle<T> handle) const
+        {
+            const Slot* slot = resolve(handle);
+            return slot ? slot->resource : nullptr;
+        }
+
+        EResourceState getState(Handle<T> handle) const
+        {
+            const Slot* slot = resolve(handle);
+            return slot ? slot->state : unloaded;
+        }
+
+        void setState(Handle<T> handle, EResourceState state)
+        {
+            if (Slot* slot = resolve(handle)) slot->state = state;
+        }
+
+        uint32_t getRefs(Handle<T> handle) const
+        {
+            const Slot* slot = resolve(handle);
+            return slot ? slot->refs : 0;
+        }
+
+        void addRef(Handle<T> handle)
+        {
+            if (Slot* slot = resolve(handle)) slot->refs++;
+        }
+
+        // Drops one reference and destroys the resource with the last one, returns true when destroyed
+        bool release(Handle<T> handle)
+        {
+            Slot* slot = resolve(handle);
+            if (!slot || --slot->refs > 0) return false;
+
+            destroy(handle.index);
+            return true;
+        }
+
+        void clear()
+        {
+            for (uint32_t i = 0; i < slots.size(); i++)
+            {
+                if (slots[i].resource) destroy(i);
+            }
+            lookup.clear();
+        }
+
+        template <typename F>
+        void forEach(F&& fn) const
+        {
+            for (const Slot& slot : slots)
+            {
+                if (slot.resource) fn(*slot.resource, slot.state, slot.refs);
+            }
+        }
+
+        size_t count() const { return live; }
+        size_t capacity() const { return slots.size(); }
+
+    private:
+        struct Slot
+        {
+            T* resource = nullptr;
+            uint64_t key = 0;
+            // Starts at 1 so a zeroed handle is never valid
+            uint32_t generation = 1;
+            uint32_t refs = 0;
+            EResourceState state = unloaded;
+        };
+
+        memory::ObjectPool<T> objects;
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+        std::unordered_map<uint64_t, uint32_t> lookup;
+        size_t live = 0;
+
+        Slot* resolve(Handle<T> handle)
+        {
+            if (!handle.isValid() || handle.index >= slots.size()) return nullptr;
+            Slot& slot = slots[handle.index];
+            if (slot.generation != handle.generation || !slot.resource) return nullptr;
+            return &slot;
+        }
+
+        const Slot* resolve(Handle<T> handle) const
+        {
+            return const_cast<ResourcePool*>(this)->resolve(handle);
+        }
+
+        void destroy(uint32_t index)
+        {
+            Slot& slot = slots[index];
+            if (slot.key != 0) lookup.erase(slot.key);
+            objects.destroy(slot.resource);
+            slot.resource = nullptr;
+            slot.key = 0;
+            slot.refs = 0;
+            slot.state = unloaded;
+            if (++slot.generation == 0) slot.generation = 1;
+            freeSlots.push_back(index);
+            live--;
+        }
+    };
+}
@@ -1,16 +1,28 @@
 #pragma once
 
 #include "opengl/render.h"
+#include "opengl/gpu_memory.h"
 #include "io/event.h"
 #include "tick.h"
 #include "input.h"
 #include "settings.h"
+#include "resources/resource_manager.h"
+#include "jobs/job_system.h"
+#include "utils/profiler.h"
+#include "memory/frame_arena.h"
+#include "memory/allocation_tracker.h"
 
 namespace runa::runtime
 {
+    extern utils::Profiler profiler;
+    extern memory::FrameArenas frameArenas;
+    extern memory::AllocationTracker allocationTracker;
     extern GameUserSettings gameUserSettings;
     extern opengl::Render render;
+    extern opengl::GpuMemory gpuMemory;
     extern io::Event event;
     extern Tick tick;
     extern Input input;
+    extern resources::ResourceManager resourceManager;
+    extern jobs::JobSystem jobSystem;
 }
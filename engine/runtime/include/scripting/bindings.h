@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ecs/world.h"
+#include "scripting/script_system.h"
+
+struct lua_State;
+
+namespace runa::runtime::scripting
+{
+    // Light userdata tag of entities, they travel as their packed handle without allocating
+    constexpr int entityTag = 1;
+    // Userdata tag of transform.view(), its methods are dispatched by atom
+    constexpr int viewTag = 1;
+
+    void pushEntity(lua_State* L, ecs::Entity entity);
+    // Raises a Lua error when the argument is not an entity
+    ecs::Entity checkEntity(lua_State* L, int index);
+
+    // Registers the transform, input, timer and message libraries in the globals of L. Installs the atom
+    // callback, so it runs before anything else creates strings in the VM
+    void openEngineLibs(lua_State* L);
+
+    // Applies a write a deferred ScriptSystem recorded, payload is the one of that system
+    void applyWrite(ecs::World& world, const ScriptWrite& write, const std::byte* payload);
+}
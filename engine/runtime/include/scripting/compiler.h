@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace runa::runtime::scripting
+{
+    // Cooked bytecode sits next to the source with this extension
+    constexpr const char* bytecodeExtension = ".luauc";
+
+    // Luau bytecode of source, false with the compiler message in error. Kept free of engine
+    // dependencies so the cook tool can link it alone
+    bool compile(std::string_view source, std::string& bytecode, std::string& error);
+    // path with its .luau extension replaced by bytecodeExtension
+    std::string bytecodePath(std::string_view path);
+}
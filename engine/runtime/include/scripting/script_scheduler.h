@@ -0,0 +1,76 @@
+#pragma once
+
+#include "scripting/script_system.h"
+#include "jobs/job_system.h"
+#include <memory>
+
+namespace runa::runtime::scripting
+{
+    // Spreads scripts over one Luau VM per worker and updates the VMs as jobs. While scripts run the
+    // world is read only, every VM records its transform writes and messages. They are applied on the
+    // calling thread after the VMs finish, ordered by script id, so the result does not depend on the
+    // number of VMs or on which worker ran what.
+    // Scripts of the same entity share a VM. A script reads the world as it was before the update
+    // started, its own writes show up next update, like the messages it sends
+    class ScriptScheduler
+    {
+    public:
+        ScriptScheduler() = default;
+        ~ScriptScheduler();
+
+        // world and jobs must outlive the scheduler. vmCount 0 uses one VM per worker, without jobs
+        // the VMs update one after the other on the calling thread
+        bool init(ecs::World* world, jobs::JobSystem* jobs, uint32_t vmCount = 0);
+        void deinit();
+
+        ScriptId load(const char* path, ecs::Entity entity = {});
+        ScriptId loadBytecode(const char* name, const std::string& bytecode, ecs::Entity entity = {});
+        void unload(ScriptId id);
+
+        void update(double delta);
+
+        bool isInitialized() const { return !vms.empty(); }
+        uint32_t getVmCount() const { return (uint32_t)vms.size(); }
+        // Summed over the VMs, updateNS is the wall time of the whole update
+        ScriptStats getStats() const;
+
+        ScriptScheduler(const ScriptScheduler&) = delete;
+        ScriptScheduler& operator=(const ScriptScheduler&) = delete;
+    private:
+        // VM of an entity's scripts
+        struct Route
+        {
+            uint32_t vm = 0;
+            uint32_t scripts = 0;
+        };
+
+        // A write or message of one VM, sorted by script before it is applied
+        struct Pending
+        {
+            ScriptId script = noScript;
+            uint32_t vm = 0;
+            uint32_t index = 0;
+        };
+
+        ecs::World* world = nullptr;
+        jobs::JobSystem* jobs = nullptr;
+        std::vector<std::unique_ptr<ScriptSystem>> vms;
+        std::vector<uint32_t> loads;
+        // Script to VM and entity, to unload it
+        std::unordered_map<ScriptId, std::pair<uint32_t, ecs::Entity>> owners;
+        std::unordered_map<uint64_t, Route> routes;
+        std::vector<Pending> pending;
+        ScriptId nextScript = 1;
+        uint64_t updateNS = 0;
+        uint64_t applyNS = 0;
+        uint64_t writes = 0;
+        uint64_t messages = 0;
+
+        // VM the entity's scripts are on, the least loaded one for a new entity
+        uint32_t pick(ecs::Entity entity);
+        ScriptId added(ScriptId id, uint32_t vm, ecs::Entity entity);
+        void applyWrites();
+        void routeMessages();
+        void sortPending();
+    };
+}
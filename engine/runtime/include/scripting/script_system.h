@@ -0,0 +1,190 @@
+#pragma once
+
+#include "ecs/world.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+
+namespace runa::runtime::scripting
+{
+    using ScriptId = uint32_t;
+    constexpr ScriptId noScript = 0;
+
+    struct ScriptStats
+    {
+        size_t scripts = 0;
+        size_t timers = 0;
+        // Heap owned by the VM
+        size_t memoryBytes = 0;
+        uint64_t updateNS = 0;
+        uint64_t errors = 0;
+        // Filled by ScriptScheduler, what its last update recorded and applied
+        uint32_t vms = 1;
+        uint64_t writes = 0;
+        uint64_t messages = 0;
+        uint64_t applyNS = 0;
+    };
+
+    enum EScriptWrite : uint8_t {
+        writePosition = 0,
+        writeTranslate = 1,
+        writeRotation = 2,
+        writeScale = 3,
+        // TransformView setters, the buffer is copied into the payload
+        writePositions = 4,
+        writeRotations = 5,
+        writeScales = 6
+    };
+
+    // Transform write recorded while the world is read only, see ScriptSystem::init
+    struct ScriptWrite
+    {
+        ScriptId script = noScript;
+        EScriptWrite op = writePosition;
+        ecs::Entity entity;
+        // x, y, z, w of single writes
+        float value[4] = {};
+        // Bytes of the payload holding a view's buffer
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    // Message names interned for the whole process, every VM gets the same id for a name so messages
+    // cross VMs as plain values. Names are never released, scripts send a small fixed set of them
+    using MessageName = uint32_t;
+
+    class MessageRegistry
+    {
+    public:
+        // Allocates the first time a name is seen only, safe from any thread
+        static MessageName id(std::string_view name);
+        // Stays valid for the life of the process, empty for an unknown id
+        static std::string_view name(MessageName id);
+    };
+
+    // Sent with message.send, delivered to onMessage(from, name, value) of the scripts on the target
+    // entity at the start of the next update
+    struct ScriptMessage
+    {
+        ScriptId sender = noScript;
+        ecs::Entity from;
+        ecs::Entity to;
+        MessageName name = 0;
+        // LUA_TNIL, LUA_TBOOLEAN, LUA_TNUMBER or LUA_TVECTOR
+        int type = 0;
+        double number = 0.0;
+        float vector[3] = {};
+    };
+
+    // Runs gameplay scripts on one Luau VM. Every script gets a sandboxed thread, globals it defines stay
+    // private and the engine libraries (transform, input, timer, message) are read only. A script may define
+    // update(delta), called by update together with the timers it started.
+    // Scripts load the bytecode cooked next to their source. Builds with ENGINE_SCRIPT_COMPILER
+    // compile the source when there is no bytecode, shipping builds never run the compiler.
+    // Messages a script sends reach the scripts of the target entity on the next update
+    class ScriptSystem
+    {
+    public:
+        ScriptSystem() = default;
+        ~ScriptSystem();
+
+        // world is what the transform library reads and writes, it must outlive the system.
+        // With deferWrites scripts only read the world, writes and messages wait in getWrites and
+        // getOutbox for the owner to apply them, so several systems can update at once
+        bool init(ecs::World* world, bool deferWrites = false);
+        void deinit();
+
+        // path of the .luau source, entity is the script's global of the same name. id is picked by the
+        // caller when several systems share one numbering, noScript takes the next free one
+        ScriptId load(const char* path, ecs::Entity entity = {}, ScriptId id = noScript);
+        // Bytecode from scripting::compile or a cooked file, name is used in errors
+        ScriptId loadBytecode(const char* name, const std::string& bytecode, ecs::Entity entity = {}, ScriptId id = noScript);
+        // Cancels the timers the script started
+        void unload(ScriptId id);
+
+        // Delivers messages, advances the script clock, fires due timers, then calls every update(delta)
+        void update(double delta);
+
+        // Deferred systems only, the owner moves messages between systems and clears what it applied
+        const std::vector<ScriptWrite>& getWrites() const { return writes; }
+        const std::byte* getPayload() const { return payload.data(); }
+        const std::vector<ScriptMessage>& getOutbox() const { return outbox; }
+        void post(const ScriptMessage& message) { inbox.push_back(message); }
+        void clearDeferred();
+
+        // Used by the bindings
+        lua_State* getState() const { return state; }
+        ecs::World* getWorld() const { return world; }
+        double getTime() const { return time; }
+        // callback is a lua_ref the timer owns, it runs on thread. interval 0 fires once
+        uint32_t addTimer(lua_State* thread, double delay, double interval, int callback);
+        void cancelTimer(uint32_t id);
+        bool isDeferred() const { return deferred; }
+        // Recorded for the running script, value holds four floats
+        void deferWrite(EScriptWrite op, ecs::Entity entity, const float* value);
+        void deferWrite(EScriptWrite op, const void* data, size_t size);
+        // Sender and from are the running script
+        void send(ScriptMessage&& message);
+
+        bool isInitialized() const { return state != nullptr; }
+        ScriptStats getStats() const;
+
+        ScriptSystem(const ScriptSystem&) = delete;
+        ScriptSystem& operator=(const ScriptSystem&) = delete;
+    private:
+        struct Script
+        {
+            ScriptId id = noScript;
+            std::string name;
+            ecs::Entity entity;
+            lua_State* thread = nullptr;
+            // Keep the thread and its functions alive
+            int threadRef = -1;
+            int updateRef = -1;
+            int messageRef = -1;
+        };
+
+        struct Timer
+        {
+            uint32_t id = 0;
+            ScriptId script = noScript;
+            lua_State* thread = nullptr;
+            double due = 0.0;
+            double interval = 0.0;
+            int callback = -1;
+        };
+
+        lua_State* state = nullptr;
+        ecs::World* world = nullptr;
+        // Sorted by id
+        std::vector<Script> scripts;
+        std::vector<Timer> timers;
+        // Scripts defining onMessage by packed entity
+        std::unordered_map<uint64_t, std::vector<ScriptId>> receivers;
+        std::vector<ScriptMessage> outbox;
+        std::vector<ScriptMessage> inbox;
+        std::vector<ScriptWrite> writes;
+        std::vector<std::byte> payload;
+        bool deferred = false;
+        // Script whose code is running, what writes, messages and timers belong to
+        ScriptId current = noScript;
+        ScriptId nextScript = 1;
+        uint32_t nextTimer = 1;
+        double time = 0.0;
+        uint64_t updateNS = 0;
+        uint64_t errors = 0;
+
+        bool readBytecode(const char* path, std::string& bytecode);
+        Script* find(ScriptId id);
+        void deliverMessages();
+        void runTimers();
+        // lua_pcall that logs and pops the error
+        bool call(lua_State* thread, int args, const std::string& name);
+        void release(Script& script);
+    };
+}
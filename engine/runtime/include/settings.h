@@ -18,12 +18,20 @@ namespace runa::runtime {
     public:
         GameUserSettings() = default;
 
+        // Applied by the render loop on the thread owning the context, at the start of the next frame
         void setVsync(EVSync value);
-        EVSync getVsync();
+        // Cached, never queries the driver
+        EVSync getVsync() const;
+        // Render side, true once after each setVsync
+        bool takeVsyncChange(EVSync& value);
+        // What the context actually ended up with
+        void resetVsync(EVSync value);
         
         void setFramerateLimit(uint16_t value);
         uint16_t getFramerateLimit() const;
     private:
         uint16_t framerateLimit = 0;
+        EVSync vsync = disable;
+        bool vsyncChanged = false;
     };
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <functional>
 
 namespace runa::runtime
 {
@@ -15,8 +16,47 @@ namespace runa::runtime
         uint64_t deltaNS();
         double delta();
 
+        // 0 disables fixed updates, update() then only calls onUpdate
+        void setFixedRate(uint32_t hz);
+        uint32_t getFixedRate() const { return fixedRate; }
+        // Most fixed updates run in one frame, time beyond that is dropped instead of
+        // making the next frame even longer
+        void setMaxSteps(uint32_t steps) { maxSteps = steps > 0 ? steps : 1; }
+        // Every frame advances by this instead of the wall time it took, so input replays run
+        // the same fixed updates on every machine. 0 goes back to wall time
+        void setFrameDeltaNS(uint64_t ns) { frameDeltaNS = ns; }
+        uint64_t getFrameDeltaNS() const { return frameDeltaNS; }
+
+        // Runs the fixed updates owed since the last call, then onUpdate with the interpolation alpha
+        void update();
+        // Runs steps fixed updates back to back without waiting for wall time,
+        // headless simulations use it to run as fast as the CPU allows
+        void simulate(uint64_t steps);
+
+        double fixedDelta() const { return double(fixedStepNS) / 1000000000.0; }
+        uint64_t fixedDeltaNS() const { return fixedStepNS; }
+        // How far between the last and the next fixed update this frame is, in [0, 1)
+        double alpha() const { return interpolation; }
+        uint64_t getStep() const { return steps; }
+        uint64_t getDroppedNS() const { return droppedNS; }
+
+        // Receives the fixed delta in seconds
+        std::function<void(double)> onFixedUpdate;
+        // Receives the frame delta in seconds and the interpolation alpha
+        std::function<void(double, double)> onUpdate;
+
     private:
         uint64_t currentTickNS = 0;
         uint64_t deltaTimeNS = 0;
+
+        uint32_t fixedRate = 60;
+        uint64_t fixedStepNS = 1000000000 / 60;
+        uint32_t maxSteps = 8;
+        uint64_t accumulatorNS = 0;
+        uint64_t lastUpdateNS = 0;
+        uint64_t steps = 0;
+        uint64_t droppedNS = 0;
+        uint64_t frameDeltaNS = 0;
+        double interpolation = 0.0;
     };
 }
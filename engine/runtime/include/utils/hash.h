@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace runa::runtime::utils
+{
+    // FNV-1a 64 bits, stable across runs so it can key caches by path or name
+    constexpr uint64_t hash(std::string_view str)
+    {
+        uint64_t value = 14695981039346656037ull;
+        for (char c : str)
+        {
+            value ^= (uint8_t)c;
+            value *= 1099511628211ull;
+        }
+        return value;
+    }
+
+    constexpr uint64_t hashCombine(uint64_t seed, uint64_t value)
+    {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "config.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace runa::runtime::utils
+{
+    // Names are not copied, zones must use string literals or other static strings
+    struct ProfileEvent
+    {
+        const char* name = nullptr;
+        uint64_t startNS = 0;
+        uint64_t endNS = 0;
+        uint32_t depth = 0;
+    };
+
+    struct ProfileTrack
+    {
+        uint32_t id = 0;
+        std::string name;
+        std::vector<ProfileEvent> events;
+    };
+
+    // Scoped CPU zones written to per-thread ring buffers, plus a GPU track fed by opengl::GpuProfiler.
+    // Disabled it costs one relaxed load per zone, and nothing at all without ENGINE_PROFILER.
+    // A zone has to end on the thread it began on, so it must not span a fiber job waiting.
+    class Profiler
+    {
+    public:
+        static constexpr uint32_t eventsPerThread = 16384;
+        static constexpr uint32_t maxDepth = 64;
+        static constexpr uint32_t frameHistory = 256;
+
+        Profiler() = default;
+        ~Profiler();
+
+        void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+        bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+        // Shown instead of the thread id in the timeline and in traces
+        void setThreadName(const char* name);
+
+        void begin(const char* name);
+        void end();
+        // Zone measured elsewhere, on the GPU track
+        void recordGpu(const char* name, uint64_t startNS, uint64_t endNS, uint32_t depth);
+
+        // Marks the start of a frame
+        void frame();
+        // Span of the last count completed frames, false before the first one completed
+        bool lastFrames(uint32_t count, uint64_t& startNS, uint64_t& endNS) const;
+
+        // Events overlapping [fromNS, toNS] on every track, vectors in tracks are reused
+        void collect(uint64_t fromNS, uint64_t toNS, std::vector<ProfileTrack>& tracks);
+        // Everything still in the ring buffers as Chrome trace JSON (chrome://tracing, Perfetto)
+        bool exportChromeTrace(const char* path);
+
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+    private:
+        struct Slot
+        {
+            std::atomic<const char*> name = nullptr;
+            std::atomic<uint64_t> startNS = 0;
+            std::atomic<uint64_t> endNS = 0;
+            std::atomic<uint32_t> depth = 0;
+        };
+
+        struct OpenZone
+        {
+            const char* name;
+            uint64_t startNS;
+        };
+
+        struct ThreadBuffer
+        {
+            uint32_t id = 0;
+            std::string name;
+            Slot slots[eventsPerThread];
+            // Written by the owning thread only, readers skip slots that may be overwritten
+            std::atomic<uint64_t> head = 0;
+            OpenZone open[maxDepth];
+            uint32_t depth = 0;
+        };
+
+        std::atomic<bool> enabled = false;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> threads;
+        ThreadBuffer* gpu = nullptr;
+
+        std::atomic<uint64_t> frames[frameHistory] = {};
+        std::atomic<uint64_t> frameCount = 0;
+
+        ThreadBuffer* threadBuffer();
+        ThreadBuffer* createBuffer(const char* name);
+        static void write(ThreadBuffer& buffer, const char* name, uint64_t startNS, uint64_t endNS, uint32_t depth);
+        static void read(const ThreadBuffer& buffer, uint64_t fromNS, uint64_t toNS, std::vector<ProfileEvent>& out);
+    };
+
+    class ProfileZone
+    {
+    public:
+        explicit ProfileZone(const char* name);
+        ~ProfileZone();
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+    private:
+        bool active;
+    };
+}
+
+namespace runa::runtime
+{
+    extern utils::Profiler profiler;
+}
+
+namespace runa::runtime::utils
+{
+    inline ProfileZone::ProfileZone(const char* name) : active(profiler.isEnabled())
+    {
+        if (active) profiler.begin(name);
+    }
+
+    inline ProfileZone::~ProfileZone()
+    {
+        if (active) profiler.end();
+    }
+}
+
+#define RUNA_PROFILE_CONCAT_INNER(a, b) a##b
+#define RUNA_PROFILE_CONCAT(a, b) RUNA_PROFILE_CONCAT_INNER(a, b)
+
+#if defined(ENGINE_PROFILER)
+#define RUNA_PROFILE_ZONE(name) ::runa::runtime::utils::ProfileZone RUNA_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define RUNA_PROFILE_FUNCTION() RUNA_PROFILE_ZONE(__func__)
+#else
+#define RUNA_PROFILE_ZONE(name)
+#define RUNA_PROFILE_FUNCTION()
+#endif
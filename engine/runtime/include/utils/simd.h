@@ -0,0 +1,10 @@
+#pragma once
+
+// RUNA_SSE or RUNA_NEON when the target has 4 wide float vectors, code falls back to glm otherwise
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define RUNA_SSE 1
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#define RUNA_NEON 1
+#include <arm_neon.h>
+#endif
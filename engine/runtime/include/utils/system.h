@@ -20,6 +20,10 @@ namespace runa::runtime::utils
 
     void nativeSeparator(std::string& path);
 
+    // Absolute, without . and .. and with native separators, so two spellings of a file compare equal.
+    // The part of the path that does not exist is kept as written
+    std::string normalizePath(const char* path);
+
     std::string getHomeDir();
 
     std::string getPrefPath(const std::string &org, const std::string &app);
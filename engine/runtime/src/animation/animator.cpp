@@ -0,0 +1,170 @@
+#include "animation/animator.h"
+#include "utils/profiler.h"
+#include <SDL3/SDL_timer.h>
+#include <algorithm>
+#include <cmath>
+
+namespace runa::runtime::animation
+{
+    void Animator::init(const Skeleton* initSkeleton, const SkinnedVertices* initVertices)
+    {
+        skeleton = initSkeleton;
+        vertices = initVertices;
+        current = {};
+        previous = {};
+        fadeDuration = 0.0f;
+
+        // Sized once, updates only write into them
+        uint32_t joints = skeleton ? skeleton->size() : 0;
+        pose.resize(joints);
+        previousPose.resize(joints);
+        models.assign(joints, glm::mat4(1.0f));
+        palette.assign(joints, glm::mat4(1.0f));
+        // Bind pose until the first update
+        if (vertices) positions.assign(vertices->positions.begin(), vertices->positions.end());
+        else positions.clear();
+        if (vertices && vertices->normals.size() >= vertices->size()) normals.assign(vertices->normals.begin(), vertices->normals.begin() + vertices->size());
+        else normals.clear();
+    }
+
+    void Animator::play(const AnimationClip* clip, float speed, bool loop)
+    {
+        start(current, clip, speed, loop);
+        previous.clip = nullptr;
+        fadeDuration = 0.0f;
+    }
+
+    void Animator::crossFade(const AnimationClip* clip, float seconds, float speed, bool loop)
+    {
+        if (!current.clip || seconds <= 0.0f)
+        {
+            play(clip, speed, loop);
+            return;
+        }
+        // Swapping keeps both cursor buffers around
+        std::swap(previous, current);
+        start(current, clip, speed, loop);
+        fade = 0.0f;
+        fadeDuration = seconds;
+    }
+
+    void Animator::update(float delta, AnimationStats& stats)
+    {
+        if (!skeleton) return;
+
+        uint64_t start = SDL_GetTicksNS();
+        bool fading = fadeDuration > 0.0f && previous.clip;
+        advance(current, delta);
+        sample(current, pose);
+        if (fading)
+        {
+            advance(previous, delta);
+            sample(previous, previousPose);
+        }
+        uint64_t sampled = SDL_GetTicksNS();
+        stats.sampleNS += sampled - start;
+
+        if (fading)
+        {
+            fade += delta;
+            float weight = std::min(fade / fadeDuration, 1.0f);
+            blend(previousPose, pose, weight, pose);
+            if (weight >= 1.0f)
+            {
+                fadeDuration = 0.0f;
+                previous.clip = nullptr;
+            }
+        }
+        uint64_t blended = SDL_GetTicksNS();
+        stats.blendNS += blended - sampled;
+
+        computePalette(*skeleton, pose, models.data(), palette.data());
+        uint64_t computed = SDL_GetTicksNS();
+        stats.paletteNS += computed - blended;
+
+        if (vertices && !positions.empty())
+        {
+            skin(*vertices, palette.data(), 0, vertices->size(), positions.data(), normals.empty() ? nullptr : normals.data());
+            stats.skinNS += SDL_GetTicksNS() - computed;
+            stats.vertices += vertices->size();
+        }
+        stats.animators++;
+    }
+
+    void Animator::start(Layer& layer, const AnimationClip* clip, float speed, bool loop)
+    {
+        layer.clip = clip;
+        layer.time = 0.0f;
+        layer.speed = speed;
+        layer.loop = loop;
+        layer.cursors.assign(clip ? clip->getTrackCount() : 0, 0);
+    }
+
+    void Animator::advance(Layer& layer, float delta)
+    {
+        if (!layer.clip) return;
+
+        float duration = layer.clip->getDuration();
+        layer.time += delta * layer.speed;
+        if (layer.loop && duration > 0.0f)
+        {
+            layer.time = std::fmod(layer.time, duration);
+            if (layer.time < 0.0f) layer.time += duration;
+        }
+        else
+        {
+            layer.time = std::clamp(layer.time, 0.0f, duration);
+        }
+    }
+
+    void Animator::sample(Layer& layer, Pose& target)
+    {
+        // Joints without tracks stay in the bind pose, copying reuses the storage
+        target.translations = skeleton->bindPose.translations;
+        target.rotations = skeleton->bindPose.rotations;
+        target.scales = skeleton->bindPose.scales;
+        if (layer.clip) layer.clip->sample(layer.time, target, layer.cursors.data());
+    }
+
+    void AnimationSystem::add(Animator* animator)
+    {
+        if (std::find(animators.begin(), animators.end(), animator) == animators.end()) animators.push_back(animator);
+    }
+
+    void AnimationSystem::remove(Animator* animator)
+    {
+        animators.erase(std::remove(animators.begin(), animators.end(), animator), animators.end());
+    }
+
+    void AnimationSystem::update(float delta, jobs::JobSystem* jobs)
+    {
+        RUNA_PROFILE_ZONE("AnimationSystem::update");
+        uint64_t start = SDL_GetTicksNS();
+        std::atomic<uint64_t> sampleNS = 0, blendNS = 0, paletteNS = 0, skinNS = 0, vertices = 0;
+        std::atomic<uint32_t> updated = 0;
+
+        auto animate = [&](uint32_t begin, uint32_t end) {
+            // Summed locally, the shared counters are touched once per job
+            AnimationStats local;
+            for (uint32_t i = begin; i < end; i++) animators[i]->update(delta, local);
+            sampleNS.fetch_add(local.sampleNS, std::memory_order_relaxed);
+            blendNS.fetch_add(local.blendNS, std::memory_order_relaxed);
+            paletteNS.fetch_add(local.paletteNS, std::memory_order_relaxed);
+            skinNS.fetch_add(local.skinNS, std::memory_order_relaxed);
+            vertices.fetch_add(local.vertices, std::memory_order_relaxed);
+            updated.fetch_add(local.animators, std::memory_order_relaxed);
+        };
+
+        // Characters are independent, each one is big enough to be a job of its own
+        if (jobs && jobs->isInitialized()) jobs->parallelFor((uint32_t)animators.size(), animate, 1);
+        else animate(0, (uint32_t)animators.size());
+
+        stats.sampleNS = sampleNS.load(std::memory_order_relaxed);
+        stats.blendNS = blendNS.load(std::memory_order_relaxed);
+        stats.paletteNS = paletteNS.load(std::memory_order_relaxed);
+        stats.skinNS = skinNS.load(std::memory_order_relaxed);
+        stats.vertices = vertices.load(std::memory_order_relaxed);
+        stats.animators = updated.load(std::memory_order_relaxed);
+        stats.updateNS = SDL_GetTicksNS() - start;
+    }
+}
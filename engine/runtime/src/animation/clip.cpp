@@ -0,0 +1,140 @@
+#include "animation/clip.h"
+#include <algorithm>
+#include <cmath>
+
+namespace runa::runtime::animation
+{
+    namespace
+    {
+        constexpr float vectorSteps = 65535.0f;
+        constexpr float rotationSteps = 32767.0f;
+
+        // Last key at or before time, starting from where the previous sample stopped
+        uint32_t findKey(const float* times, uint32_t count, float time, uint32_t& cursor)
+        {
+            // Looped or jumped back, searching from the start is cheaper than guessing
+            if (cursor >= count || times[cursor] > time) cursor = 0;
+            while (cursor + 1 < count && times[cursor + 1] <= time) cursor++;
+            return cursor;
+        }
+    }
+
+    void AnimationClip::addTrack(uint16_t joint, EAnimationPath path, const float* keyTimes, const float* values, uint32_t count, bool step)
+    {
+        if (count == 0) return;
+
+        AnimationTrack track;
+        track.joint = joint;
+        track.path = path;
+        track.step = step;
+        track.keyCount = count;
+        track.firstTime = (uint32_t)times.size();
+        times.insert(times.end(), keyTimes, keyTimes + count);
+        duration = std::max(duration, keyTimes[count - 1]);
+
+        if (path == rotationPath)
+        {
+            track.firstValue = (uint32_t)(rotations.size() / 4);
+            float previous[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            for (uint32_t key = 0; key < count; key++)
+            {
+                // Keeps neighbours in the same hemisphere so blending between them takes the short way
+                const float* value = &values[key * 4];
+                float dot = value[0] * previous[0] + value[1] * previous[1] + value[2] * previous[2] + value[3] * previous[3];
+                float sign = key > 0 && dot < 0.0f ? -1.0f : 1.0f;
+                for (int i = 0; i < 4; i++)
+                {
+                    previous[i] = value[i] * sign;
+                    rotations.push_back((int16_t)std::lround(std::clamp(previous[i], -1.0f, 1.0f) * rotationSteps));
+                }
+            }
+        }
+        else
+        {
+            glm::vec3 low(values[0], values[1], values[2]);
+            glm::vec3 high = low;
+            for (uint32_t key = 1; key < count; key++)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    low[i] = std::min(low[i], values[key * 3 + i]);
+                    high[i] = std::max(high[i], values[key * 3 + i]);
+                }
+            }
+            track.min = low;
+            track.extent = high - low;
+
+            track.firstValue = (uint32_t)(vectors.size() / 3);
+            for (uint32_t key = 0; key < count; key++)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    // Constant components store 0 and decode to min
+                    float fraction = track.extent[i] > 0.0f ? (values[key * 3 + i] - low[i]) / track.extent[i] : 0.0f;
+                    vectors.push_back((uint16_t)std::lround(std::clamp(fraction, 0.0f, 1.0f) * vectorSteps));
+                }
+            }
+        }
+        tracks.push_back(track);
+    }
+
+    void AnimationClip::clear()
+    {
+        tracks.clear();
+        times.clear();
+        vectors.clear();
+        rotations.clear();
+        duration = 0.0f;
+    }
+
+    void AnimationClip::sample(float time, Pose& pose, uint32_t* cursors) const
+    {
+        for (size_t i = 0; i < tracks.size(); i++)
+        {
+            const AnimationTrack& track = tracks[i];
+            if (track.joint >= pose.size()) continue;
+
+            const float* keys = &times[track.firstTime];
+            uint32_t key = findKey(keys, track.keyCount, time, cursors[i]);
+            uint32_t next = key + 1 < track.keyCount ? key + 1 : key;
+            // Before the first key or past the last one the curve holds its end value
+            float weight = 0.0f;
+            if (!track.step && next != key && time > keys[key])
+            {
+                weight = std::clamp((time - keys[key]) / (keys[next] - keys[key]), 0.0f, 1.0f);
+            }
+
+            switch (track.path)
+            {
+            case translationPath:
+                pose.translations[track.joint] = glm::mix(decodeVector(track, key), decodeVector(track, next), weight);
+                break;
+            case rotationPath:
+                // Keys share a hemisphere, nlerp is close enough to slerp between neighbours
+                pose.rotations[track.joint] = glm::normalize(decodeRotation(track, key) * (1.0f - weight) + decodeRotation(track, next) * weight);
+                break;
+            case scalePath:
+                pose.scales[track.joint] = glm::mix(decodeVector(track, key), decodeVector(track, next), weight);
+                break;
+            }
+        }
+    }
+
+    size_t AnimationClip::getBytes() const
+    {
+        return times.size() * sizeof(float) + vectors.size() * sizeof(uint16_t) + rotations.size() * sizeof(int16_t)
+            + tracks.size() * sizeof(AnimationTrack);
+    }
+
+    glm::vec3 AnimationClip::decodeVector(const AnimationTrack& track, uint32_t key) const
+    {
+        const uint16_t* value = &vectors[(size_t)(track.firstValue + key) * 3];
+        return track.min + track.extent * glm::vec3(value[0] / vectorSteps, value[1] / vectorSteps, value[2] / vectorSteps);
+    }
+
+    glm::quat AnimationClip::decodeRotation(const AnimationTrack& track, uint32_t key) const
+    {
+        const int16_t* value = &rotations[(size_t)(track.firstValue + key) * 4];
+        return glm::quat(value[3] / rotationSteps, value[0] / rotationSteps, value[1] / rotationSteps, value[2] / rotationSteps);
+    }
+}
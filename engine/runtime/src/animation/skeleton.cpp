@@ -0,0 +1,161 @@
+#include "animation/skeleton.h"
+#include "ecs/transforms.h"
+#include "utils/logs.h"
+#include "utils/simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace runa::runtime::animation
+{
+    namespace
+    {
+        glm::quat nlerp(const glm::quat& a, const glm::quat& b, float weight)
+        {
+            // Opposite quaternions are the same rotation, flipping b avoids going the long way around
+            float sign = glm::dot(a, b) < 0.0f ? -1.0f : 1.0f;
+            return glm::normalize(a * (1.0f - weight) + b * (weight * sign));
+        }
+
+        glm::vec3 normalized(float x, float y, float z)
+        {
+            float length = std::sqrt(x * x + y * y + z * z);
+            return length > 0.0f ? glm::vec3(x / length, y / length, z / length) : glm::vec3(x, y, z);
+        }
+    }
+
+    void Pose::resize(uint32_t joints)
+    {
+        translations.resize(joints, glm::vec3(0.0f));
+        rotations.resize(joints, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        scales.resize(joints, glm::vec3(1.0f));
+    }
+
+    bool Skeleton::finalize()
+    {
+        uint32_t count = size();
+        if (count > UINT16_MAX)
+        {
+            utils::Logs::error("Skeleton has %u joints, at most %u are supported", count, (uint32_t)UINT16_MAX);
+            return false;
+        }
+        inverseBinds.resize(count, glm::mat4(1.0f));
+        bases.resize(count, glm::mat4(1.0f));
+        bindPose.resize(count);
+
+        std::vector<uint32_t> depths(count, 0);
+        for (uint32_t joint = 0; joint < count; joint++)
+        {
+            // Longer than the joint count means the parents loop
+            int32_t parent = parents[joint];
+            while (parent != noParent)
+            {
+                if (parent < 0 || (uint32_t)parent >= count || ++depths[joint] > count)
+                {
+                    utils::Logs::error("Joint %u has an invalid parent chain", joint);
+                    order.clear();
+                    return false;
+                }
+                parent = parents[parent];
+            }
+        }
+
+        order.resize(count);
+        for (uint32_t joint = 0; joint < count; joint++) order[joint] = (uint16_t)joint;
+        std::stable_sort(order.begin(), order.end(), [&depths](uint16_t a, uint16_t b) { return depths[a] < depths[b]; });
+        return true;
+    }
+
+    void blend(const Pose& a, const Pose& b, float weight, Pose& out)
+    {
+        uint32_t count = std::min(a.size(), b.size());
+        out.resize(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            out.translations[i] = glm::mix(a.translations[i], b.translations[i], weight);
+            out.rotations[i] = nlerp(a.rotations[i], b.rotations[i], weight);
+            out.scales[i] = glm::mix(a.scales[i], b.scales[i], weight);
+        }
+    }
+
+    void computePalette(const Skeleton& skeleton, const Pose& pose, glm::mat4* models, glm::mat4* palette)
+    {
+        for (uint16_t joint : skeleton.order)
+        {
+            ecs::Transform local{ pose.translations[joint], pose.rotations[joint], pose.scales[joint] };
+            int32_t parent = skeleton.parents[joint];
+            const glm::mat4& above = parent == noParent ? skeleton.bases[joint] : models[parent];
+            models[joint] = ecs::multiply(above, ecs::compose(local));
+            palette[joint] = ecs::multiply(models[joint], skeleton.inverseBinds[joint]);
+        }
+    }
+
+    void skin(const SkinnedVertices& vertices, const glm::mat4* palette, uint32_t begin, uint32_t end,
+        glm::vec3* positions, glm::vec3* normals)
+    {
+        bool hasNormals = normals && vertices.normals.size() >= end;
+        for (uint32_t vertex = begin; vertex < end; vertex++)
+        {
+            const uint16_t* joints = &vertices.joints[(size_t)vertex * 4];
+            const glm::vec4& weights = vertices.weights[vertex];
+            const glm::vec3& position = vertices.positions[vertex];
+            // Blends the four matrices column by column, then moves the vertex with the result
+#if defined(RUNA_SSE)
+            __m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps(), c2 = _mm_setzero_ps(), c3 = _mm_setzero_ps();
+            for (int i = 0; i < 4; i++)
+            {
+                if (weights[i] == 0.0f) continue;
+                const glm::mat4& matrix = palette[joints[i]];
+                __m128 weight = _mm_set1_ps(weights[i]);
+                c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(&matrix[0][0]), weight));
+                c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(&matrix[1][0]), weight));
+                c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(&matrix[2][0]), weight));
+                c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(&matrix[3][0]), weight));
+            }
+            float out[4];
+            __m128 moved = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(position.x)), _mm_mul_ps(c1, _mm_set1_ps(position.y))),
+                _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(position.z)), c3));
+            _mm_storeu_ps(out, moved);
+            positions[vertex] = glm::vec3(out[0], out[1], out[2]);
+            if (hasNormals)
+            {
+                const glm::vec3& normal = vertices.normals[vertex];
+                __m128 turned = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(normal.x)), _mm_mul_ps(c1, _mm_set1_ps(normal.y))),
+                    _mm_mul_ps(c2, _mm_set1_ps(normal.z)));
+                _mm_storeu_ps(out, turned);
+                normals[vertex] = normalized(out[0], out[1], out[2]);
+            }
+#elif defined(RUNA_NEON)
+            float32x4_t c0 = vdupq_n_f32(0.0f), c1 = vdupq_n_f32(0.0f), c2 = vdupq_n_f32(0.0f), c3 = vdupq_n_f32(0.0f);
+            for (int i = 0; i < 4; i++)
+            {
+                if (weights[i] == 0.0f) continue;
+                const glm::mat4& matrix = palette[joints[i]];
+                c0 = vmlaq_n_f32(c0, vld1q_f32(&matrix[0][0]), weights[i]);
+                c1 = vmlaq_n_f32(c1, vld1q_f32(&matrix[1][0]), weights[i]);
+                c2 = vmlaq_n_f32(c2, vld1q_f32(&matrix[2][0]), weights[i]);
+                c3 = vmlaq_n_f32(c3, vld1q_f32(&matrix[3][0]), weights[i]);
+            }
+            float out[4];
+            float32x4_t moved = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(c3, c0, position.x), c1, position.y), c2, position.z);
+            vst1q_f32(out, moved);
+            positions[vertex] = glm::vec3(out[0], out[1], out[2]);
+            if (hasNormals)
+            {
+                const glm::vec3& normal = vertices.normals[vertex];
+                float32x4_t turned = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(c0, normal.x), c1, normal.y), c2, normal.z);
+                vst1q_f32(out, turned);
+                normals[vertex] = normalized(out[0], out[1], out[2]);
+            }
+#else
+            glm::mat4 matrix = palette[joints[0]] * weights[0] + palette[joints[1]] * weights[1]
+                + palette[joints[2]] * weights[2] + palette[joints[3]] * weights[3];
+            positions[vertex] = glm::vec3(matrix * glm::vec4(position, 1.0f));
+            if (hasNormals)
+            {
+                glm::vec4 turned = matrix * glm::vec4(vertices.normals[vertex], 0.0f);
+                normals[vertex] = normalized(turned.x, turned.y, turned.z);
+            }
+#endif
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#include "ecs/hierarchy.h"
+#include "utils/logs.h"
+#include "utils/profiler.h"
+#include <algorithm>
+
+namespace runa::runtime::ecs
+{
+    TransformNode TransformHierarchy::add(TransformNode parent, const glm::mat4& local)
+    {
+        TransformNode node = size();
+        // Only a subtree ending at the back can grow without moving nodes
+        if (parent != noNode && (parent >= node || subtreeEnds[parent] != node))
+        {
+            utils::Logs::error("Transform node %u added out of depth first order", parent);
+            return noNode;
+        }
+
+        parents.push_back(parent);
+        subtreeEnds.push_back(node + 1);
+        locals.push_back(local);
+        worlds.push_back(local);
+        dirty.push_back(1);
+        dirtyRoots.push_back(node);
+        for (TransformNode ancestor = parent; ancestor != noNode; ancestor = parents[ancestor]) subtreeEnds[ancestor] = node + 1;
+        return node;
+    }
+
+    void TransformHierarchy::setLocal(TransformNode node, const glm::mat4& local)
+    {
+        locals[node] = local;
+        if (dirty[node]) return;
+        dirty[node] = 1;
+        dirtyRoots.push_back(node);
+    }
+
+    void TransformHierarchy::clear()
+    {
+        parents.clear();
+        subtreeEnds.clear();
+        locals.clear();
+        worlds.clear();
+        dirty.clear();
+        dirtyRoots.clear();
+    }
+
+    uint32_t TransformHierarchy::update()
+    {
+        if (dirtyRoots.empty()) return 0;
+        RUNA_PROFILE_ZONE("TransformHierarchy::update");
+
+        // In order, a changed node inside a subtree already walked is skipped
+        std::sort(dirtyRoots.begin(), dirtyRoots.end());
+        uint32_t recomposed = 0;
+        TransformNode end = 0;
+        for (TransformNode root : dirtyRoots)
+        {
+            dirty[root] = 0;
+            if (root < end) continue;
+
+            end = subtreeEnds[root];
+            for (TransformNode node = root; node < end; node++)
+            {
+                TransformNode parent = parents[node];
+                worlds[node] = parent == noNode ? locals[node] : multiply(worlds[parent], locals[node]);
+            }
+            recomposed += end - root;
+        }
+        dirtyRoots.clear();
+        return recomposed;
+    }
+}
@@ -0,0 +1,71 @@
+#include "ecs/transforms.h"
+#include "utils/profiler.h"
+#include "utils/simd.h"
+
+namespace runa::runtime::ecs
+{
+    glm::mat4 compose(const Transform& transform)
+    {
+        glm::mat3 rotation = glm::mat3_cast(transform.rotation);
+        return glm::mat4(
+            glm::vec4(rotation[0] * transform.scale.x, 0.0f),
+            glm::vec4(rotation[1] * transform.scale.y, 0.0f),
+            glm::vec4(rotation[2] * transform.scale.z, 0.0f),
+            glm::vec4(transform.position, 1.0f));
+    }
+
+    glm::mat4 multiply(const glm::mat4& a, const glm::mat4& b)
+    {
+        // Every column of the result is the columns of a weighted by one column of b
+        glm::mat4 result;
+#if defined(RUNA_SSE)
+        __m128 a0 = _mm_loadu_ps(&a[0][0]);
+        __m128 a1 = _mm_loadu_ps(&a[1][0]);
+        __m128 a2 = _mm_loadu_ps(&a[2][0]);
+        __m128 a3 = _mm_loadu_ps(&a[3][0]);
+        for (int column = 0; column < 4; column++)
+        {
+            __m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[column][0]));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[column][1])));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[column][2])));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[column][3])));
+            _mm_storeu_ps(&result[column][0], r);
+        }
+#elif defined(RUNA_NEON)
+        float32x4_t a0 = vld1q_f32(&a[0][0]);
+        float32x4_t a1 = vld1q_f32(&a[1][0]);
+        float32x4_t a2 = vld1q_f32(&a[2][0]);
+        float32x4_t a3 = vld1q_f32(&a[3][0]);
+        for (int column = 0; column < 4; column++)
+        {
+            float32x4_t r = vmulq_n_f32(a0, b[column][0]);
+            r = vmlaq_n_f32(r, a1, b[column][1]);
+            r = vmlaq_n_f32(r, a2, b[column][2]);
+            r = vmlaq_n_f32(r, a3, b[column][3]);
+            vst1q_f32(&result[column][0], r);
+        }
+#else
+        result = a * b;
+#endif
+        return result;
+    }
+
+    void TransformSystem::update(World& world, jobs::JobSystem* jobs)
+    {
+        RUNA_PROFILE_ZONE("TransformSystem::update");
+        uint32_t since = lastVersion;
+        // Writes from here on are seen by the next update
+        lastVersion = world.advance();
+        updatedChunks.store(0, std::memory_order_relaxed);
+
+        auto recompose = [this](const Entity*, uint32_t count, const Transform* transforms, LocalToWorld* matrices) {
+            for (uint32_t i = 0; i < count; i++) matrices[i].matrix = compose(transforms[i]);
+            updatedChunks.fetch_add(1, std::memory_order_relaxed);
+        };
+
+        QueryFilter filter;
+        filter.changedSince<Transform>(since);
+        if (jobs && jobs->isInitialized()) world.parallelEachChunk<const Transform, LocalToWorld>(*jobs, recompose, filter);
+        else world.eachChunk<const Transform, LocalToWorld>(recompose, filter);
+    }
+}
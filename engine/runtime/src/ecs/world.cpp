@@ -0,0 +1,292 @@
+#include "ecs/world.h"
+#include "utils/logs.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+namespace runa::runtime::ecs
+{
+    namespace
+    {
+        ComponentInfo componentInfos[maxComponents];
+        std::atomic<uint32_t> componentCount = 0;
+
+        uint32_t alignUp(uint32_t value, uint32_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    const ComponentInfo& ComponentRegistry::info(ComponentId id)
+    {
+        return componentInfos[id];
+    }
+
+    uint32_t ComponentRegistry::count()
+    {
+        return componentCount.load(std::memory_order_acquire);
+    }
+
+    ComponentId ComponentRegistry::add(uint32_t size, uint32_t alignment)
+    {
+        uint32_t id = componentCount.fetch_add(1, std::memory_order_acq_rel);
+        if (id >= maxComponents)
+        {
+            // Masks are 64 bits, there is no way to store the component
+            utils::Logs::error("More than %u component types", maxComponents);
+            std::abort();
+        }
+        componentInfos[id] = { size, alignment };
+        return id;
+    }
+
+    World::World() : chunkPool(chunkBytes, memory::cacheLine, 16)
+    {
+        // Entity index 0 is never handed out, a zeroed Entity stays invalid
+        records.emplace_back();
+    }
+
+    World::~World() = default;
+
+    Entity World::create(ComponentMask mask)
+    {
+        if (!structural("create")) return {};
+        Archetype* archetype = getArchetype(mask);
+        if (!archetype) return {};
+
+        uint32_t index;
+        if (!freeIndices.empty())
+        {
+            index = freeIndices.back();
+            freeIndices.pop_back();
+        }
+        else
+        {
+            index = (uint32_t)records.size();
+            records.emplace_back();
+        }
+
+        EntityRecord& record = records[index];
+        Entity entity{ index, record.generation };
+        record.archetype = archetype;
+        pushRow(*archetype, entity, record.chunk, record.row);
+        alive++;
+        return entity;
+    }
+
+    bool World::destroy(Entity entity)
+    {
+        if (!structural("destroy") || !isAlive(entity)) return false;
+
+        EntityRecord& record = records[entity.index];
+        removeRow(*record.archetype, record.chunk, record.row);
+        record.archetype = nullptr;
+        // Skips 0 on wrap around, it marks invalid handles
+        if (++record.generation == 0) record.generation = 1;
+        freeIndices.push_back(entity.index);
+        alive--;
+        return true;
+    }
+
+    bool World::isAlive(Entity entity) const
+    {
+        return entity.index > 0 && entity.index < records.size()
+            && records[entity.index].generation == entity.generation && records[entity.index].archetype;
+    }
+
+    WorldStats World::getStats() const
+    {
+        WorldStats stats;
+        stats.entities = alive;
+        stats.archetypes = archetypes.size();
+        for (Archetype* archetype : archetypes) stats.chunks += archetype->chunks.size();
+        stats.chunkBytes = stats.chunks * chunkBytes;
+        return stats;
+    }
+
+    Archetype* World::getArchetype(ComponentMask mask)
+    {
+        auto it = archetypeMap.find(mask);
+        if (it != archetypeMap.end()) return it->second.get();
+
+        auto archetype = std::make_unique<Archetype>();
+        archetype->mask = mask;
+        std::fill(std::begin(archetype->columnOf), std::end(archetype->columnOf), Archetype::noColumn);
+        uint32_t rowBytes = sizeof(Entity);
+        for (ComponentId id = 0; id < maxComponents; id++)
+        {
+            if (!((mask >> id) & 1)) continue;
+            archetype->columnOf[id] = (uint8_t)archetype->components.size();
+            archetype->components.push_back(id);
+            archetype->sizes.push_back(ComponentRegistry::info(id).size);
+            rowBytes += ComponentRegistry::info(id).size;
+        }
+
+        // Versions first, then the entity column and one column per component, each on its own cache line
+        uint32_t columns = (uint32_t)archetype->components.size();
+        uint32_t header = alignUp(columns * sizeof(uint32_t), memory::cacheLine);
+        uint32_t padding = (columns + 1) * memory::cacheLine;
+        if (header + padding + rowBytes > chunkBytes)
+        {
+            utils::Logs::error("Archetype with %u components does not fit in a chunk", columns);
+            return nullptr;
+        }
+        archetype->capacity = (chunkBytes - header - padding) / rowBytes;
+
+        uint32_t offset = header;
+        archetype->entityOffset = offset;
+        offset = alignUp(offset + archetype->capacity * (uint32_t)sizeof(Entity), memory::cacheLine);
+        for (uint32_t column = 0; column < columns; column++)
+        {
+            archetype->offsets.push_back(offset);
+            offset = alignUp(offset + archetype->capacity * archetype->sizes[column], memory::cacheLine);
+        }
+
+        Archetype* result = archetype.get();
+        archetypeMap.emplace(mask, std::move(archetype));
+        archetypes.push_back(result);
+        return result;
+    }
+
+    Archetype* World::addTarget(Archetype* archetype, ComponentId id)
+    {
+        if (!archetype->addEdges[id]) archetype->addEdges[id] = getArchetype(archetype->mask | (ComponentMask(1) << id));
+        return archetype->addEdges[id];
+    }
+
+    Archetype* World::removeTarget(Archetype* archetype, ComponentId id)
+    {
+        if (!archetype->removeEdges[id]) archetype->removeEdges[id] = getArchetype(archetype->mask & ~(ComponentMask(1) << id));
+        return archetype->removeEdges[id];
+    }
+
+    void World::pushRow(Archetype& archetype, Entity entity, uint32_t& chunk, uint32_t& row)
+    {
+        if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity)
+        {
+            Chunk added;
+            added.data = static_cast<std::byte*>(chunkPool.allocate());
+            archetype.chunks.push_back(added);
+        }
+
+        chunk = (uint32_t)archetype.chunks.size() - 1;
+        Chunk& target = archetype.chunks[chunk];
+        row = target.count++;
+        archetype.entities(target)[row] = entity;
+        // Whatever gets written to the row is new to every query
+        for (size_t column = 0; column < archetype.components.size(); column++)
+        {
+            target.versions()[column] = version;
+            std::memset(target.data + archetype.offsets[column] + (size_t)row * archetype.sizes[column], 0, archetype.sizes[column]);
+        }
+        archetype.count++;
+    }
+
+    void World::removeRow(Archetype& archetype, uint32_t chunk, uint32_t row)
+    {
+        uint32_t lastChunk = (uint32_t)archetype.chunks.size() - 1;
+        Chunk& last = archetype.chunks[lastChunk];
+        uint32_t lastRow = last.count - 1;
+
+        if (chunk != lastChunk || row != lastRow)
+        {
+            Chunk& hole = archetype.chunks[chunk];
+            Entity moved = archetype.entities(last)[lastRow];
+            archetype.entities(hole)[row] = moved;
+            for (size_t column = 0; column < archetype.components.size(); column++)
+            {
+                uint32_t size = archetype.sizes[column];
+                std::memcpy(hole.data + archetype.offsets[column] + (size_t)row * size,
+                    last.data + archetype.offsets[column] + (size_t)lastRow * size, size);
+                hole.versions()[column] = version;
+            }
+            records[moved.index].chunk = chunk;
+            records[moved.index].row = row;
+        }
+
+        last.count--;
+        archetype.count--;
+        if (last.count == 0)
+        {
+            chunkPool.deallocate(last.data);
+            archetype.chunks.pop_back();
+        }
+    }
+
+    bool World::move(Entity entity, Archetype* target)
+    {
+        if (!structural("change components of") || !target) return false;
+
+        EntityRecord& record = records[entity.index];
+        Archetype& source = *record.archetype;
+        uint32_t chunk, row;
+        pushRow(*target, entity, chunk, row);
+
+        // Shared components keep their value, new ones start zeroed
+        const Chunk& from = source.chunks[record.chunk];
+        const Chunk& to = target->chunks[chunk];
+        for (size_t column = 0; column < target->components.size(); column++)
+        {
+            uint8_t sourceColumn = source.columnOf[target->components[column]];
+            if (sourceColumn == Archetype::noColumn) continue;
+            uint32_t size = target->sizes[column];
+            std::memcpy(to.data + target->offsets[column] + (size_t)row * size,
+                from.data + source.offsets[sourceColumn] + (size_t)record.row * size, size);
+        }
+
+        removeRow(source, record.chunk, record.row);
+        record.archetype = target;
+        record.chunk = chunk;
+        record.row = row;
+        return true;
+    }
+
+    void* World::component(Entity entity, ComponentId id, bool write)
+    {
+        if (!isAlive(entity)) return nullptr;
+
+        const EntityRecord& record = records[entity.index];
+        const Archetype& archetype = *record.archetype;
+        uint8_t column = archetype.columnOf[id];
+        if (column == Archetype::noColumn) return nullptr;
+
+        const Chunk& chunk = archetype.chunks[record.chunk];
+        if (write) chunk.versions()[column] = version;
+        return chunk.data + archetype.offsets[column] + (size_t)record.row * archetype.sizes[column];
+    }
+
+    const std::vector<Archetype*>& World::match(ComponentMask all, ComponentMask without)
+    {
+        CachedQuery* query = nullptr;
+        for (std::unique_ptr<CachedQuery>& cached : queries)
+        {
+            if (cached->all == all && cached->without == without)
+            {
+                query = cached.get();
+                break;
+            }
+        }
+        if (!query)
+        {
+            queries.push_back(std::make_unique<CachedQuery>());
+            query = queries.back().get();
+            query->all = all;
+            query->without = without;
+        }
+
+        for (; query->checked < archetypes.size(); query->checked++)
+        {
+            Archetype* archetype = archetypes[query->checked];
+            if ((archetype->mask & all) == all && (archetype->mask & without) == 0) query->archetypes.push_back(archetype);
+        }
+        return query->archetypes;
+    }
+
+    bool World::structural(const char* operation) const
+    {
+        if (iterating == 0) return true;
+        // Would move rows under the query
+        utils::Logs::error("Can not %s entities while a query is running", operation);
+        return false;
+    }
+}
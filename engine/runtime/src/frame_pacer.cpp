@@ -0,0 +1,122 @@
+#include "frame_pacer.h"
+#include <SDL3/SDL_timer.h>
+#include <SDL3/SDL_atomic.h>
+#include <algorithm>
+
+namespace runa::runtime
+{
+    void FramePacer::setTarget(uint64_t frameNS)
+    {
+        if (frameNS == targetNS) return;
+        targetNS = frameNS;
+        // New cadence, resynchronize on the next frame
+        deadlineNS = 0;
+    }
+
+    void FramePacer::wait()
+    {
+        uint64_t now = SDL_GetTicksNS();
+        if (targetNS == 0)
+        {
+            frameStartNS = now;
+            return;
+        }
+
+        // First frame, or so late that catching up would mean several frames back to back
+        if (deadlineNS == 0 || now > deadlineNS + targetNS)
+        {
+            deadlineNS = now + std::min(predictedCostNS, targetNS);
+        }
+
+        uint64_t cost = std::min(predictedCostNS, targetNS);
+        if (deadlineNS > now + cost)
+        {
+            sleepUntil(deadlineNS - cost);
+            now = SDL_GetTicksNS();
+        }
+        frameStartNS = now;
+    }
+
+    void FramePacer::waitPresent()
+    {
+        workEndNS = SDL_GetTicksNS();
+        if (targetNS > 0 && deadlineNS > workEndNS) sleepUntil(deadlineNS);
+    }
+
+    void FramePacer::endFrame(uint64_t now)
+    {
+        uint64_t end = workEndNS > 0 ? workEndNS : now;
+        workEndNS = 0;
+        uint64_t cost = end > frameStartNS ? end - frameStartNS : 0;
+
+        // Rises at once and decays slowly, a spike is likely to repeat and finishing early is cheap
+        if (cost > predictedCostNS) predictedCostNS = cost;
+        else predictedCostNS -= (predictedCostNS - cost) / 16;
+
+        if (targetNS == 0) return;
+        if (now > deadlineNS + targetNS / 2) missed++;
+        deadlineNS += targetNS;
+    }
+
+    void FramePacer::presented(uint64_t time)
+    {
+        if (time <= lastPresentNS) return;
+        if (lastPresentNS > 0)
+        {
+            intervals[intervalNext] = time - lastPresentNS;
+            intervalNext = (intervalNext + 1) % historySize;
+            intervalCount = std::min(intervalCount + 1, historySize);
+        }
+        lastPresentNS = time;
+    }
+
+    FramePacingStats FramePacer::getStats() const
+    {
+        FramePacingStats stats;
+        stats.targetNS = targetNS;
+        stats.predictedCostNS = predictedCostNS;
+        stats.missed = missed;
+        stats.samples = intervalCount;
+        if (intervalCount == 0) return stats;
+
+        uint64_t sorted[historySize];
+        std::copy(intervals, intervals + intervalCount, sorted);
+        std::sort(sorted, sorted + intervalCount);
+        stats.p50NS = sorted[intervalCount * 50 / 100];
+        stats.p95NS = sorted[intervalCount * 95 / 100];
+        stats.p99NS = sorted[intervalCount * 99 / 100];
+        stats.maxNS = sorted[intervalCount - 1];
+
+        uint64_t reference = targetNS > 0 ? targetNS : stats.p50NS;
+        uint64_t deviation = 0;
+        for (uint32_t i = 0; i < intervalCount; i++)
+        {
+            deviation += sorted[i] > reference ? sorted[i] - reference : reference - sorted[i];
+        }
+        stats.jitterNS = deviation / intervalCount;
+        return stats;
+    }
+
+    void FramePacer::sleepUntil(uint64_t time)
+    {
+        uint64_t now = SDL_GetTicksNS();
+        while (now + spinNS < time)
+        {
+            uint64_t request = time - now - spinNS;
+            SDL_DelayNS(request);
+            uint64_t woke = SDL_GetTicksNS();
+
+            // Keep the spin window a bit above the worst recent oversleep
+            uint64_t oversleep = woke - now > request ? woke - now - request : 0;
+            uint64_t wanted = std::clamp<uint64_t>(oversleep * 2, 200000, 4000000);
+            spinNS = wanted > spinNS ? wanted : spinNS - (spinNS - wanted) / 8;
+            now = woke;
+        }
+
+        while (now < time)
+        {
+            SDL_CPUPauseInstruction();
+            now = SDL_GetTicksNS();
+        }
+    }
+}
@@ -1,59 +1,119 @@
 #include "input.h"
 
 namespace runa::runtime {
+    void Input::beginFrame() {
+        pressed.reset();
+        released.reset();
+        repeated.reset();
+        mousePressed = 0;
+        mouseReleased = 0;
+    }
+
     void Input::updateEvent(SDL_Event &event) {
         if (event.type == SDL_EVENT_KEY_UP || event.type == SDL_EVENT_KEY_DOWN) {
-            scancodes[event.key.scancode] = event.key;
+            SDL_Scancode scancode = event.key.scancode;
+            if (!valid(scancode)) return;
+
+            if (event.key.down) {
+                if (event.key.repeat) repeated.set(scancode);
+                else if (!held[scancode]) pressed.set(scancode);
+                held.set(scancode);
+            } else {
+                if (held[scancode]) released.set(scancode);
+                held.reset(scancode);
+            }
         } else if (event.type == SDL_EVENT_MOUSE_BUTTON_UP || event.type == SDL_EVENT_MOUSE_BUTTON_DOWN) {
-            mouseflags[event.button.button] = event.button;
-        }
-    }
+            uint8_t button = event.button.button;
+            if (button >= mouseButtons) return;
 
-    bool Input::mouseButtonPressed(int mouseflag) {
-        if (mouseflags.contains(mouseflag)) {
-            return mouseflags[mouseflag].down;
+            uint8_t bit = (uint8_t)(1u << button);
+            if (event.button.down) {
+                if (!(mouseHeld & bit)) mousePressed |= bit;
+                mouseHeld |= bit;
+            } else {
+                if (mouseHeld & bit) mouseReleased |= bit;
+                mouseHeld &= (uint8_t)~bit;
+            }
+        } else if (event.type == SDL_EVENT_WINDOW_FOCUS_LOST) {
+            // Key ups are sent to the window that has focus now, nothing would release these
+            released |= held;
+            held.reset();
+            mouseReleased |= mouseHeld;
+            mouseHeld = 0;
         }
-        return false;
     }
 
-    bool Input::keyPressed(SDL_Scancode scancode) {
-        if (scancodes.contains(scancode)) {
-            return scancodes[scancode].down;
+    void Input::resolveActions() {
+        actionStates.resize(actions.size());
+        for (size_t i = 0; i < actions.size(); i++) {
+            const Action& action = actions[i];
+            bool anyHeld = false, anyPressed = false, anyReleased = false;
+            for (uint8_t b = 0; b < action.bindingCount; b++) {
+                const InputBinding& binding = action.bindings[b];
+                anyHeld |= keyHeld(binding.key) || mouseButtonHeld(binding.mouseButton);
+                anyPressed |= keyPressed(binding.key) || mouseButtonPressed(binding.mouseButton);
+                anyReleased |= keyReleased(binding.key) || mouseButtonReleased(binding.mouseButton);
+            }
+
+            uint8_t state = 0;
+            if (anyHeld) state |= heldBit;
+            if (anyPressed) state |= pressedBit;
+            // Still held through another binding is not a release
+            if (anyReleased && !anyHeld) state |= releasedBit;
+            actionStates[i] = state;
         }
-        return false;
     }
 
-    glm::vec2 Input::inputVector(SDL_Scancode positiveX, SDL_Scancode negativeX, SDL_Scancode positiveY, SDL_Scancode negativeY) {
-        glm::vec2 vec = glm::vec2(0.0f);
-
-        if (scancodes.contains(positiveY)) {
-            vec.y += scancodes[positiveY].down ? 1.0f : 0.0f;
-        }
-        if (scancodes.contains(negativeY)) {
-            vec.y += scancodes[negativeY].down ? -1.0f : 0.0f;
-        }
-        if (scancodes.contains(positiveX)) {
-            vec.x += scancodes[positiveX].down ? 1.0f : 0.0f;
-        }
-        if (scancodes.contains(negativeX)) {
-            vec.x += scancodes[negativeX].down ? -1.0f : 0.0f;
-        }
+    glm::vec2 Input::inputVector(SDL_Scancode positiveX, SDL_Scancode negativeX, SDL_Scancode positiveY, SDL_Scancode negativeY) const {
+        glm::vec2 vec = glm::vec2(inputAxis(positiveX, negativeX), inputAxis(positiveY, negativeY));
         vec = glm::clamp(vec, glm::vec2(-1.0f), glm::vec2(1.0f));
 
         return vec;
     }
 
-    float Input::inputAxis(SDL_Scancode positive, SDL_Scancode negative) {
-        float axis = 0.0f;
-
-        if (scancodes.contains(positive)) {
-            axis += scancodes[positive].down ? 1.0f : 0.0f;
-        }
-        if (scancodes.contains(negative)) {
-            axis += scancodes[negative].down ? -1.0f : 0.0f;
-        }
+    float Input::inputAxis(SDL_Scancode positive, SDL_Scancode negative) const {
+        float axis = (keyHeld(positive) ? 1.0f : 0.0f) - (keyHeld(negative) ? 1.0f : 0.0f);
         axis = glm::clamp(axis, -1.0f, 1.0f);
 
         return axis;
     }
+
+    InputAction Input::addAction(const char* name) {
+        InputAction existing = findAction(name);
+        if (existing != UINT16_MAX) return existing;
+
+        Action action;
+        action.name = name;
+        actions.push_back(action);
+        actionStates.push_back(0);
+        return (InputAction)(actions.size() - 1);
+    }
+
+    bool Input::bind(InputAction action, InputBinding binding) {
+        if (action >= actions.size() || actions[action].bindingCount >= maxBindings) return false;
+
+        Action& target = actions[action];
+        target.bindings[target.bindingCount++] = binding;
+        return true;
+    }
+
+    void Input::clearBindings(InputAction action) {
+        if (action < actions.size()) actions[action].bindingCount = 0;
+    }
+
+    InputAction Input::findAction(const char* name) const {
+        for (size_t i = 0; i < actions.size(); i++) {
+            if (actions[i].name == name) return (InputAction)i;
+        }
+        return UINT16_MAX;
+    }
+
+    float Input::actionAxis(InputAction positive, InputAction negative) const {
+        return (actionHeld(positive) ? 1.0f : 0.0f) - (actionHeld(negative) ? 1.0f : 0.0f);
+    }
+
+    glm::vec2 Input::actionVector(InputAction positiveX, InputAction negativeX, InputAction positiveY, InputAction negativeY) const {
+        glm::vec2 vec = glm::vec2(actionAxis(positiveX, negativeX), actionAxis(positiveY, negativeY));
+        return glm::clamp(vec, glm::vec2(-1.0f), glm::vec2(1.0f));
+    }
 }
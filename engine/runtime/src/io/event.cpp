@@ -1,28 +1,328 @@
 #include "io/event.h"
 #include "runtime.h"
+#include "utils/profiler.h"
+#include "memory/allocation_tracker.h"
+#include "utils/logs.h"
 #include "imgui_impl_sdl3.h"
+#include <algorithm>
+#include <cerrno>
+#ifndef _WIN32
+#include <poll.h>
+#endif
 
 namespace runa::runtime::io
 {
+    Event::~Event()
+    {
+        deinit();
+    }
+
+    bool Event::init()
+    {
+        if (initialized) return true;
+        if (!loop.get())
+        {
+            utils::Logs::error("Failed to create the event loop");
+            return false;
+        }
+
+        wakeEvent = SDL_RegisterEvents(1);
+        if (wakeEvent == 0)
+        {
+            utils::Logs::sdlError();
+            return false;
+        }
+        // Keeps the loop alive so it always has a timeout to wait on, and lets deinit
+        // interrupt the watcher
+        wakeup = std::make_unique<async_c>(loop, []() {});
+
+        // Only unix loops have one, Windows waits on a timeout instead
+        backendFd = uv_backend_fd(loop.get());
+        if (backendFd >= 0)
+        {
+            stopping = false;
+            armed = false;
+            int result = watcher.create([this]() { watch(); });
+            if (result < 0)
+            {
+                utils::Logs::error("Failed to create event watcher thread: %s", uv_strerror(result));
+                backendFd = -1;
+            }
+            else
+            {
+                watching = true;
+            }
+        }
+
+        initialized = true;
+        return true;
+    }
+
+    void Event::deinit()
+    {
+        if (!initialized) return;
+        initialized = false;
+
+        if (watching)
+        {
+            {
+                std::lock_guard<std::mutex> lock(watchMutex);
+                stopping = true;
+            }
+            watchCondition.notify_one();
+            // Makes the backend fd readable if the watcher is polling it
+            wakeup->send();
+            watcher.join();
+            watching = false;
+        }
+
+        wakeup->close();
+        // Runs the close callbacks, owners of other handles close them before this
+        loop.run(UV_RUN_NOWAIT);
+        wakeup.reset();
+    }
+
     void Event::run(EEventMode mode)
     {
-        if (mode == pool)
+        RUNA_PROFILE_ZONE("Event::run");
+        RUNA_ALLOCATION_TAG(memory::ioTag);
+        input.beginFrame();
+        recorder.beginFrame();
+        bool replay = recorder.getMode() == replaying;
+
+        // Replays feed recorded events every frame, nothing would end the wait
+        if ((mode == wait || isIdle()) && !replay) block();
+
+        SDL_PumpEvents();
+        drain(replay);
+        flushMotion();
+        while (recorder.replay(event)) dispatch(event);
+        input.resolveActions();
+        updateSubscribers();
+        runLoop();
+    }
+
+    void Event::wake()
+    {
+        if (wakeEvent == 0) return;
+        SDL_Event woken;
+        SDL_zero(woken);
+        woken.type = wakeEvent;
+        SDL_PushEvent(&woken);
+    }
+
+    void Event::block()
+    {
+        if (!initialized) return;
+
+        uv_loop_t* uv = loop.get();
+        // Cached at the last pass, timers would look further away than they are
+        uv_update_time(uv);
+        int timeout = uv_loop_alive(uv) ? uv_backend_timeout(uv) : -1;
+        // A timer is due or callbacks are pending
+        if (timeout == 0) return;
+
+        if (watching)
+        {
+            {
+                std::lock_guard<std::mutex> lock(watchMutex);
+                armed = true;
+            }
+            watchCondition.notify_one();
+        }
+        else if (timeout < 0 || timeout > maxWaitMS)
+        {
+            timeout = maxWaitMS;
+        }
+
+        RUNA_PROFILE_ZONE("Event::wait");
+        uint64_t start = SDL_GetTicksNS();
+        // Leaves the event in the queue for drain
+        SDL_WaitEventTimeout(nullptr, timeout);
+        stats.waits++;
+        stats.waitNS += SDL_GetTicksNS() - start;
+    }
+
+    void Event::runLoop()
+    {
+        if (!loop.get()) return;
+
+        RUNA_PROFILE_ZONE("Event::runLoop");
+        uv_loop_t* uv = loop.get();
+        uint64_t start = SDL_GetTicksNS();
+        for (;;)
+        {
+            loop.run(UV_RUN_NOWAIT);
+            stats.loopPasses++;
+            // Another pass only if callbacks left work that is ready now
+            if (uv_backend_timeout(uv) != 0) break;
+            if (SDL_GetTicksNS() - start >= loopBudgetNS)
+            {
+                stats.overBudget++;
+                break;
+            }
+        }
+    }
+
+    void Event::watch()
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(watchMutex);
+                watchCondition.wait(lock, [this]() { return armed || stopping; });
+                if (stopping) return;
+                armed = false;
+            }
+
+#ifndef _WIN32
+            // The epoll/kqueue fd turns readable once any of its handles has something to report
+            pollfd fd = { backendFd, POLLIN, 0 };
+            while (poll(&fd, 1, -1) < 0 && errno == EINTR) {}
+#endif
+
+            {
+                std::lock_guard<std::mutex> lock(watchMutex);
+                if (stopping) return;
+            }
+            // The main thread may already be awake, an extra wake event only ends one more wait early
+            wake();
+        }
+    }
+
+    uint32_t Event::subscribe(uint32_t type, EventHandler handler)
+    {
+        uint32_t id = nextSubscriber++;
+        // Growing the list would move the handler that is running
+        if (dispatching) pending.push_back({ type, { id, std::move(handler) } });
+        else subscribers[type].push_back({ id, std::move(handler) });
+        return id;
+    }
+
+    void Event::unsubscribe(uint32_t id)
+    {
+        for (PendingSubscriber& added : pending)
+        {
+            if (added.subscriber.id == id) added.subscriber.removed = true;
+        }
+        for (auto& [type, list] : subscribers)
+        {
+            for (auto it = list.begin(); it != list.end(); ++it)
+            {
+                if (it->id != id) continue;
+                // The handler may be the one running, it is destroyed once dispatch is done with the list
+                if (dispatching)
+                {
+                    it->removed = true;
+                    unsubscribed = true;
+                }
+                else list.erase(it);
+                return;
+            }
+        }
+    }
+
+    void Event::drain(bool replay)
+    {
+        // A short batch means the queue ran dry, events pushed by handlers wait for the next frame
+        int count;
+        while ((count = SDL_PeepEvents(batch, batchSize, SDL_GETEVENT, SDL_EVENT_FIRST, SDL_EVENT_LAST)) > 0)
+        {
+            for (int i = 0; i < count; i++) receive(batch[i], replay);
+            if (count < batchSize) break;
+        }
+    }
+
+    void Event::receive(SDL_Event& received, bool replay)
+    {
+        if (received.type == wakeEvent && wakeEvent != 0) return;
+        stats.received++;
+        trackWindow(received);
+        if (render.getImGuiBackend().isInitialized())
+            ImGui_ImplSDL3_ProcessEvent(&received);
+        // ImGui still sees live input, the game only what was recorded
+        if (replay && InputRecorder::isRecorded(received.type)) return;
+
+        if (received.type == SDL_EVENT_MOUSE_MOTION && coalesceMotion)
         {
-            while (SDL_PollEvent(&event))
+            if (!pendingMotion)
             {
-                if (render.getImGuiBackend().isInitialized())
-                    ImGui_ImplSDL3_ProcessEvent(&event);
-                input.updateEvent(event);
-                if (onEvent) onEvent(event);
+                motion = received;
+                pendingMotion = true;
+                return;
             }
+            // Latest position and buttons, deltas add up
+            float xrel = motion.motion.xrel + received.motion.xrel;
+            float yrel = motion.motion.yrel + received.motion.yrel;
+            motion = received;
+            motion.motion.xrel = xrel;
+            motion.motion.yrel = yrel;
+            stats.coalesced++;
             return;
         }
-        while (SDL_WaitEvent(&event))
+
+        // Anything else keeps its place after the motion before it
+        flushMotion();
+        recorder.record(received);
+        dispatch(received);
+    }
+
+    void Event::trackWindow(const SDL_Event& received)
+    {
+        switch (received.type)
+        {
+        case SDL_EVENT_WINDOW_MINIMIZED: minimized = true; break;
+        case SDL_EVENT_WINDOW_RESTORED:
+        case SDL_EVENT_WINDOW_MAXIMIZED: minimized = false; break;
+        case SDL_EVENT_WINDOW_HIDDEN: hidden = true; break;
+        case SDL_EVENT_WINDOW_SHOWN: hidden = false; break;
+        case SDL_EVENT_WINDOW_OCCLUDED: occluded = true; break;
+        case SDL_EVENT_WINDOW_EXPOSED: occluded = false; break;
+        case SDL_EVENT_WINDOW_FOCUS_GAINED: focused = true; break;
+        case SDL_EVENT_WINDOW_FOCUS_LOST: focused = false; break;
+        default: break;
+        }
+    }
+
+    void Event::flushMotion()
+    {
+        if (!pendingMotion) return;
+        pendingMotion = false;
+        recorder.record(motion);
+        dispatch(motion);
+    }
+
+    void Event::dispatch(SDL_Event& dispatched)
+    {
+        stats.dispatched++;
+        input.updateEvent(dispatched);
+
+        auto it = subscribers.find(dispatched.type);
+        if (it != subscribers.end())
+        {
+            dispatching = true;
+            for (Subscriber& subscriber : it->second)
+            {
+                if (!subscriber.removed) subscriber.handler(dispatched);
+            }
+            dispatching = false;
+        }
+        if (onEvent) onEvent(dispatched);
+    }
+
+    void Event::updateSubscribers()
+    {
+        for (PendingSubscriber& added : pending)
+        {
+            if (!added.subscriber.removed) subscribers[added.type].push_back(std::move(added.subscriber));
+        }
+        pending.clear();
+
+        if (!unsubscribed) return;
+        unsubscribed = false;
+        for (auto& [type, list] : subscribers)
         {
-            if (render.getImGuiBackend().isInitialized())
-                ImGui_ImplSDL3_ProcessEvent(&event);
-            input.updateEvent(event);
-            if (onEvent) onEvent(event);
+            list.erase(std::remove_if(list.begin(), list.end(), [](const Subscriber& subscriber) { return subscriber.removed; }), list.end());
         }
     }
 }
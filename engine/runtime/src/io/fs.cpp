@@ -1,8 +1,20 @@
 #include "io/fs.h"
+#include "memory/pool.h"
 
 namespace runa::runtime
 {
-    fs_request_c::fs_request_c(uv_loop_t* loop) : loop_handler(loop), req(new uv_fs_t())
+    namespace
+    {
+        // Streaming opens requests from every loop thread, the thread caches keep them off the lock.
+        // Never destroyed, requests owned by globals can outlive any static
+        memory::ObjectPool<uv_fs_t>& fsRequests()
+        {
+            static auto* pool = new memory::ObjectPool<uv_fs_t>(64, true);
+            return *pool;
+        }
+    }
+
+    fs_request_c::fs_request_c(uv_loop_t* loop) : loop_handler(loop), req(fsRequests().create())
     {
         req->data = this;
     }
@@ -17,7 +29,7 @@ namespace runa::runtime
         if (req)
         {
             uv_fs_req_cleanup(req);
-            delete req;
+            fsRequests().destroy(req);
             req = nullptr;
         }
     }
@@ -80,7 +92,7 @@ namespace runa::runtime
 
     fs_read_c::~fs_read_c()
     {
-        if (buffer) delete buffer;
+        delete[] buffer;
     }
 
     int fs_read_c::read(const char* path, const std::function<void(ssize_t, const char*)>& cb)
@@ -93,7 +105,8 @@ namespace runa::runtime
     {
         callback = cb;
         fd = file;
-        buffer = (char*)malloc(size);
+        delete[] buffer;
+        buffer = new char[size];
         buf = uv_buf_init(buffer, size);
         return uv_fs_read(loop_handler, req, fd, &buf, 1, offset, read_cb);
     }
@@ -132,6 +145,7 @@ namespace runa::runtime
         size_t blksize = req->statbuf.st_blksize;
         uv_fs_req_cleanup(req);
 
+        delete[] self->buffer;
         self->buffer = new char[blksize];
         self->buf = uv_buf_init(self->buffer, blksize);
 
@@ -174,8 +188,130 @@ namespace runa::runtime
     void fs_read_c::close_cb(uv_fs_t* req)
     {
         auto* self = static_cast<fs_read_c*>(req->data);
-        delete self->buffer;
+        // The destructor frees it again otherwise
+        delete[] self->buffer;
+        self->buffer = nullptr;
         self->fd = 0;
         uv_buf_init(nullptr, 0);
     }
-}
\ No newline at end of file
+
+    fs_awaiter_c::~fs_awaiter_c()
+    {
+        if (started) uv_fs_req_cleanup(&req);
+    }
+
+    bool fs_awaiter_c::await_suspend(std::coroutine_handle<> h)
+    {
+        awaiting = h;
+        req.data = this;
+
+        int status = UV_EINVAL;
+        switch (op)
+        {
+        case FS_OPEN:
+            status = uv_fs_open(loop_handler, &req, args.path, args.flags, args.mode, fs_cb);
+            break;
+        case FS_CLOSE:
+            status = uv_fs_close(loop_handler, &req, args.file, fs_cb);
+            break;
+        case FS_READ:
+            status = uv_fs_read(loop_handler, &req, args.file, &args.buf, 1, args.offset, fs_cb);
+            break;
+        case FS_WRITE:
+            status = uv_fs_write(loop_handler, &req, args.file, &args.buf, 1, args.offset, fs_cb);
+            break;
+        case FS_STAT:
+            status = uv_fs_stat(loop_handler, &req, args.path, fs_cb);
+            break;
+        case FS_FSTAT:
+            status = uv_fs_fstat(loop_handler, &req, args.file, fs_cb);
+            break;
+        }
+
+        if (status < 0)
+        {
+            // Not queued, resume right away with the error
+            result = status;
+            return false;
+        }
+        started = true;
+        return true;
+    }
+
+    void fs_awaiter_c::fs_cb(uv_fs_t* req)
+    {
+        auto* self = static_cast<fs_awaiter_c*>(req->data);
+        self->result = req->result;
+        if (self->op == FS_STAT || self->op == FS_FSTAT) self->statbuf = req->statbuf;
+        self->awaiting.resume();
+    }
+
+    fs_awaiter_c fs_c::open(const char* path, int flags, int mode)
+    {
+        return fs_awaiter_c(loop_handler, FS_OPEN, { .path = path, .flags = flags, .mode = mode });
+    }
+
+    fs_awaiter_c fs_c::close(uv_file file)
+    {
+        return fs_awaiter_c(loop_handler, FS_CLOSE, { .file = file });
+    }
+
+    fs_awaiter_c fs_c::read(uv_file file, void* buffer, size_t size, int64_t offset)
+    {
+        return fs_awaiter_c(loop_handler, FS_READ, { .file = file, .buf = uv_buf_init((char*)buffer, (unsigned int)size), .offset = offset });
+    }
+
+    fs_awaiter_c fs_c::write(uv_file file, const void* buffer, size_t size, int64_t offset)
+    {
+        return fs_awaiter_c(loop_handler, FS_WRITE, { .file = file, .buf = uv_buf_init((char*)buffer, (unsigned int)size), .offset = offset });
+    }
+
+    fs_stat_awaiter_c fs_c::stat(const char* path)
+    {
+        return fs_stat_awaiter_c(loop_handler, FS_STAT, { .path = path });
+    }
+
+    fs_stat_awaiter_c fs_c::fstat(uv_file file)
+    {
+        return fs_stat_awaiter_c(loop_handler, FS_FSTAT, { .file = file });
+    }
+
+    task_c<fs_file_t> fs_c::read(std::string path)
+    {
+        fs_file_t file;
+
+        ssize_t fd = co_await open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            file.result = fd;
+            co_return file;
+        }
+
+        fs_stat_t info = co_await fstat((uv_file)fd);
+        if (info.result < 0)
+        {
+            file.result = info.result;
+            co_await close((uv_file)fd);
+            co_return file;
+        }
+
+        file.data.resize((size_t)info.stat.st_size);
+        size_t offset = 0;
+        while (offset < file.data.size())
+        {
+            ssize_t count = co_await read((uv_file)fd, file.data.data() + offset, file.data.size() - offset, (int64_t)offset);
+            if (count <= 0)
+            {
+                if (count < 0) file.result = count;
+                break;
+            }
+            offset += (size_t)count;
+        }
+
+        co_await close((uv_file)fd);
+
+        file.data.resize(offset);
+        if (file.result == 0) file.result = (ssize_t)offset;
+        co_return file;
+    }
+}
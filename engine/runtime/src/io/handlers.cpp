@@ -1,8 +1,19 @@
 #include "io/handlers.h"
+#include "memory/pool.h"
 #include <utility>
 
 namespace runa::runtime
 {
+    namespace
+    {
+        // Never destroyed, work_c objects owned by globals can outlive any static
+        memory::ObjectPool<uv_work_t>& workRequests()
+        {
+            static auto* pool = new memory::ObjectPool<uv_work_t>(64, true);
+            return *pool;
+        }
+    }
+
     void events_c::run(run_mode_t mode)
     {
         while ((mode == POLL ? SDL_PollEvent(&e) : SDL_WaitEvent(&e)))
@@ -63,6 +74,7 @@ namespace runa::runtime
         if (status < 0)
         {
             delete loop;
+            loop = nullptr;
         }
     }
 
@@ -315,6 +327,14 @@ namespace runa::runtime
         }
     }
 
+    thread_c::thread_c() : thread()
+    {
+    }
+
+    thread_c::~thread_c()
+    {
+    }
+
     int thread_c::create(const std::function<void()>& cb)
     {
         callback = cb;
@@ -340,19 +360,19 @@ namespace runa::runtime
         }
     }
 
-    work_c::work_c(loop_c& loop) : loop_handler(loop.get()), req(new uv_work_t())
+    work_c::work_c(loop_c& loop) : loop_handler(loop.get()), req(workRequests().create())
     {
         req->data = this;
     }
 
-    work_c::work_c(uv_loop_t* loop) : loop_handler(loop), req(new uv_work_t())
+    work_c::work_c(uv_loop_t* loop) : loop_handler(loop), req(workRequests().create())
     {
         req->data = this;
     }
 
     work_c::~work_c()
     {
-        delete req;
+        workRequests().destroy(req);
     }
 
     int work_c::queue(std::function<void()> work_cb, std::function<void(int)> after_cb)
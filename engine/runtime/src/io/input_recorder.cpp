@@ -0,0 +1,220 @@
+#include "io/input_recorder.h"
+#include "utils/logs.h"
+
+namespace runa::runtime::io
+{
+    InputRecorder::~InputRecorder()
+    {
+        if (mode == recording) stopRecording();
+    }
+
+    bool InputRecorder::startRecording(const char* file)
+    {
+        if (mode != idle) return false;
+
+        path = file;
+        events.clear();
+        frame = 0;
+        frames = 0;
+        startNS = SDL_GetTicksNS();
+        mode = recording;
+        return true;
+    }
+
+    bool InputRecorder::stopRecording()
+    {
+        if (mode != recording) return false;
+        mode = idle;
+
+        uint64_t durationNS = SDL_GetTicksNS() - startNS;
+        FileHeader header;
+        SDL_memcpy(header.magic, fileMagic, sizeof(header.magic));
+        header.version = fileVersion;
+        header.frames = frame;
+        header.frameDeltaNS = frame > 0 ? durationNS / frame : 0;
+        header.events = events.size();
+
+        SDL_IOStream* io = SDL_IOFromFile(path.c_str(), "wb");
+        if (!io)
+        {
+            utils::Logs::error("Failed to write input recording %s: %s", path.c_str(), SDL_GetError());
+            return false;
+        }
+        size_t bytes = events.size() * sizeof(RecordedEvent);
+        bool written = SDL_WriteIO(io, &header, sizeof(header)) == sizeof(header)
+            && (bytes == 0 || SDL_WriteIO(io, events.data(), bytes) == bytes);
+        if (!SDL_CloseIO(io)) written = false;
+        if (!written)
+        {
+            utils::Logs::error("Failed to write input recording %s: %s", path.c_str(), SDL_GetError());
+            return false;
+        }
+
+        utils::Logs::success("Recorded %llu frames, %zu events to %s", (unsigned long long)frame, events.size(), path.c_str());
+        return true;
+    }
+
+    bool InputRecorder::startReplay(const char* file)
+    {
+        if (mode != idle) return false;
+
+        SDL_IOStream* io = SDL_IOFromFile(file, "rb");
+        if (!io)
+        {
+            utils::Logs::error("Failed to open input recording %s: %s", file, SDL_GetError());
+            return false;
+        }
+
+        FileHeader header;
+        Sint64 size = SDL_GetIOSize(io);
+        bool valid = SDL_ReadIO(io, &header, sizeof(header)) == sizeof(header)
+            && SDL_memcmp(header.magic, fileMagic, sizeof(header.magic)) == 0
+            && header.version == fileVersion
+            // The count comes from the file, a truncated or corrupt one must not size the buffer
+            && size >= (Sint64)sizeof(header)
+            && header.events <= (uint64_t)(size - (Sint64)sizeof(header)) / sizeof(RecordedEvent);
+        if (valid)
+        {
+            events.resize(header.events);
+            size_t bytes = events.size() * sizeof(RecordedEvent);
+            valid = bytes == 0 || SDL_ReadIO(io, events.data(), bytes) == bytes;
+        }
+        SDL_CloseIO(io);
+        if (!valid)
+        {
+            utils::Logs::error("%s is not an input recording", file);
+            events.clear();
+            return false;
+        }
+
+        path = file;
+        frame = 0;
+        frames = header.frames;
+        frameDeltaNS = header.frameDeltaNS;
+        startNS = SDL_GetTicksNS();
+        next = 0;
+        mode = replaying;
+        return true;
+    }
+
+    void InputRecorder::stopReplay()
+    {
+        if (mode != replaying) return;
+        mode = idle;
+        events.clear();
+    }
+
+    void InputRecorder::beginFrame()
+    {
+        if (mode != idle) frame++;
+    }
+
+    void InputRecorder::record(const SDL_Event& event)
+    {
+        if (mode != recording || !isRecorded(event.type)) return;
+
+        RecordedEvent recorded = {};
+        recorded.frame = (uint32_t)(frame > 0 ? frame - 1 : 0);
+        recorded.type = event.type;
+        recorded.timestampNS = event.common.timestamp > startNS ? event.common.timestamp - startNS : 0;
+        switch (event.type)
+        {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            recorded.key.scancode = event.key.scancode;
+            recorded.key.key = event.key.key;
+            recorded.key.mod = event.key.mod;
+            recorded.key.down = event.key.down;
+            recorded.key.repeat = event.key.repeat;
+            break;
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            recorded.button.x = event.button.x;
+            recorded.button.y = event.button.y;
+            recorded.button.button = event.button.button;
+            recorded.button.down = event.button.down;
+            recorded.button.clicks = event.button.clicks;
+            break;
+        case SDL_EVENT_MOUSE_MOTION:
+            recorded.motion.x = event.motion.x;
+            recorded.motion.y = event.motion.y;
+            recorded.motion.xrel = event.motion.xrel;
+            recorded.motion.yrel = event.motion.yrel;
+            break;
+        case SDL_EVENT_MOUSE_WHEEL:
+            recorded.wheel.x = event.wheel.x;
+            recorded.wheel.y = event.wheel.y;
+            recorded.wheel.mouseX = event.wheel.mouse_x;
+            recorded.wheel.mouseY = event.wheel.mouse_y;
+            break;
+        default:
+            break;
+        }
+        events.push_back(recorded);
+    }
+
+    bool InputRecorder::replay(SDL_Event& event)
+    {
+        if (mode != replaying || next >= events.size()) return false;
+
+        const RecordedEvent& recorded = events[next];
+        if (frame == 0 || recorded.frame > frame - 1) return false;
+        next++;
+
+        SDL_zero(event);
+        event.type = recorded.type;
+        event.common.timestamp = startNS + recorded.timestampNS;
+        switch (recorded.type)
+        {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            event.key.scancode = (SDL_Scancode)recorded.key.scancode;
+            event.key.key = recorded.key.key;
+            event.key.mod = recorded.key.mod;
+            event.key.down = recorded.key.down != 0;
+            event.key.repeat = recorded.key.repeat != 0;
+            break;
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            event.button.x = recorded.button.x;
+            event.button.y = recorded.button.y;
+            event.button.button = recorded.button.button;
+            event.button.down = recorded.button.down != 0;
+            event.button.clicks = recorded.button.clicks;
+            break;
+        case SDL_EVENT_MOUSE_MOTION:
+            event.motion.x = recorded.motion.x;
+            event.motion.y = recorded.motion.y;
+            event.motion.xrel = recorded.motion.xrel;
+            event.motion.yrel = recorded.motion.yrel;
+            break;
+        case SDL_EVENT_MOUSE_WHEEL:
+            event.wheel.x = recorded.wheel.x;
+            event.wheel.y = recorded.wheel.y;
+            event.wheel.mouse_x = recorded.wheel.mouseX;
+            event.wheel.mouse_y = recorded.wheel.mouseY;
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    bool InputRecorder::isRecorded(uint32_t type)
+    {
+        switch (type)
+        {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+        case SDL_EVENT_MOUSE_MOTION:
+        case SDL_EVENT_MOUSE_WHEEL:
+        case SDL_EVENT_WINDOW_FOCUS_GAINED:
+        case SDL_EVENT_WINDOW_FOCUS_LOST:
+            return true;
+        default:
+            return false;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include "io/task.h"
+#include <atomic>
+#include <new>
+
+namespace runa::runtime
+{
+    namespace
+    {
+        // Frames are rounded up to 128 bytes, larger than 2 KiB goes straight to the heap
+        constexpr size_t frameGranularity = 128;
+        constexpr size_t frameClasses = 16;
+
+        struct free_frame_t
+        {
+            free_frame_t* next;
+        };
+
+        struct frame_cache_t
+        {
+            free_frame_t* lists[frameClasses] = {};
+
+            ~frame_cache_t()
+            {
+                for (free_frame_t*& list : lists)
+                {
+                    while (list)
+                    {
+                        free_frame_t* next = list->next;
+                        ::operator delete(list);
+                        list = next;
+                    }
+                }
+            }
+        };
+
+        thread_local frame_cache_t frameCache;
+        std::atomic<uint64_t> heapAllocations = 0;
+
+        size_t frame_class(size_t size)
+        {
+            return size == 0 ? 0 : (size - 1) / frameGranularity;
+        }
+    }
+
+    void* frame_allocator_c::allocate(size_t size)
+    {
+        size_t index = frame_class(size);
+        if (index < frameClasses)
+        {
+            if (free_frame_t* frame = frameCache.lists[index])
+            {
+                frameCache.lists[index] = frame->next;
+                return frame;
+            }
+            size = (index + 1) * frameGranularity;
+        }
+
+        heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+
+    void frame_allocator_c::deallocate(void* ptr, size_t size)
+    {
+        size_t index = frame_class(size);
+        if (index >= frameClasses)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        // Frames resume on their loop thread, so this is normally the list it came from
+        auto* frame = static_cast<free_frame_t*>(ptr);
+        frame->next = frameCache.lists[index];
+        frameCache.lists[index] = frame;
+    }
+
+    uint64_t frame_allocator_c::heap_allocations()
+    {
+        return heapAllocations.load(std::memory_order_relaxed);
+    }
+}
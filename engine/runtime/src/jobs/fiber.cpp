@@ -0,0 +1,234 @@
+#include "jobs/fiber.h"
+#include "utils/logs.h"
+#include <cstdlib>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if !defined(_WIN32) && !defined(RUNA_FIBER_UCONTEXT)
+#if defined(__APPLE__)
+#define RUNA_FIBER_SYMBOL(name) "_" #name
+#else
+#define RUNA_FIBER_SYMBOL(name) #name
+#endif
+
+extern "C" void runa_fiber_switch(void** from, void* to);
+extern "C" void runa_fiber_trampoline();
+
+// Saves callee saved registers, mxcsr and the x87 control word on the current stack,
+// stores the stack pointer in *from and restores the same layout from to
+asm(
+    ".text\n"
+    ".globl " RUNA_FIBER_SYMBOL(runa_fiber_switch) "\n"
+    ".p2align 4\n"
+    RUNA_FIBER_SYMBOL(runa_fiber_switch) ":\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".globl " RUNA_FIBER_SYMBOL(runa_fiber_trampoline) "\n"
+    ".p2align 4\n"
+    RUNA_FIBER_SYMBOL(runa_fiber_trampoline) ":\n"
+    "    movq %r12, %rdi\n"
+    "    callq *%r13\n"
+    "    ud2\n"
+);
+#endif
+
+namespace runa::runtime::jobs
+{
+    Fiber::~Fiber()
+    {
+        deinit();
+    }
+
+    bool Fiber::init(size_t stackSize, FiberFunction fn, void* data)
+    {
+        entry = fn;
+        arg = data;
+        fromThread = false;
+
+#if defined(_WIN32)
+        handle = CreateFiberEx(stackSize, stackSize, FIBER_FLAG_FLOAT_SWITCH, (LPFIBER_START_ROUTINE)startWin32, this);
+        if (!handle)
+        {
+            utils::Logs::error("Failed to create fiber: %lu", GetLastError());
+            return false;
+        }
+#else
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        // Round to pages plus one guard page at the bottom, overflows fault instead of corrupting memory
+        stackBytes = (stackSize + page - 1) / page * page + page;
+        stack = mmap(nullptr, stackBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (stack == MAP_FAILED)
+        {
+            stack = nullptr;
+            utils::Logs::error("Failed to allocate fiber stack of %zu bytes", stackBytes);
+            return false;
+        }
+        mprotect(stack, page, PROT_NONE);
+
+#if defined(RUNA_FIBER_UCONTEXT)
+        getcontext(&context);
+        context.uc_stack.ss_sp = (char*)stack + page;
+        context.uc_stack.ss_size = stackBytes - page;
+        context.uc_link = nullptr;
+        uintptr_t self = (uintptr_t)this;
+        makecontext(&context, (void (*)())startContext, 2, (uint32_t)self, (uint32_t)((uint64_t)self >> 32));
+#else
+        // Initial frame matching runa_fiber_switch, returning into the trampoline with a 16 byte aligned stack
+        uintptr_t top = ((uintptr_t)stack + stackBytes) & ~(uintptr_t)15;
+        uint64_t* frame = (uint64_t*)(top - 16 - 64);
+        frame[0] = 0x1F80 | ((uint64_t)0x037F << 32);
+        frame[1] = 0;
+        frame[2] = 0;
+        frame[3] = (uint64_t)&Fiber::start;
+        frame[4] = (uint64_t)this;
+        frame[5] = 0;
+        frame[6] = 0;
+        frame[7] = (uint64_t)&runa_fiber_trampoline;
+        sp = frame;
+#endif
+#endif
+        return true;
+    }
+
+    bool Fiber::initFromThread()
+    {
+        fromThread = true;
+#if defined(_WIN32)
+        handle = ConvertThreadToFiberEx(nullptr, FIBER_FLAG_FLOAT_SWITCH);
+        if (!handle)
+        {
+            if (GetLastError() != ERROR_ALREADY_FIBER) return false;
+            handle = GetCurrentFiber();
+            fromThread = false;
+        }
+#endif
+        // POSIX contexts are captured by the first switch away from the thread
+        return true;
+    }
+
+    void Fiber::deinit()
+    {
+#if defined(_WIN32)
+        if (handle)
+        {
+            if (fromThread) ConvertFiberToThread();
+            else DeleteFiber(handle);
+        }
+        handle = nullptr;
+#else
+        if (stack) munmap(stack, stackBytes);
+        stack = nullptr;
+        stackBytes = 0;
+#endif
+        entry = nullptr;
+        arg = nullptr;
+        fromThread = false;
+    }
+
+    void Fiber::switchTo(Fiber& target)
+    {
+#if defined(_WIN32)
+        SwitchToFiber(target.handle);
+#elif defined(RUNA_FIBER_UCONTEXT)
+        swapcontext(&context, &target.context);
+#else
+        runa_fiber_switch(&sp, target.sp);
+#endif
+    }
+
+    void Fiber::start(Fiber* fiber)
+    {
+        fiber->entry(fiber->arg);
+        // Returning would run off the top of the stack
+        utils::Logs::error("Fiber entry returned");
+        std::abort();
+    }
+
+#if defined(RUNA_FIBER_UCONTEXT)
+    void Fiber::startContext(uint32_t low, uint32_t high)
+    {
+        start((Fiber*)(((uint64_t)high << 32) | low));
+    }
+#elif defined(_WIN32)
+    void __stdcall Fiber::startWin32(void* fiber)
+    {
+        start((Fiber*)fiber);
+    }
+#endif
+
+    FiberPool::~FiberPool()
+    {
+        deinit();
+    }
+
+    bool FiberPool::init(uint32_t count, size_t stackSize, FiberFunction entry, void* arg)
+    {
+        fibers.reserve(count);
+        freeList.reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            auto fiber = std::make_unique<Fiber>();
+            if (!fiber->init(stackSize, entry, arg))
+            {
+                deinit();
+                return false;
+            }
+            freeList.push_back(fiber.get());
+            fibers.push_back(std::move(fiber));
+        }
+        return true;
+    }
+
+    void FiberPool::deinit()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeList.clear();
+        fibers.clear();
+    }
+
+    Fiber* FiberPool::acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeList.empty()) return nullptr;
+        Fiber* fiber = freeList.back();
+        freeList.pop_back();
+        return fiber;
+    }
+
+    void FiberPool::release(Fiber* fiber)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeList.push_back(fiber);
+    }
+
+    uint32_t FiberPool::available()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (uint32_t)freeList.size();
+    }
+}
@@ -0,0 +1,555 @@
+#include "jobs/job_system.h"
+#include "utils/logs.h"
+#include "utils/profiler.h"
+#include "memory/allocation_tracker.h"
+#include <algorithm>
+#include <thread>
+
+namespace runa::runtime::jobs
+{
+    namespace
+    {
+        enum ESwitchAction : uint8_t {
+            switchNone = 0,
+            // Previous fiber goes back to the pool
+            switchRelease = 1,
+            // Previous fiber waits on counter
+            switchPark = 2
+        };
+
+        struct ThreadState
+        {
+            uint32_t index = UINT32_MAX;
+            // Pool fiber running on this thread, nullptr outside of fibers mode
+            Fiber* current = nullptr;
+            Fiber* threadFiber = nullptr;
+            // What to do with the fiber we just switched away from, done by whoever runs next
+            // since the previous fiber's stack is in use until the switch completes
+            Fiber* previous = nullptr;
+            uint8_t action = switchNone;
+            Counter* counter = nullptr;
+        };
+
+        thread_local ThreadState threadState;
+
+        // Fibers resume on other threads, the compiler must not cache this address across a switch
+#if defined(_MSC_VER)
+        __declspec(noinline)
+#else
+        __attribute__((noinline))
+#endif
+        ThreadState& state()
+        {
+            return threadState;
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        deinit();
+    }
+
+    bool JobSystem::init(uint32_t workerCount, EJobMode jobMode)
+    {
+        if (initialized) return false;
+
+        mode = jobMode;
+        if (mode == fibers && !fiberPool.init(fiberCount, fiberStackSize, fiberEntry, this))
+        {
+            utils::Logs::error("Failed to create job fibers");
+            return false;
+        }
+
+        if (workerCount == 0)
+        {
+            workerCount = (uint32_t)std::max(1, SDL_GetNumLogicalCPUCores());
+        }
+
+        running = true;
+        workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++)
+        {
+            workers.push_back(std::make_unique<Worker>());
+            workers[i]->seed = i * 2654435761u + 1;
+        }
+
+        // The calling thread is worker 0, it only runs jobs from wait()
+        state().index = 0;
+        initialized = true;
+
+        for (uint32_t i = 1; i < workerCount; i++)
+        {
+            workers[i]->thread = std::make_unique<thread_c>();
+            int result = workers[i]->thread->create([this, i]() { workerLoop(i); });
+            if (result < 0)
+            {
+                utils::Logs::error("Failed to create job worker %u: %s", i, uv_strerror(result));
+                workers[i]->thread.reset();
+                deinit();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void JobSystem::deinit()
+    {
+        if (!initialized) return;
+
+        running = false;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        sleepCondition.notify_all();
+
+        for (std::unique_ptr<Worker>& worker : workers)
+        {
+            if (worker->thread) worker->thread->join();
+        }
+        workers.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(injectMutex);
+            injected.clear();
+            injectedCount = 0;
+        }
+        {
+            std::lock_guard<std::mutex> lock(deferredMutex);
+            deferred.clear();
+            deferredCount = 0;
+        }
+        pendingJobs = 0;
+        resumeSignals = 0;
+
+        fiberPool.deinit();
+        waiting.clear();
+        waitingCount = 0;
+
+        state().index = UINT32_MAX;
+        initialized = false;
+    }
+
+    void JobSystem::run(JobFunction function, void* data, Counter* counter)
+    {
+        run(function, data, 0, 0, counter);
+    }
+
+    void JobSystem::run(JobFunction function, void* data, uint32_t begin, uint32_t end, Counter* counter, Counter* dependency)
+    {
+        Job job{ function, data, begin, end, counter, dependency };
+        if (counter) counter->value.fetch_add(1, std::memory_order_relaxed);
+
+        // Held back until the dependency is done, no worker polls it in the meantime
+        if (dependency && !dependency->isDone())
+        {
+            defer(job);
+            return;
+        }
+
+        if (!initialized)
+        {
+            // Nothing to schedule on, keep callers working without a job system
+            execute(job);
+            return;
+        }
+        submit(job);
+    }
+
+    void JobSystem::submit(const Job& job)
+    {
+        uint32_t index = state().index;
+        if (index < workers.size())
+        {
+            Worker& worker = *workers[index];
+            // Checked before the slot is written, only the owner pushes so the push cannot fail after it
+            JobSlot* slot = worker.deque.full() ? nullptr : acquireSlot(worker);
+            if (!slot)
+            {
+                // Every slot is queued or being taken, running inline is the only way to make progress
+                Job local = job;
+                execute(local);
+                return;
+            }
+            slot->job = job;
+            worker.deque.push(slot);
+        }
+        else
+        {
+            inject(job);
+            return;
+        }
+
+        pendingJobs.fetch_add(1);
+        wake();
+    }
+
+    JobSystem::JobSlot* JobSystem::acquireSlot(Worker& worker)
+    {
+        for (uint32_t attempt = 0; attempt < maxJobsPerWorker; attempt++)
+        {
+            JobSlot& slot = worker.ring[worker.allocated++ & (maxJobsPerWorker - 1)];
+            if (slot.busy.load(std::memory_order_acquire)) continue;
+            slot.busy.store(true, std::memory_order_relaxed);
+            return &slot;
+        }
+        return nullptr;
+    }
+
+    void JobSystem::inject(const Job& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(injectMutex);
+            injected.push_back(job);
+            injectedCount++;
+        }
+        pendingJobs.fetch_add(1);
+        wake();
+    }
+
+    void JobSystem::defer(const Job& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(deferredMutex);
+            deferred.push_back(job);
+            deferredCount.fetch_add(1);
+        }
+        // The dependency may have finished before the job was listed, nobody would release it then
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (job.dependency->isDone()) releaseDeferred();
+    }
+
+    void JobSystem::releaseDeferred()
+    {
+        std::vector<Job> ready;
+        {
+            std::lock_guard<std::mutex> lock(deferredMutex);
+            for (size_t i = 0; i < deferred.size();)
+            {
+                if (!deferred[i].dependency->isDone())
+                {
+                    i++;
+                    continue;
+                }
+                ready.push_back(deferred[i]);
+                deferred[i] = deferred.back();
+                deferred.pop_back();
+                deferredCount.fetch_sub(1);
+            }
+        }
+
+        // Shared queue, any worker picks them up. Without workers they run here
+        for (Job& job : ready)
+        {
+            if (initialized) inject(job);
+            else execute(job);
+        }
+    }
+
+    void JobSystem::wait(Counter& counter)
+    {
+        while (!counter.isDone())
+        {
+            if (state().current)
+            {
+                // Park this fiber, a resumable or fresh one takes over the worker
+                Fiber* next = popResumable();
+                if (!next) next = fiberPool.acquire();
+                if (next)
+                {
+                    switchFiber(next, switchPark, &counter);
+                    continue;
+                }
+            }
+
+            // Main thread, threads mode or no fiber left, help instead
+            uint32_t index = state().index;
+            if (index < workers.size() && tryRunOne(index)) continue;
+            std::this_thread::yield();
+        }
+    }
+
+    JobStats JobSystem::getStats() const
+    {
+        JobStats stats;
+        for (const std::unique_ptr<Worker>& worker : workers)
+        {
+            stats.executed += worker->executed.load(std::memory_order_relaxed);
+            stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+            stats.sleeps += worker->sleeps.load(std::memory_order_relaxed);
+            stats.switches += worker->switches.load(std::memory_order_relaxed);
+        }
+        stats.waitingFibers = waitingCount.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    uint32_t JobSystem::getWorkerIndex()
+    {
+        return state().index;
+    }
+
+    uint32_t JobSystem::chunkSize(uint32_t count, uint32_t minChunk) const
+    {
+        // A few chunks per worker so stealing can balance uneven work
+        uint32_t chunks = std::max<uint32_t>(1, getWorkerCount()) * 4;
+        return std::max({ count / chunks, minChunk, 1u });
+    }
+
+    Job* JobSystem::fetch(uint32_t index, Job& local)
+    {
+        Worker& self = *workers[index];
+        if (JobSlot* slot = self.deque.pop())
+        {
+            local = slot->job;
+            slot->busy.store(false, std::memory_order_release);
+            return &local;
+        }
+
+        if (injectedCount.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(injectMutex);
+            if (!injected.empty())
+            {
+                local = injected.front();
+                injected.pop_front();
+                injectedCount--;
+                return &local;
+            }
+        }
+
+        uint32_t count = (uint32_t)workers.size();
+        for (uint32_t attempt = 0; attempt < count; attempt++)
+        {
+            // xorshift, cheap random victim so workers do not all hit the same deque
+            self.seed ^= self.seed << 13;
+            self.seed ^= self.seed >> 17;
+            self.seed ^= self.seed << 5;
+            uint32_t victim = self.seed % count;
+            if (victim == index) continue;
+
+            if (JobSlot* slot = workers[victim]->deque.steal())
+            {
+                // Copied before the slot is handed back, the owner may reuse it right after
+                local = slot->job;
+                slot->busy.store(false, std::memory_order_release);
+                self.stolen.fetch_add(1, std::memory_order_relaxed);
+                return &local;
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool JobSystem::tryRunOne(uint32_t index)
+    {
+        // Queued jobs never wait on a dependency, see defer
+        Job job;
+        if (!fetch(index, job)) return false;
+        pendingJobs.fetch_sub(1);
+
+        execute(job);
+        return true;
+    }
+
+    void JobSystem::execute(Job& job)
+    {
+        job.function(job.data, job.begin, job.end);
+        if (job.counter && job.counter->value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            // Last job of the group, whatever waits on it can go
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (deferredCount.load(std::memory_order_relaxed) > 0) releaseDeferred();
+            if (waitingCount.load(std::memory_order_relaxed) > 0)
+            {
+                resumeSignals.fetch_add(1);
+                wake();
+            }
+        }
+
+        // May have resumed on another worker if the job waited on a fiber
+        uint32_t index = state().index;
+        if (index < workers.size())
+        {
+            workers[index]->executed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void JobSystem::wake()
+    {
+        if (sleeping.load() == 0) return;
+
+        // Taking the lock orders this against a worker between its check and its wait
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        sleepCondition.notify_one();
+    }
+
+    void JobSystem::sleep(uint32_t index)
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1);
+        workers[index]->sleeps.fetch_add(1, std::memory_order_relaxed);
+        // Parked fibers are resumed by polling, a finished counter signals that one may be ready
+        sleepCondition.wait(lock, [this]() {
+            return pendingJobs.load() > 0 || resumeSignals.exchange(0) > 0 || !running.load();
+        });
+        sleeping.fetch_sub(1);
+    }
+
+    void JobSystem::workerLoop(uint32_t index)
+    {
+        state().index = index;
+        profiler.setThreadName("Job worker");
+        RUNA_ALLOCATION_TAG(memory::jobTag);
+
+        if (mode == fibers)
+        {
+            Fiber threadFiber;
+            Fiber* fiber = fiberPool.acquire();
+            if (threadFiber.initFromThread() && fiber)
+            {
+                state().threadFiber = &threadFiber;
+                state().current = fiber;
+                threadFiber.switchTo(*fiber);
+
+                // The last fiber switched back here because the system is stopping
+                afterSwitch();
+                state().current = nullptr;
+                state().threadFiber = nullptr;
+                return;
+            }
+            if (fiber) fiberPool.release(fiber);
+            utils::Logs::warning("Job worker %u running without fibers", index);
+        }
+
+        uint32_t idle = 0;
+        while (running.load(std::memory_order_relaxed))
+        {
+            if (tryRunOne(index))
+            {
+                idle = 0;
+                continue;
+            }
+
+            // Spin briefly before sleeping, frames submit work in bursts
+            if (++idle < 64)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            sleep(index);
+            idle = 0;
+        }
+    }
+
+    void JobSystem::fiberEntry(void* arg)
+    {
+        auto* self = static_cast<JobSystem*>(arg);
+        self->afterSwitch();
+        self->fiberLoop();
+    }
+
+    void JobSystem::fiberLoop()
+    {
+        uint32_t idle = 0;
+        while (running.load(std::memory_order_relaxed))
+        {
+            // Suspended jobs are older than anything queued, finish them first
+            if (waitingCount.load(std::memory_order_relaxed) > 0)
+            {
+                if (Fiber* next = popResumable())
+                {
+                    switchFiber(next, switchRelease, nullptr);
+                    idle = 0;
+                    continue;
+                }
+            }
+
+            // Never cached, this fiber may be running on another worker than last iteration
+            uint32_t index = state().index;
+            if (tryRunOne(index))
+            {
+                idle = 0;
+                continue;
+            }
+
+            if (++idle < 64)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            sleep(index);
+            idle = 0;
+        }
+
+        switchFiber(state().threadFiber, switchRelease, nullptr);
+        // Never resumed, the pool is destroyed after workers join
+        std::abort();
+    }
+
+    Fiber* JobSystem::popResumable()
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        for (size_t i = 0; i < waiting.size(); i++)
+        {
+            if (!waiting[i].counter->isDone()) continue;
+
+            Fiber* fiber = waiting[i].fiber;
+            waiting[i] = waiting.back();
+            waiting.pop_back();
+            waitingCount--;
+            return fiber;
+        }
+        return nullptr;
+    }
+
+    void JobSystem::switchFiber(Fiber* next, uint8_t action, Counter* counter)
+    {
+        ThreadState& current = state();
+        Fiber* from = current.current;
+        current.previous = from;
+        current.action = action;
+        current.counter = counter;
+        current.current = next;
+        workers[current.index]->switches.fetch_add(1, std::memory_order_relaxed);
+
+        from->switchTo(*next);
+
+        // Resumed, possibly on another thread
+        afterSwitch();
+    }
+
+    void JobSystem::afterSwitch()
+    {
+        ThreadState& current = state();
+        Fiber* previous = current.previous;
+        uint8_t action = current.action;
+        Counter* counter = current.counter;
+        current.previous = nullptr;
+        current.action = switchNone;
+        current.counter = nullptr;
+
+        if (action == switchRelease)
+        {
+            fiberPool.release(previous);
+        }
+        else if (action == switchPark)
+        {
+            {
+                std::lock_guard<std::mutex> lock(waitMutex);
+                waiting.push_back({ previous, counter });
+                waitingCount++;
+            }
+            // Finished while it was being parked, no later completion would signal it
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (counter->isDone())
+            {
+                resumeSignals.fetch_add(1);
+                wake();
+            }
+        }
+    }
+}
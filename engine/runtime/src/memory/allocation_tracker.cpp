@@ -0,0 +1,344 @@
+#include "memory/allocation_tracker.h"
+#include "utils/logs.h"
+#include <SDL3/SDL.h>
+#include <cstdlib>
+#include <new>
+
+#if defined(ENGINE_ALLOCATION_TRACKER)
+#if defined(_WIN32)
+#include <windows.h>
+#elif __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define RUNA_HAS_EXECINFO
+#endif
+#endif
+
+namespace runa::runtime
+{
+    // Not with the other globals in runtime.cpp, operator new runs before any of them is constructed
+    constinit memory::AllocationTracker allocationTracker;
+}
+
+namespace runa::runtime::memory
+{
+    namespace
+    {
+        constinit thread_local EAllocationTag currentTag = generalTag;
+        // Set while the tracker itself runs, logging and capturing stacks may allocate
+        constinit thread_local bool inside = false;
+    }
+
+    AllocationScope::AllocationScope(EAllocationTag tag) : previous(currentTag)
+    {
+        currentTag = tag;
+    }
+
+    AllocationScope::~AllocationScope()
+    {
+        currentTag = previous;
+    }
+
+    EAllocationTag AllocationScope::current()
+    {
+        return currentTag;
+    }
+
+    void AllocationTracker::frame()
+    {
+        for (TagCounters& tag : counters)
+        {
+            tag.lastFrameAllocations.store(tag.frameAllocations.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+            tag.lastFrameBytes.store(tag.frameBytes.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    AllocationStats AllocationTracker::getStats() const
+    {
+        AllocationStats stats;
+        for (size_t i = 0; i < AllocationStats::tags; i++)
+        {
+            stats.liveBytes[i] = counters[i].liveBytes.load(std::memory_order_relaxed);
+            stats.liveCount[i] = counters[i].liveCount.load(std::memory_order_relaxed);
+            stats.allocations[i] = counters[i].allocations.load(std::memory_order_relaxed);
+            stats.frameAllocations[i] = counters[i].lastFrameAllocations.load(std::memory_order_relaxed);
+            stats.frameBytes[i] = counters[i].lastFrameBytes.load(std::memory_order_relaxed);
+        }
+        stats.badFrees = badFrees.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    const char* AllocationTracker::tagName(EAllocationTag tag)
+    {
+        switch (tag)
+        {
+        case renderTag: return "Render";
+        case resourceTag: return "Resources";
+        case ioTag: return "IO";
+        case jobTag: return "Jobs";
+        default: return "General";
+        }
+    }
+
+#if defined(ENGINE_ALLOCATION_TRACKER)
+    namespace
+    {
+        constexpr uint32_t liveMagic = 0x414e5552;
+        constexpr uint32_t freedMagic = 0x45455246;
+
+        // Right before every pointer handed out
+        struct alignas(16) Header
+        {
+            uint32_t magic;
+            EAllocationTag tag;
+            bool array;
+            // Back to what malloc returned, aligned allocations are padded in front
+            uint32_t offset;
+            // Index + 1 of the stack sample, 0 when not sampled
+            uint32_t sample;
+            size_t size;
+        };
+
+        struct Sample
+        {
+            void* frames[AllocationTracker::maxFrames];
+            uint32_t frameCount;
+            EAllocationTag tag;
+            bool live;
+            size_t size;
+            uint64_t frame;
+        };
+
+        // Plain static storage, nothing here may allocate
+        constexpr uint32_t sampleCapacity = 4096;
+        Sample samples[sampleCapacity];
+        uint32_t freeSamples[sampleCapacity];
+        uint32_t freeSampleCount = 0;
+        uint32_t usedSamples = 0;
+        SDL_SpinLock sampleLock = 0;
+
+        constinit thread_local uint32_t sampleCountdown = 0;
+
+        uint32_t captureStack(void** frames, uint32_t max)
+        {
+#if defined(_WIN32)
+            // Skips this function and the tracker
+            return RtlCaptureStackBackTrace(2, max, frames, nullptr);
+#elif defined(RUNA_HAS_EXECINFO)
+            return (uint32_t)backtrace(frames, (int)max);
+#else
+            (void)frames;
+            (void)max;
+            return 0;
+#endif
+        }
+
+        void logStack(void* const* frames, uint32_t count)
+        {
+#if defined(RUNA_HAS_EXECINFO)
+            // malloc, not operator new
+            char** symbols = backtrace_symbols(frames, (int)count);
+            for (uint32_t i = 0; i < count; i++) utils::Logs::log("    %s", symbols ? symbols[i] : "?");
+            free(symbols);
+#else
+            for (uint32_t i = 0; i < count; i++) utils::Logs::log("    %p", frames[i]);
+#endif
+        }
+
+        uint32_t takeSample(EAllocationTag tag, size_t size, uint64_t frame)
+        {
+            void* frames[AllocationTracker::maxFrames];
+            uint32_t count = captureStack(frames, AllocationTracker::maxFrames);
+
+            SDL_LockSpinlock(&sampleLock);
+            uint32_t index = UINT32_MAX;
+            if (freeSampleCount > 0) index = freeSamples[--freeSampleCount];
+            else if (usedSamples < sampleCapacity) index = usedSamples++;
+
+            if (index != UINT32_MAX)
+            {
+                Sample& sample = samples[index];
+                for (uint32_t i = 0; i < count; i++) sample.frames[i] = frames[i];
+                sample.frameCount = count;
+                sample.tag = tag;
+                sample.live = true;
+                sample.size = size;
+                sample.frame = frame;
+            }
+            SDL_UnlockSpinlock(&sampleLock);
+            // Full table, this one is counted but not sampled
+            return index == UINT32_MAX ? 0 : index + 1;
+        }
+
+        void releaseSample(uint32_t sample)
+        {
+            SDL_LockSpinlock(&sampleLock);
+            samples[sample - 1].live = false;
+            freeSamples[freeSampleCount++] = sample - 1;
+            SDL_UnlockSpinlock(&sampleLock);
+        }
+    }
+
+    void* AllocationTracker::allocate(size_t size, size_t alignment, bool array)
+    {
+        if (alignment < alignof(Header)) alignment = alignof(Header);
+        // malloc already aligns to the header, anything stricter needs room to move the pointer
+        size_t padding = alignment > alignof(Header) ? alignment : 0;
+        auto* raw = static_cast<std::byte*>(malloc(size + sizeof(Header) + padding));
+        if (!raw) return nullptr;
+
+        size_t address = (size_t)(raw + sizeof(Header));
+        auto* pointer = reinterpret_cast<std::byte*>((address + alignment - 1) & ~(alignment - 1));
+        Header* header = reinterpret_cast<Header*>(pointer) - 1;
+        header->magic = liveMagic;
+        header->tag = currentTag;
+        header->array = array;
+        header->offset = (uint32_t)(pointer - raw);
+        header->sample = 0;
+        header->size = size;
+
+        TagCounters& tag = counters[header->tag];
+        tag.liveBytes.fetch_add(size, std::memory_order_relaxed);
+        tag.liveCount.fetch_add(1, std::memory_order_relaxed);
+        tag.allocations.fetch_add(1, std::memory_order_relaxed);
+        tag.frameAllocations.fetch_add(1, std::memory_order_relaxed);
+        tag.frameBytes.fetch_add(size, std::memory_order_relaxed);
+
+        uint32_t rate = sampleRate.load(std::memory_order_relaxed);
+        if (rate > 0 && !inside)
+        {
+            if (sampleCountdown == 0 || sampleCountdown > rate)
+            {
+                inside = true;
+                header->sample = takeSample(header->tag, size, frames.load(std::memory_order_relaxed));
+                inside = false;
+                sampleCountdown = rate;
+            }
+            sampleCountdown--;
+        }
+        return pointer;
+    }
+
+    void AllocationTracker::deallocate(void* pointer, bool array)
+    {
+        if (!pointer) return;
+
+        // Best effort, memory from malloc or freed already can hold anything in front of it
+        Header* header = static_cast<Header*>(pointer) - 1;
+        if (header->magic != liveMagic)
+        {
+            // Leaked rather than handed to free, which would corrupt the heap
+            badFree(header->magic == freedMagic ? "Double free" : "Free of memory operator new never returned", pointer);
+            return;
+        }
+        if (header->array != array) badFree(array ? "delete[] of memory from new" : "delete of memory from new[]", pointer);
+
+        header->magic = freedMagic;
+        TagCounters& tag = counters[header->tag];
+        tag.liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+        tag.liveCount.fetch_sub(1, std::memory_order_relaxed);
+        if (header->sample != 0) releaseSample(header->sample);
+
+        free(static_cast<std::byte*>(pointer) - header->offset);
+    }
+
+    size_t AllocationTracker::reportLeaks(size_t maxStacks)
+    {
+        bool wasInside = inside;
+        inside = true;
+
+        size_t live = 0;
+        for (uint8_t i = 0; i < AllocationStats::tags; i++)
+        {
+            size_t count = counters[i].liveCount.load(std::memory_order_relaxed);
+            if (count == 0) continue;
+            live += count;
+            utils::Logs::warning("%s: %zu allocations still live, %zu bytes", tagName((EAllocationTag)i),
+                count, counters[i].liveBytes.load(std::memory_order_relaxed));
+        }
+
+        size_t stacks = 0;
+        SDL_LockSpinlock(&sampleLock);
+        for (uint32_t i = 0; i < usedSamples && stacks < maxStacks; i++)
+        {
+            const Sample& sample = samples[i];
+            if (!sample.live) continue;
+            utils::Logs::warning("%zu bytes (%s) allocated in frame %llu:", sample.size, tagName(sample.tag), (unsigned long long)sample.frame);
+            logStack(sample.frames, sample.frameCount);
+            stacks++;
+        }
+        SDL_UnlockSpinlock(&sampleLock);
+
+        inside = wasInside;
+        return live;
+    }
+
+    void AllocationTracker::badFree(const char* reason, void* pointer)
+    {
+        badFrees.fetch_add(1, std::memory_order_relaxed);
+        if (inside) return;
+
+        inside = true;
+        void* frames[maxFrames];
+        uint32_t count = captureStack(frames, maxFrames);
+        utils::Logs::error("%s: %p", reason, pointer);
+        logStack(frames, count);
+        inside = false;
+    }
+#else
+    void* AllocationTracker::allocate(size_t size, size_t alignment, bool)
+    {
+        return SDL_aligned_alloc(alignment, size);
+    }
+
+    void AllocationTracker::deallocate(void* pointer, bool)
+    {
+        SDL_aligned_free(pointer);
+    }
+
+    size_t AllocationTracker::reportLeaks(size_t)
+    {
+        return 0;
+    }
+
+    void AllocationTracker::badFree(const char*, void*)
+    {
+    }
+#endif
+}
+
+#if defined(ENGINE_ALLOCATION_TRACKER)
+namespace
+{
+    using runa::runtime::allocationTracker;
+
+    void* trackedNew(size_t size, size_t alignment, bool array)
+    {
+        void* pointer = allocationTracker.allocate(size, alignment, array);
+        if (!pointer) throw std::bad_alloc();
+        return pointer;
+    }
+}
+
+void* operator new(size_t size) { return trackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, false); }
+void* operator new[](size_t size) { return trackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, true); }
+void* operator new(size_t size, std::align_val_t alignment) { return trackedNew(size, (size_t)alignment, false); }
+void* operator new[](size_t size, std::align_val_t alignment) { return trackedNew(size, (size_t)alignment, true); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocationTracker.allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, false); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocationTracker.allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, true); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocationTracker.allocate(size, (size_t)alignment, false); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocationTracker.allocate(size, (size_t)alignment, true); }
+
+void operator delete(void* pointer) noexcept { allocationTracker.deallocate(pointer, false); }
+void operator delete[](void* pointer) noexcept { allocationTracker.deallocate(pointer, true); }
+void operator delete(void* pointer, size_t) noexcept { allocationTracker.deallocate(pointer, false); }
+void operator delete[](void* pointer, size_t) noexcept { allocationTracker.deallocate(pointer, true); }
+void operator delete(void* pointer, std::align_val_t) noexcept { allocationTracker.deallocate(pointer, false); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { allocationTracker.deallocate(pointer, true); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { allocationTracker.deallocate(pointer, false); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { allocationTracker.deallocate(pointer, true); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { allocationTracker.deallocate(pointer, false); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { allocationTracker.deallocate(pointer, true); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { allocationTracker.deallocate(pointer, false); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { allocationTracker.deallocate(pointer, true); }
+#endif
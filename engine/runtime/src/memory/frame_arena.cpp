@@ -0,0 +1,172 @@
+#include "memory/frame_arena.h"
+#include <algorithm>
+#include <cstring>
+
+namespace runa::runtime::memory
+{
+    namespace
+    {
+        constexpr std::align_val_t blockAlignment{ 64 };
+
+        size_t alignUp(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    LinearArena::LinearArena(size_t blockSize) : blockSize(blockSize)
+    {
+    }
+
+    LinearArena::~LinearArena()
+    {
+        freeBlocks();
+    }
+
+    void* LinearArena::allocate(size_t size, size_t alignment)
+    {
+        if (size == 0) size = 1;
+
+        while (current < blocks.size())
+        {
+            Block& block = blocks[current];
+            // Aligned on the address, blocks are only 64 byte aligned
+            size_t start = alignUp((size_t)block.data + offset, alignment) - (size_t)block.data;
+            if (start + size <= block.size)
+            {
+                offset = start + size;
+                stats.used += size;
+                stats.allocations++;
+                return block.data + start;
+            }
+
+            // The rest of this block is wasted for this frame, next frame it gets folded into one
+            current++;
+            offset = 0;
+        }
+
+        addBlock(size + alignment);
+        current = blocks.size() - 1;
+        offset = 0;
+        return allocate(size, alignment);
+    }
+
+    const char* LinearArena::copyString(std::string_view text)
+    {
+        char* copy = allocateArray<char>(text.size() + 1);
+        std::memcpy(copy, text.data(), text.size());
+        copy[text.size()] = '\0';
+        return copy;
+    }
+
+    void LinearArena::reset()
+    {
+        stats.peak = std::max(stats.peak, stats.used);
+
+        if (blocks.size() > 1)
+        {
+            // The frame overflowed, one block of everything it needed is cheaper from now on
+            size_t total = stats.capacity;
+            freeBlocks();
+            addBlock(total);
+        }
+
+        current = 0;
+        offset = 0;
+        stats.used = 0;
+        stats.allocations = 0;
+    }
+
+    void LinearArena::addBlock(size_t minimum)
+    {
+        size_t size = std::max(blockSize, alignUp(minimum, 64));
+        Block block;
+        block.data = static_cast<std::byte*>(::operator new(size, blockAlignment));
+        block.size = size;
+        blocks.push_back(block);
+
+        stats.capacity += size;
+        stats.heapAllocations++;
+    }
+
+    void LinearArena::freeBlocks()
+    {
+        for (Block& block : blocks) ::operator delete(block.data, blockAlignment);
+        blocks.clear();
+        stats.capacity = 0;
+    }
+
+    void FrameArenas::beginFrame()
+    {
+        frame.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    LinearArena& FrameArenas::current()
+    {
+        // One FrameArenas per process, the global below
+        thread_local ThreadArenas* local = nullptr;
+        if (!local) local = threadArenas();
+
+        uint64_t now = frame.load(std::memory_order_relaxed);
+        LinearArena& arena = local->arenas[now & 1];
+        if (local->frame != now)
+        {
+            // This arena was last used two frames ago or earlier, nothing can point into it anymore
+            publish(*local, arena);
+            arena.reset();
+
+            // After skipping frames the other one is free as well
+            if (now - local->frame >= 2) local->arenas[(now + 1) & 1].reset();
+            local->frame = now;
+        }
+        return arena;
+    }
+
+    ArenaStats FrameArenas::getStats()
+    {
+        ArenaStats total;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& thread : threads)
+        {
+            total.used += thread->used.load(std::memory_order_relaxed);
+            total.capacity += thread->capacity.load(std::memory_order_relaxed);
+            total.peak += thread->peak.load(std::memory_order_relaxed);
+            total.allocations += thread->allocations.load(std::memory_order_relaxed);
+            total.heapAllocations += thread->heapAllocations.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    FrameArenas::ThreadArenas* FrameArenas::threadArenas()
+    {
+        auto arenas = std::make_unique<ThreadArenas>();
+        arenas->frame = frame.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.push_back(std::move(arenas));
+        return threads.back().get();
+    }
+
+    void FrameArenas::publish(ThreadArenas& local, const LinearArena& arena)
+    {
+        const ArenaStats& stats = arena.getStats();
+        const ArenaStats& other = (&arena == &local.arenas[0] ? local.arenas[1] : local.arenas[0]).getStats();
+
+        local.used.store(stats.used, std::memory_order_relaxed);
+        local.capacity.store(stats.capacity + other.capacity, std::memory_order_relaxed);
+        local.peak.store(std::max({ local.peak.load(std::memory_order_relaxed), stats.used, stats.peak }), std::memory_order_relaxed);
+        local.allocations.store(stats.allocations, std::memory_order_relaxed);
+        local.heapAllocations.store(stats.heapAllocations + other.heapAllocations, std::memory_order_relaxed);
+    }
+
+    void* FrameResource::do_allocate(size_t bytes, size_t alignment)
+    {
+        return frameArenas.allocate(bytes, alignment);
+    }
+
+    FrameResource* frameResource()
+    {
+        static FrameResource resource;
+        return &resource;
+    }
+}
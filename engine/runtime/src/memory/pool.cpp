@@ -0,0 +1,194 @@
+#include "memory/pool.h"
+
+namespace runa::runtime::memory
+{
+    namespace
+    {
+        // Pools with thread caches, and the cache indices free for new threads
+        struct CacheRegistry
+        {
+            std::mutex mutex;
+            std::vector<PoolAllocator*> pools;
+            std::vector<uint32_t> freeIndices;
+            uint32_t nextIndex = 0;
+        };
+
+        // Constant initialized, it is there for the first pool and still there when the main thread exits
+        constinit CacheRegistry registry;
+    }
+
+    struct PoolAllocator::ThreadSlot
+    {
+        uint32_t index;
+
+        ThreadSlot()
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            if (!registry.freeIndices.empty())
+            {
+                index = registry.freeIndices.back();
+                registry.freeIndices.pop_back();
+            }
+            // Past maxCaches live threads go without a cache
+            else index = registry.nextIndex < maxCaches ? registry.nextIndex++ : maxCaches;
+        }
+
+        ~ThreadSlot()
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            if (index >= maxCaches) return;
+            for (PoolAllocator* pool : registry.pools) pool->flushCache(index);
+            registry.freeIndices.push_back(index);
+        }
+    };
+
+    PoolAllocator::PoolAllocator(size_t blockSize, size_t alignment, uint32_t blocksPerSlab, bool threadCaches)
+        : alignment(std::max(alignment, alignof(FreeBlock))), blocksPerSlab(std::max(blocksPerSlab, 1u))
+    {
+        // Every block has to hold the free list link and keep the next one aligned
+        size_t size = std::max(blockSize, sizeof(FreeBlock));
+        this->blockSize = (size + this->alignment - 1) / this->alignment * this->alignment;
+        if (threadCaches)
+        {
+            caches = std::make_unique<ThreadCache[]>(maxCaches);
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.pools.push_back(this);
+        }
+    }
+
+    PoolAllocator::~PoolAllocator()
+    {
+        if (caches)
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.pools.erase(std::find(registry.pools.begin(), registry.pools.end(), this));
+        }
+        for (std::byte* slab : slabs) ::operator delete(slab, std::align_val_t(alignment));
+    }
+
+    void* PoolAllocator::allocate()
+    {
+        ThreadCache* cache = threadCache();
+        if (cache)
+        {
+            uint32_t count = cache->count.load(std::memory_order_relaxed);
+            if (count > 0)
+            {
+                cache->hits.store(cache->hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                cache->count.store(count - 1, std::memory_order_relaxed);
+                return cache->blocks[count - 1];
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        FreeBlock* block = pop();
+        if (cache)
+        {
+            // Refill half the cache so a burst of allocations does not come back for the lock every time
+            for (uint32_t i = 0; i < cacheSize / 2; i++) cache->blocks[i] = pop();
+            cache->count.store(cacheSize / 2, std::memory_order_relaxed);
+            live += cacheSize / 2;
+        }
+        live++;
+        allocations++;
+        return block;
+    }
+
+    void PoolAllocator::deallocate(void* block)
+    {
+        if (!block) return;
+
+        ThreadCache* cache = threadCache();
+        if (cache)
+        {
+            uint32_t count = cache->count.load(std::memory_order_relaxed);
+            if (count < cacheSize)
+            {
+                cache->blocks[count] = static_cast<FreeBlock*>(block);
+                cache->count.store(count + 1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto* freed = static_cast<FreeBlock*>(block);
+        freed->next = freeList;
+        freeList = freed;
+        live--;
+
+        if (cache)
+        {
+            // Give back half, the other half serves the next allocations
+            for (uint32_t i = cacheSize / 2; i < cacheSize; i++)
+            {
+                cache->blocks[i]->next = freeList;
+                freeList = cache->blocks[i];
+                live--;
+            }
+            cache->count.store(cacheSize / 2, std::memory_order_relaxed);
+        }
+    }
+
+    PoolStats PoolAllocator::getStats()
+    {
+        PoolStats stats;
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.blockSize = blockSize;
+        stats.live = live;
+        stats.capacity = slabs.size() * blocksPerSlab;
+        stats.slabs = slabs.size();
+        stats.allocations = allocations;
+
+        // Blocks sitting in caches left the shared list but are not in use
+        for (uint32_t i = 0; caches && i < maxCaches; i++)
+        {
+            stats.live -= caches[i].count.load(std::memory_order_relaxed);
+            stats.cacheHits += caches[i].hits.load(std::memory_order_relaxed);
+        }
+        stats.allocations += stats.cacheHits;
+        return stats;
+    }
+
+    PoolAllocator::ThreadCache* PoolAllocator::threadCache()
+    {
+        if (!caches) return nullptr;
+        thread_local ThreadSlot slot;
+        return slot.index < maxCaches ? &caches[slot.index] : nullptr;
+    }
+
+    void PoolAllocator::flushCache(uint32_t index)
+    {
+        ThreadCache& cache = caches[index];
+        uint32_t count = cache.count.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            cache.blocks[i]->next = freeList;
+            freeList = cache.blocks[i];
+        }
+        live -= count;
+        cache.count.store(0, std::memory_order_relaxed);
+    }
+
+    PoolAllocator::FreeBlock* PoolAllocator::pop()
+    {
+        if (!freeList) addSlab();
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+
+    void PoolAllocator::addSlab()
+    {
+        auto* slab = static_cast<std::byte*>(::operator new(blockSize * blocksPerSlab, std::align_val_t(alignment)));
+        slabs.push_back(slab);
+
+        // Linked back to front so blocks are handed out in address order
+        for (uint32_t i = blocksPerSlab; i > 0; i--)
+        {
+            auto* block = reinterpret_cast<FreeBlock*>(slab + (size_t)(i - 1) * blockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+    }
+}
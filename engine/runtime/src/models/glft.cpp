@@ -1,6 +1,10 @@
 #include "models/glft.h"
 #include "glad/glad.h"
 #include "utils/logs.h"
+#include "utils/hash.h"
+#include "utils/system.h"
+#include "runtime.h"
+#include <algorithm>
 
 namespace runa::runtime::models
 {
@@ -20,38 +24,160 @@ namespace runa::runtime::models
         if (!utils::Logs::gltfError(cgltf_validate(data)))
         {
             cgltf_free(data);
+            data = nullptr;
             return false;
         }
 
         std::string path = filepath;
         path = path.substr(0, path.find_last_of('/') + 1);
 
-        std::string uri = path + data->buffers[0].uri;
-
         if (!utils::Logs::gltfError(cgltf_load_buffers(&options, data, filepath))) {
             cgltf_free(data);
+            data = nullptr;
             return false;
         }
 
         dir = path;
+        file = filepath;
+        // Another spelling of the same path finds the same meshes
+        fileKey = utils::hash(utils::normalizePath(filepath));
+
+        // Skins first, meshes record which one they use
+        skeletons.resize(data->skins_count);
+        for (cgltf_size i = 0; i < data->skins_count; i++)
+        {
+            if (!loadSkin(&data->skins[i], skeletons[i])) skeletons[i] = {};
+        }
+        clips.resize(data->skins_count);
+        for (cgltf_size skin = 0; skin < data->skins_count; skin++)
+        {
+            clips[skin].resize(data->animations_count);
+            for (cgltf_size i = 0; i < data->animations_count; i++) loadAnimation(&data->animations[i], &data->skins[skin], clips[skin][i]);
+        }
+
+        nodes.assign(data->nodes_count, ecs::noNode);
+        if (data->scene || data->scenes_count > 0)
+        {
+            const cgltf_scene* scene = data->scene ? data->scene : &data->scenes[0];
+            for (cgltf_size i = 0; i < scene->nodes_count; i++) loadNode(scene->nodes[i], ecs::noNode);
+        }
+        else
+        {
+            for (cgltf_size i = 0; i < data->nodes_count; i++)
+            {
+                if (!data->nodes[i].parent) loadNode(&data->nodes[i], ecs::noNode);
+            }
+        }
+        hierarchy.update();
+
+        // Point into skeletons and skinnedVertices, both are final by now
+        animators.resize(meshes.size());
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            int32_t skin = meshSkins[i];
+            if (skin < 0 || skeletons[skin].size() == 0 || skinnedVertices[i].size() == 0) continue;
+            animators[i] = std::make_unique<animation::Animator>();
+            animators[i]->init(&skeletons[skin], &skinnedVertices[i]);
+        }
 
         return true;
     }
 
+    void gltf::draw(opengl::CommandBuffer& commands, const opengl::Shader& shader, const opengl::Camera& camera, const glm::mat4& model)
+    {
+        hierarchy.update();
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            opengl::Mesh* mesh = resourceManager.get(meshes[i]);
+            if (!mesh) continue;
+
+            const animation::Animator* animator = i < animators.size() ? animators[i].get() : nullptr;
+            if (animator)
+            {
+                // Skinned vertices are in model space already, glTF ignores the node of a skinned mesh
+                const std::vector<glm::vec3>& positions = animator->getSkinnedPositions();
+                const std::vector<glm::vec3>& normals = animator->getSkinnedNormals();
+                commands.updateVertices(*mesh, positions.data(), normals.empty() ? nullptr : normals.data(), positions.size());
+                commands.drawMesh(*mesh, shader, camera, model);
+                continue;
+            }
+            commands.drawMesh(*mesh, shader, camera, ecs::multiply(model, hierarchy.getWorld(meshNodes[i])));
+        }
+    }
+
+    void gltf::loadNode(cgltf_node* node, ecs::TransformNode parent)
+    {
+        // Matrix or TRS, cgltf composes either
+        glm::mat4 local;
+        cgltf_node_transform_local(node, &local[0][0]);
+        ecs::TransformNode index = hierarchy.add(parent, local);
+        nodes[cgltf_node_index(data, node)] = index;
+
+        if (node->mesh) loadMesh((unsigned int)cgltf_mesh_index(data, node->mesh), index, node->skin);
+        for (cgltf_size i = 0; i < node->children_count; i++) loadNode(node->children[i], index);
+    }
+
     void gltf::deinit()
     {
+        for (const resources::MeshHandle& mesh : meshes)
+        {
+            resourceManager.release(mesh);
+        }
+        meshes.clear();
+        for (const resources::TextureHandle& texture : textures)
+        {
+            resourceManager.release(texture);
+        }
+        textures.clear();
+        texturesLoaded = false;
+        meshNodes.clear();
+        meshSkins.clear();
+        animators.clear();
+        skinnedVertices.clear();
+        nodes.clear();
+        skeletons.clear();
+        clips.clear();
+        hierarchy.clear();
         if (data) cgltf_free(data);
         data = nullptr;
     }
 
-    void gltf::loadMesh(unsigned int indMesh) 
+    void gltf::loadMesh(unsigned int indMesh, ecs::TransformNode node, const cgltf_skin* skin)
     {
-        // Get all accessor indices
-        cgltf_primitive* primitive = &data->meshes[indMesh].primitives[0];
-        cgltf_accessor* posAccessor = primitive->attributes[0].data;
-        cgltf_accessor* normalAccessor = primitive->attributes[1].data;
-        cgltf_accessor* texAccessor = primitive->attributes[2].data;
-        cgltf_accessor* indAccessor = primitive->indices;
+        const cgltf_primitive* primitive = &data->meshes[indMesh].primitives[0];
+        animation::SkinnedVertices skinned;
+        int32_t skinIndex = -1;
+        if (skin && cgltf_find_accessor(primitive, cgltf_attribute_type_joints, 0) && cgltf_find_accessor(primitive, cgltf_attribute_type_weights, 0))
+        {
+            skinIndex = (int32_t)cgltf_skin_index(data, skin);
+            loadSkinnedVertices(primitive, skin, skinned);
+        }
+
+        // Same file and mesh index always produce the same mesh, share it if another instance loaded it.
+        // A skinned mesh is rewritten by the animator of this instance, it gets its own
+        bool dynamic = skinned.size() > 0;
+        uint64_t key = dynamic ? 0 : utils::hashCombine(fileKey, indMesh);
+        // Nothing is ever cached under key 0
+        resources::MeshHandle cached = resourceManager.findMesh(key);
+        if (cached.isValid())
+        {
+            meshes.push_back(cached);
+            meshNodes.push_back(node);
+            meshSkins.push_back(skinIndex);
+            skinnedVertices.push_back(std::move(skinned));
+            return;
+        }
+
+        // Attributes can come in any order, only the position is required
+        const cgltf_accessor* posAccessor = cgltf_find_accessor(primitive, cgltf_attribute_type_position, 0);
+        const cgltf_accessor* normalAccessor = cgltf_find_accessor(primitive, cgltf_attribute_type_normal, 0);
+        const cgltf_accessor* texAccessor = cgltf_find_accessor(primitive, cgltf_attribute_type_texcoord, 0);
+        const cgltf_accessor* indAccessor = primitive->indices;
+        if (!posAccessor || !indAccessor)
+        {
+            utils::Logs::error("Mesh %u of %s has no positions or indices", indMesh, file.c_str());
+            return;
+        }
 
         // Use accessor indices to get all vertices components
         std::vector<float> posVec = getFloats(posAccessor);
@@ -64,164 +190,254 @@ namespace runa::runtime::models
         // Combine all the vertex components and also get the indices and textures
         std::vector<opengl::Vertex> vertices = assembleVertices(positions, normals, texUVs);
         std::vector<GLuint> indices = getIndices(indAccessor);
-        std::vector<opengl::Texture> textures = getTextures();
+        // The mesh takes its own references, the file keeps one per image until deinit
+        std::vector<resources::TextureHandle> meshTextures = getTextures();
 
         // Combine the vertices, indices, and textures into a mesh
-        opengl::Mesh mesh;
-        if (mesh.init(vertices, indices, textures)) {
+        resources::MeshHandle mesh = resourceManager.createMesh(key, vertices, indices, meshTextures, dynamic);
+        if (resourceManager.get(mesh)) {
             meshes.push_back(mesh);
+            meshNodes.push_back(node);
+            meshSkins.push_back(skinIndex);
+            skinnedVertices.push_back(std::move(skinned));
+        }
+        else {
+            resourceManager.release(mesh);
         }
     }
 
-    std::vector<uint8_t> gltf::getData() {
-        std::vector<uint8_t> gltfData;
+    const animation::SkinnedVertices* gltf::getSkinnedVertices(size_t mesh) const
+    {
+        if (mesh >= skinnedVertices.size() || skinnedVertices[mesh].size() == 0) return nullptr;
+        return &skinnedVertices[mesh];
+    }
 
-        //Get data fom buffer or .bin file
-        cgltf_buffer* gltfBuf = &data->buffers[0];
-        gltfData.assign(
-            static_cast<uint8_t*>(gltfBuf->data),
-            static_cast<uint8_t*>(gltfBuf->data) + gltfBuf->size
-        );
+    const std::vector<animation::AnimationClip>& gltf::getClips(size_t skin) const
+    {
+        static const std::vector<animation::AnimationClip> none;
+        return skin < clips.size() ? clips[skin] : none;
+    }
 
-        return gltfData;
+    std::vector<int32_t> gltf::jointsOf(const cgltf_skin* skin)
+    {
+        std::vector<int32_t> joints(data->nodes_count, -1);
+        for (cgltf_size joint = 0; joint < skin->joints_count; joint++)
+        {
+            joints[cgltf_node_index(data, skin->joints[joint])] = (int32_t)joint;
+        }
+        return joints;
     }
 
-    std::vector<float> gltf::getFloats(cgltf_accessor* accessor)
+    bool gltf::loadSkin(const cgltf_skin* skin, animation::Skeleton& skeleton)
     {
-        // Get properties from the accessor
-        const cgltf_size elementCount = accessor->count;
-        const cgltf_size accessorByteOffset = accessor->offset;
-        const cgltf_type accessorType = accessor->type;
+        uint32_t count = (uint32_t)skin->joints_count;
+        std::vector<int32_t> joints = jointsOf(skin);
+        skeleton.parents.assign(count, animation::noParent);
+        skeleton.inverseBinds.assign(count, glm::mat4(1.0f));
+        skeleton.bases.assign(count, glm::mat4(1.0f));
+        skeleton.bindPose.resize(count);
+
+        for (uint32_t joint = 0; joint < count; joint++)
+        {
+            const cgltf_node* node = skin->joints[joint];
+            // Nearest joint above, nodes in between that are not joints are skipped
+            const cgltf_node* parent = node->parent;
+            while (parent && joints[cgltf_node_index(data, parent)] < 0) parent = parent->parent;
+            if (parent) skeleton.parents[joint] = joints[cgltf_node_index(data, parent)];
+            else if (node->parent) cgltf_node_transform_world(node->parent, &skeleton.bases[joint][0][0]);
 
-        // Get properties from the bufferView
-        const cgltf_size bufferViewByteOffset = accessor->buffer_view->offset;
+            if (skin->inverse_bind_matrices) cgltf_accessor_read_float(skin->inverse_bind_matrices, joint, &skeleton.inverseBinds[joint][0][0], 16);
 
-        // Interpret the type and store it into componentsPerElement
-        unsigned int componentsPerElement = 0;
-        switch (accessorType)
-        {
-        case cgltf_type_scalar: componentsPerElement = 1;
-            break;
-        case cgltf_type_vec2: componentsPerElement = 2;
-            break;
-        case cgltf_type_vec3: componentsPerElement = 3;
-            break;
-        case cgltf_type_vec4: componentsPerElement = 4;
-            break;
-        default: break;
+            if (node->has_matrix)
+            {
+                // Joints are animated as TRS, split the matrix assuming it has no shear
+                glm::mat4 matrix;
+                cgltf_node_transform_local(node, &matrix[0][0]);
+                glm::vec3 scale(glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])));
+                skeleton.bindPose.translations[joint] = glm::vec3(matrix[3]);
+                skeleton.bindPose.scales[joint] = scale;
+                skeleton.bindPose.rotations[joint] = glm::quat_cast(glm::mat4(matrix[0] * (1.0f / scale.x), matrix[1] * (1.0f / scale.y),
+                    matrix[2] * (1.0f / scale.z), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)));
+                continue;
+            }
+            if (node->has_translation) skeleton.bindPose.translations[joint] = glm::vec3(node->translation[0], node->translation[1], node->translation[2]);
+            if (node->has_rotation) skeleton.bindPose.rotations[joint] = glm::quat(node->rotation[3], node->rotation[0], node->rotation[1], node->rotation[2]);
+            if (node->has_scale) skeleton.bindPose.scales[joint] = glm::vec3(node->scale[0], node->scale[1], node->scale[2]);
         }
 
-        // Pre-allocate the vector with the exact number of floats needed
-        const cgltf_size totalFloatCount = elementCount * componentsPerElement;
-        std::vector<float> floatValues;
-        floatValues.reserve(totalFloatCount);
-
-        // Go over all the bytes in the data at the correct place using the properties from above
-        const cgltf_size dataStartOffset = bufferViewByteOffset + accessorByteOffset;
-        const cgltf_size dataSizeInBytes = totalFloatCount * sizeof(float);
-        for (cgltf_size byteIndex = dataStartOffset; byteIndex < dataStartOffset + dataSizeInBytes; byteIndex += sizeof(float))
+        if (!skeleton.finalize())
         {
-            float value;
-            memcpy(&value, &data[byteIndex], sizeof(float));
-            floatValues.push_back(value);
+            utils::Logs::error("Skin %s of %s is not a valid skeleton", skin->name ? skin->name : "", file.c_str());
+            return false;
         }
-
-        return floatValues;
+        return true;
     }
 
-    std::vector<GLuint> gltf::getIndices(cgltf_accessor* accessor)
+    void gltf::loadAnimation(const cgltf_animation* source, const cgltf_skin* skin, animation::AnimationClip& clip)
     {
-        std::vector<GLuint> indices;
-
-        // Get properties from the accessor
-        const cgltf_size elementCount = accessor->count;
-        const cgltf_size accessorByteOffset = accessor->offset;
-        const cgltf_component_type componentType = accessor->component_type;
-
-        // Get properties from the bufferView
-        const cgltf_size bufferViewByteOffset = accessor->buffer_view->offset;
-
-        // Pre-allocate the vector with the exact number of indices needed
-        indices.resize(elementCount);
-
-        // Calculate the starting position in the data buffer
-        const cgltf_size dataStartOffset = bufferViewByteOffset + accessorByteOffset;
-
-        // Extract indices based on their component type
-        if (componentType == cgltf_component_type_r_32u) // Unsigned int (32-bit)
+        clip.name = source->name ? source->name : "";
+        std::vector<int32_t> joints = jointsOf(skin);
+        for (cgltf_size i = 0; i < source->channels_count; i++)
         {
-            const cgltf_size dataSizeInBytes = elementCount * sizeof(unsigned int);
-            cgltf_size indexPos = 0;
-            for (cgltf_size byteIndex = dataStartOffset; byteIndex < dataStartOffset + dataSizeInBytes; byteIndex +=
-                sizeof(unsigned int))
+            const cgltf_animation_channel& channel = source->channels[i];
+            if (!channel.target_node || !channel.sampler) continue;
+            int32_t joint = joints[cgltf_node_index(data, channel.target_node)];
+            if (joint < 0) continue;
+
+            animation::EAnimationPath path;
+            uint32_t components;
+            switch (channel.target_path)
             {
-                unsigned int value;
-                memcpy(&value, &data[byteIndex], sizeof(unsigned int));
-                indices[indexPos++] = (GLuint)value;
+            case cgltf_animation_path_type_translation: path = animation::translationPath; components = 3; break;
+            case cgltf_animation_path_type_rotation: path = animation::rotationPath; components = 4; break;
+            case cgltf_animation_path_type_scale: path = animation::scalePath; components = 3; break;
+            // Morph target weights are not supported
+            default: continue;
             }
-        }
-        else if (componentType == cgltf_component_type_r_16u) // Unsigned short (16-bit)
-        {
-            const cgltf_size dataSizeInBytes = elementCount * sizeof(unsigned short);
-            cgltf_size indexPos = 0;
-            for (cgltf_size byteIndex = dataStartOffset; byteIndex < dataStartOffset + dataSizeInBytes; byteIndex +=
-                sizeof(unsigned short))
+
+            const cgltf_animation_sampler* sampler = channel.sampler;
+            std::vector<float> times = getFloats(sampler->input);
+            std::vector<float> values = getFloats(sampler->output);
+            uint32_t count = (uint32_t)times.size();
+            if (sampler->interpolation == cgltf_interpolation_type_cubic_spline)
             {
-                unsigned short value;
-                memcpy(&value, &data[byteIndex], sizeof(unsigned short));
-                indices[indexPos++] = (GLuint)value;
+                // In tangent, value, out tangent per key, the values are played back linearly
+                std::vector<float> points(count * components);
+                for (uint32_t key = 0; key < count && (key * 3 + 2) * components <= values.size(); key++)
+                {
+                    std::copy_n(&values[(key * 3 + 1) * components], components, &points[key * components]);
+                }
+                values = std::move(points);
             }
+            if (values.size() < count * components)
+            {
+                utils::Logs::error("Animation %s of %s has a channel with missing values", clip.name.c_str(), file.c_str());
+                continue;
+            }
+            clip.addTrack((uint16_t)joint, path, times.data(), values.data(), count, sampler->interpolation == cgltf_interpolation_type_step);
+        }
+    }
+
+    void gltf::loadSkinnedVertices(const cgltf_primitive* primitive, const cgltf_skin* skin, animation::SkinnedVertices& vertices)
+    {
+        const cgltf_accessor* jointAccessor = cgltf_find_accessor(primitive, cgltf_attribute_type_joints, 0);
+        const cgltf_accessor* weightAccessor = cgltf_find_accessor(primitive, cgltf_attribute_type_weights, 0);
+        vertices.positions = groupFloatsVec3(getFloats(cgltf_find_accessor(primitive, cgltf_attribute_type_position, 0)));
+        vertices.normals = groupFloatsVec3(getFloats(cgltf_find_accessor(primitive, cgltf_attribute_type_normal, 0)));
+        vertices.weights = groupFloatsVec4(getFloats(weightAccessor));
+
+        size_t count = vertices.positions.size();
+        if (jointAccessor->count < count || vertices.weights.size() < count)
+        {
+            utils::Logs::error("Skinned mesh of %s has fewer joints or weights than positions", file.c_str());
+            vertices = {};
+            return;
         }
-        else if (componentType == cgltf_component_type_r_16) // Signed short (16-bit)
+        // Widens 8 and 16 bit joint indices
+        vertices.joints.resize(count * 4);
+        for (size_t vertex = 0; vertex < count; vertex++)
         {
-            const cgltf_size dataSizeInBytes = elementCount * sizeof(short);
-            cgltf_size indexPos = 0;
-            for (cgltf_size byteIndex = dataStartOffset; byteIndex < dataStartOffset + dataSizeInBytes; byteIndex +=
-                sizeof(short))
+            cgltf_uint joints[4] = {};
+            cgltf_accessor_read_uint(jointAccessor, vertex, joints, 4);
+            for (int i = 0; i < 4; i++)
             {
-                short value;
-                memcpy(&value, &data[byteIndex], sizeof(short));
-                indices[indexPos++] = (GLuint)value;
+                // Out of range joints would read past the palette, they lose their weight instead
+                if (joints[i] >= skin->joints_count)
+                {
+                    joints[i] = 0;
+                    vertices.weights[vertex][i] = 0.0f;
+                }
+                vertices.joints[vertex * 4 + i] = (uint16_t)joints[i];
             }
         }
+    }
+
+    std::vector<uint8_t> gltf::getData() {
+        std::vector<uint8_t> gltfData;
+
+        //Get data fom buffer or .bin file
+        cgltf_buffer* gltfBuf = &data->buffers[0];
+        gltfData.assign(
+            static_cast<uint8_t*>(gltfBuf->data),
+            static_cast<uint8_t*>(gltfBuf->data) + gltfBuf->size
+        );
+
+        return gltfData;
+    }
+
+    std::vector<float> gltf::getFloats(const cgltf_accessor* accessor)
+    {
+        std::vector<float> floatValues;
+        if (!accessor) return floatValues;
+
+        // cgltf follows the buffer view, stride, normalization and sparse storage of the accessor
+        floatValues.resize(accessor->count * cgltf_num_components(accessor->type));
+        cgltf_accessor_unpack_floats(accessor, floatValues.data(), floatValues.size());
+        return floatValues;
+    }
 
+    std::vector<GLuint> gltf::getIndices(const cgltf_accessor* accessor)
+    {
+        std::vector<GLuint> indices(accessor->count);
+        // Widens 8, 16 and 32 bit indices
+        if (cgltf_accessor_unpack_indices(accessor, indices.data(), sizeof(GLuint), indices.size()) != indices.size())
+        {
+            utils::Logs::error("Failed to read the indices of %s", file.c_str());
+            indices.clear();
+        }
         return indices;
     }
 
-    std::vector<opengl::Texture> gltf::getTextures()
+    const std::vector<resources::TextureHandle>& gltf::getTextures()
     {
-        std::vector<opengl::Texture> textures;
+        // Every mesh of the file shares the same images, they are looked up once
+        if (texturesLoaded) return textures;
+        texturesLoaded = true;
 
-        // Go over all images
+        // Go over all images, the resource manager skips the ones already loaded by any model
         for (unsigned int i = 0; i < data->images_count; i++)
         {
-            // uri of current texture
-            std::string texUri = data->images[i].uri;
-
-            // Check if the texture has already been loaded
-            if (modelTextures.contains(texUri.c_str())) {
-                textures.push_back(modelTextures.at(texUri.c_str()));
-                continue;
-            }
-            // If the texture has been loaded, skip this
+            const cgltf_image& image = data->images[i];
+            // Images embedded in a buffer view have no uri, exporters usually keep their name
+            const char* label = image.uri ? image.uri : image.name;
+            if (!label) continue;
+            std::string texLabel = label;
 
+            const char* type = nullptr;
             // Load diffuse texture
-            if (texUri.find("baseColor") != std::string::npos)
+            if (texLabel.find("baseColor") != std::string::npos)
             {
-                opengl::Texture diffuse;
-                if (diffuse.init((dir + texUri).c_str(), "diffuse", modelTextures.size(), 0, GL_UNSIGNED_BYTE)) {
-                    textures.push_back(diffuse);
-                    modelTextures.insert_or_assign(texUri.c_str(), diffuse);
-                }
+                type = "diffuse";
             }
             // Load specular texture
-            else if (texUri.find("metallicRoughness") != std::string::npos)
+            else if (texLabel.find("metallicRoughness") != std::string::npos)
             {
-                opengl::Texture specular;
-                if (specular.init((dir + texUri).c_str(), "specular", modelTextures.size(), 0, GL_UNSIGNED_BYTE)) {
-                    textures.push_back(specular);
-                    modelTextures.insert_or_assign(texUri.c_str(), specular);
-                }
+                type = "specular";
+            }
+            if (!type) continue;
+
+            resources::TextureHandle texture;
+            if (image.uri)
+            {
+                texture = resourceManager.loadTexture((dir + texLabel).c_str(), type);
+            }
+            else if (image.buffer_view && image.buffer_view->buffer->data)
+            {
+                // Keyed like the meshes, by the file and the image index
+                const uint8_t* bytes = static_cast<const uint8_t*>(image.buffer_view->buffer->data) + image.buffer_view->offset;
+                texture = resourceManager.loadTexture(utils::hashCombine(fileKey, i), bytes, image.buffer_view->size, type, file.c_str());
+            }
+            else
+            {
+                utils::Logs::error("Image %s of %s has neither a uri nor a loaded buffer view", label, file.c_str());
+                continue;
+            }
+
+            if (resourceManager.get(texture)) {
+                textures.push_back(texture);
+            }
+            else {
+                resourceManager.release(texture);
             }
         }
 
@@ -235,8 +451,11 @@ namespace runa::runtime::models
         vertices.reserve(positions.size());
         for (size_t i = 0; i < positions.size(); i++)
         {
+            // Normals and coordinates are optional in glTF
+            glm::vec3 normal = i < normals.size() ? normals[i] : glm::vec3(0.0f, 1.0f, 0.0f);
+            glm::vec2 texCoord = i < texCoords.size() ? texCoords[i] : glm::vec2(0.0f, 0.0f);
             vertices.push_back(
-                opengl::Vertex{ positions[i], normals[i], glm::vec3(1.0f, 1.0f, 1.0f), texCoords[i] }
+                opengl::Vertex{ positions[i], normal, glm::vec3(1.0f, 1.0f, 1.0f), texCoord }
             );
         }
 
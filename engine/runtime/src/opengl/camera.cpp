@@ -16,10 +16,18 @@ namespace runa::runtime::opengl {
 
     void Camera::updateMatrix(float FOVdeg, float nearPlane, float farPlane)
     {
-        if (!SDL_GetWindowSize(render.getBackend().getWindow(), &width, &height))
+        int windowWidth = 0, windowHeight = 0;
+        if (!SDL_GetWindowSize(render.getBackend().getWindow(), &windowWidth, &windowHeight))
         {
             return;
         }
+        updateMatrix(FOVdeg, nearPlane, farPlane, windowWidth, windowHeight);
+    }
+
+    void Camera::updateMatrix(float FOVdeg, float nearPlane, float farPlane, int viewWidth, int viewHeight)
+    {
+        width = viewWidth;
+        height = viewHeight;
         // Initializes matrices since otherwise they will be the null matrix
         glm::mat4 view = glm::identity<glm::mat4>();
         glm::mat4 projection = glm::identity<glm::mat4>();
@@ -38,48 +46,40 @@ namespace runa::runtime::opengl {
         glUniformMatrix4fv(glGetUniformLocation(shader.getID(), uniform), 1, GL_FALSE, glm::value_ptr(cameraMatrix));
     }
 
-    void Camera::inputs(SDL_Event& event) {
+    void Camera::updateInputs() {
         glm::vec2 vec = input.inputVector(SDL_SCANCODE_D, SDL_SCANCODE_A, SDL_SCANCODE_W, SDL_SCANCODE_S);
         direction = glm::normalize(glm::cross(orientation, up)) * vec.x + glm::normalize(orientation) * vec.y;
 
         float y_axis = input.inputAxis(SDL_SCANCODE_SPACE, SDL_SCANCODE_LCTRL);
         direction.y = y_axis;
-        speed = input.keyPressed(SDL_SCANCODE_LSHIFT) ? 8.0f : 4.0f;
-
-        if (input.mouseButtonPressed(SDL_BUTTON_RIGHT))
-        {
-            SDL_SetWindowMouseGrab(render.getBackend().getWindow(), true);
-            SDL_SetWindowRelativeMouseMode(render.getBackend().getWindow(), true);
-            SDL_HideCursor();
-            
-
-            if (event.type == SDL_EVENT_MOUSE_MOTION)
-            {
-
-                int xrel = event.motion.xrel;
-                int yrel = event.motion.yrel;
+        speed = input.keyHeld(SDL_SCANCODE_LSHIFT) ? 8.0f : 4.0f;
+
+        // Only on change, these round trip to the window system
+        bool grab = input.mouseButtonHeld(SDL_BUTTON_RIGHT);
+        if (grab == grabbed) return;
+        grabbed = grab;
+
+        SDL_Window* window = render.getBackend().getWindow();
+        SDL_SetWindowMouseGrab(window, grab);
+        SDL_SetWindowRelativeMouseMode(window, grab);
+        if (grab) SDL_HideCursor();
+        else SDL_ShowCursor();
+    }
 
-                float rotX = sensitivity * (float)yrel / height;
-                float rotY = sensitivity * (float)xrel / width;
+    void Camera::inputs(SDL_Event& event) {
+        if (!grabbed || event.type != SDL_EVENT_MOUSE_MOTION) return;
 
-                glm::vec3 newOrientation = glm::rotate(orientation, glm::radians(-rotX), glm::normalize(glm::cross(orientation, up)));
+        float rotX = sensitivity * event.motion.yrel / height;
+        float rotY = sensitivity * event.motion.xrel / width;
 
-                
-                if (abs(glm::angle(newOrientation, up) - glm::radians(90.0f)) <= glm::radians(85.0f))
-                {
-                    orientation = newOrientation;
-                }
-                
+        glm::vec3 newOrientation = glm::rotate(orientation, glm::radians(-rotX), glm::normalize(glm::cross(orientation, up)));
 
-                orientation = glm::rotate(orientation, glm::radians(-rotY), up);
-            }
-        }
-        else
+        if (abs(glm::angle(newOrientation, up) - glm::radians(90.0f)) <= glm::radians(85.0f))
         {
-            SDL_SetWindowMouseGrab(render.getBackend().getWindow(), false);
-            SDL_SetWindowRelativeMouseMode(render.getBackend().getWindow(), false);
-            SDL_ShowCursor();
+            orientation = newOrientation;
         }
+
+        orientation = glm::rotate(orientation, glm::radians(-rotY), up);
     }
 
     void Camera::tick(float delta) {
@@ -0,0 +1,109 @@
+#include "opengl/command_buffer.h"
+#include "memory/frame_arena.h"
+#include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace runa::runtime::opengl
+{
+    void CommandBuffer::clear(const glm::vec4& color)
+    {
+        record([color]() {
+            glClearColor(color.x, color.y, color.z, color.w);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        });
+    }
+
+    void CommandBuffer::viewport(int x, int y, int width, int height)
+    {
+        record([x, y, width, height]() { glViewport(x, y, width, height); });
+    }
+
+    void CommandBuffer::drawMesh(Mesh& mesh, const Shader& shader, const Camera& camera)
+    {
+        struct DrawMesh
+        {
+            Mesh* mesh;
+            const Shader* shader;
+            glm::vec3 camPos;
+            glm::mat4 camMatrix;
+            Texture* textures[Mesh::maxTextures];
+            size_t count;
+
+            void operator()() const { mesh->draw(*shader, camPos, camMatrix, textures, count); }
+        };
+
+        DrawMesh command{ &mesh, &shader, camera.pos, camera.cameraMatrix, {}, 0 };
+        command.count = mesh.resolveTextures(command.textures, Mesh::maxTextures);
+        record(command);
+    }
+
+    void CommandBuffer::drawMesh(Mesh& mesh, const Shader& shader, const Camera& camera, const glm::mat4& model)
+    {
+        const Shader* target = &shader;
+        record([target, model]() {
+            target->use();
+            glUniformMatrix4fv(glGetUniformLocation(target->getID(), "model"), 1, GL_FALSE, glm::value_ptr(model));
+        });
+        drawMesh(mesh, shader, camera);
+    }
+
+    void CommandBuffer::updateVertices(Mesh& mesh, const glm::vec3* positions, const glm::vec3* normals, size_t count)
+    {
+        struct UpdateVertices
+        {
+            Mesh* mesh;
+            // Frame arena memory, outlives the packet drawing it
+            const Vertex* vertices;
+            size_t count;
+
+            void operator()() const { mesh->updateVertices(vertices, count); }
+        };
+
+        if (!mesh.isDynamic()) return;
+        const std::vector<Vertex>& source = mesh.getVertices();
+        if (count > source.size()) count = source.size();
+        if (count == 0) return;
+
+        Vertex* vertices = frameArenas.current().allocateArray<Vertex>(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            vertices[i] = source[i];
+            vertices[i].position = positions[i];
+            if (normals) vertices[i].normal = normals[i];
+        }
+        record(UpdateVertices{ &mesh, vertices, count });
+    }
+
+    void CommandBuffer::execute() const
+    {
+        size_t offset = 0;
+        while (offset < used)
+        {
+            auto* header = reinterpret_cast<const Header*>(&blocks[offset]);
+            header->execute(header + 1);
+            offset += header->blocks;
+        }
+    }
+
+    void CommandBuffer::reset()
+    {
+        used = 0;
+        count = 0;
+    }
+
+    CommandBuffer::Header* CommandBuffer::allocate(size_t payload)
+    {
+        static_assert(sizeof(Header) == sizeof(Block));
+        uint32_t size = (uint32_t)(1 + (payload + sizeof(Block) - 1) / sizeof(Block));
+        if (used + size > blocks.size())
+        {
+            // Grows while the first frames are recorded, then the capacity is reused
+            blocks.resize((used + size) * 2);
+        }
+
+        auto* header = new (&blocks[used]) Header{ nullptr, size };
+        used += size;
+        count++;
+        return header;
+    }
+}
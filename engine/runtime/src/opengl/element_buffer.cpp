@@ -1,4 +1,5 @@
 #include "opengl/element_buffer.h"
+#include "opengl/gpu_memory.h"
 
 namespace runa::runtime::opengl {
     ElementBuffer::~ElementBuffer() {
@@ -10,11 +11,14 @@ namespace runa::runtime::opengl {
         glGenBuffers(1, &id);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), indices, GL_STATIC_DRAW);
-        size = count;
+        // In bytes, count() divides it back
+        size = count * sizeof(GLuint);
+        gpuMemory.track(bufferObject, id, indexMemory, (size_t)size);
     }
 
     void ElementBuffer::deinit()
     {
+        gpuMemory.untrack(bufferObject, id);
         glDeleteBuffers(1, &id);
         id = 0;
         size = 0;
@@ -0,0 +1,164 @@
+#include "opengl/gpu_memory.h"
+#include <algorithm>
+
+namespace runa::runtime::opengl {
+    namespace
+    {
+        constexpr uint8_t totalIndex = GpuMemoryStats::categories;
+
+        void subtract(GpuMemoryStats& stats, const GpuAllocation& allocation)
+        {
+            stats.bytes[allocation.category] -= allocation.bytes;
+            stats.count[allocation.category]--;
+            stats.total -= allocation.bytes;
+        }
+    }
+
+    void GpuMemory::track(EGpuObject object, GLuint id, EGpuMemoryCategory category, size_t bytes, const char* owner)
+    {
+        if (id == 0) return;
+
+        struct Exceeded
+        {
+            uint8_t category;
+            size_t bytes;
+            size_t budget;
+        };
+        Exceeded exceeded[2];
+        size_t exceededCount = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // New storage for an object already tracked replaces the old one
+            GpuAllocation& allocation = allocations[key(object, id)];
+            if (allocation.id != 0) subtract(stats, allocation);
+
+            allocation.object = object;
+            allocation.id = id;
+            allocation.category = category;
+            allocation.bytes = bytes;
+            allocation.owner = owner ? owner : "";
+
+            stats.bytes[category] += bytes;
+            stats.count[category]++;
+            stats.total += bytes;
+            stats.peak[category] = std::max(stats.peak[category], stats.bytes[category]);
+            stats.totalPeak = std::max(stats.totalPeak, stats.total);
+
+            size_t budget = stats.budget[category];
+            if (budget > 0 && stats.bytes[category] > budget && !over[category])
+            {
+                over[category] = true;
+                exceeded[exceededCount++] = { category, stats.bytes[category], budget };
+            }
+            if (stats.totalBudget > 0 && stats.total > stats.totalBudget && !over[totalIndex])
+            {
+                over[totalIndex] = true;
+                exceeded[exceededCount++] = { totalIndex, stats.total, stats.totalBudget };
+            }
+        }
+
+        // The callback may free or query, which takes the lock again
+        for (size_t i = 0; i < exceededCount && onBudgetExceeded; i++)
+        {
+            onBudgetExceeded(exceeded[i].category, exceeded[i].bytes, exceeded[i].budget);
+        }
+    }
+
+    void GpuMemory::untrack(EGpuObject object, GLuint id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = allocations.find(key(object, id));
+        if (it == allocations.end()) return;
+
+        EGpuMemoryCategory category = it->second.category;
+        subtract(stats, it->second);
+        allocations.erase(it);
+
+        if (stats.bytes[category] <= stats.budget[category]) over[category] = false;
+        if (stats.total <= stats.totalBudget) over[totalIndex] = false;
+    }
+
+    void GpuMemory::setBudget(EGpuMemoryCategory category, size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.budget[category] = bytes;
+        over[category] = bytes > 0 && stats.bytes[category] > bytes;
+    }
+
+    void GpuMemory::setTotalBudget(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.totalBudget = bytes;
+        over[totalIndex] = bytes > 0 && stats.total > bytes;
+    }
+
+    GpuMemoryStats GpuMemory::getStats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    void GpuMemory::getAllocations(std::vector<GpuAllocation>& out, size_t max)
+    {
+        out.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            out.reserve(allocations.size());
+            for (const auto& [id, allocation] : allocations) out.push_back(allocation);
+        }
+
+        size_t count = std::min(max, out.size());
+        std::partial_sort(out.begin(), out.begin() + count, out.end(),
+            [](const GpuAllocation& a, const GpuAllocation& b) { return a.bytes > b.bytes; });
+        out.resize(count);
+    }
+
+    size_t GpuMemory::textureBytes(GLenum internalFormat, int width, int height, bool mipmaps)
+    {
+        size_t texel;
+        switch (internalFormat)
+        {
+        case GL_RED:
+        case GL_R8:
+        case GL_ALPHA:
+            texel = 1;
+            break;
+        case GL_RG:
+        case GL_RG8:
+        case GL_R16F:
+            texel = 2;
+            break;
+        case GL_RGBA16F:
+        case GL_RGB16F:
+        case GL_RG32F:
+            texel = 8;
+            break;
+        case GL_RGBA32F:
+        case GL_RGB32F:
+            texel = 16;
+            break;
+        default:
+            // RGB8 included, drivers store it padded to four bytes
+            texel = 4;
+            break;
+        }
+
+        size_t bytes = (size_t)width * (size_t)height * texel;
+        // A full mip chain adds a third
+        return mipmaps ? bytes + bytes / 3 : bytes;
+    }
+
+    const char* GpuMemory::categoryName(EGpuMemoryCategory category)
+    {
+        switch (category)
+        {
+        case vertexMemory: return "Vertex buffers";
+        case indexMemory: return "Index buffers";
+        case textureMemory: return "Textures";
+        case targetMemory: return "Render targets";
+        default: return "Other";
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#include "opengl/gpu_profiler.h"
+#include "utils/profiler.h"
+#include <SDL3/SDL.h>
+
+namespace runa::runtime::opengl {
+    GpuProfiler::~GpuProfiler()
+    {
+        deinit();
+    }
+
+    bool GpuProfiler::init()
+    {
+        if (supported) return true;
+
+        // Core since 3.3, only an extension on GLES
+        if (!glQueryCounter || !glGetQueryObjectui64v || !glGetInteger64v) return false;
+
+        for (Frame& frame : frames)
+        {
+            glGenQueries(maxZones * 2, frame.queries);
+            frame.count = 0;
+            frame.pending = false;
+        }
+        current = 0;
+        depth = 0;
+        supported = true;
+        return true;
+    }
+
+    void GpuProfiler::deinit()
+    {
+        if (!supported) return;
+
+        for (Frame& frame : frames)
+        {
+            glDeleteQueries(maxZones * 2, frame.queries);
+            frame.pending = false;
+        }
+        supported = false;
+        active = false;
+    }
+
+    void GpuProfiler::beginFrame()
+    {
+        if (!supported) return;
+
+        current = (current + 1) % framesInFlight;
+        depth = 0;
+
+        Frame& frame = frames[current];
+        if (frame.pending) resolve(frame);
+        frame.pending = false;
+        frame.count = 0;
+
+        active = profiler.isEnabled();
+        if (!active) return;
+
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        frame.offsetNS = (int64_t)SDL_GetTicksNS() - gpuNow;
+        frame.pending = true;
+    }
+
+    void GpuProfiler::begin(const char* name)
+    {
+        if (!active) return;
+
+        Frame& frame = frames[current];
+        // Past the limits zones are skipped, end() still has to balance them
+        if (depth < maxDepth)
+        {
+            open[depth] = frame.count < maxZones ? frame.count : UINT32_MAX;
+            if (frame.count < maxZones)
+            {
+                frame.zones[frame.count] = { name, depth, false };
+                glQueryCounter(frame.queries[frame.count * 2], GL_TIMESTAMP);
+                frame.count++;
+            }
+        }
+        depth++;
+    }
+
+    void GpuProfiler::end()
+    {
+        if (!active || depth == 0) return;
+
+        depth--;
+        if (depth >= maxDepth || open[depth] == UINT32_MAX) return;
+
+        Frame& frame = frames[current];
+        uint32_t zone = open[depth];
+        glQueryCounter(frame.queries[zone * 2 + 1], GL_TIMESTAMP);
+        frame.zones[zone].closed = true;
+    }
+
+    void GpuProfiler::resolve(Frame& frame)
+    {
+        // Zones left open are never resolved, and a frame still in flight this late is dropped
+        // rather than waited on
+        for (uint32_t i = 0; i < frame.count; i++)
+        {
+            if (!frame.zones[i].closed) return;
+            GLint available = 0;
+            glGetQueryObjectiv(frame.queries[i * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) return;
+        }
+
+        for (uint32_t i = 0; i < frame.count; i++)
+        {
+            GLuint64 start = 0, end = 0;
+            glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+            profiler.recordGpu(frame.zones[i].name, (uint64_t)((int64_t)start + frame.offsetNS),
+                (uint64_t)((int64_t)end + frame.offsetNS), frame.zones[i].depth);
+        }
+    }
+}
@@ -1,5 +1,5 @@
 #include "opengl/mesh.h"
-
+#include "runtime.h"
 #include "utils/logs.h"
 
 namespace runa::runtime::opengl
@@ -9,19 +9,22 @@ namespace runa::runtime::opengl
         deinit();
     }
 
-    bool Mesh::init(std::vector<Vertex>& vertices, std::vector<GLuint>& indices, std::vector<Texture>& textures)
+    bool Mesh::init(std::vector<Vertex>& vertices, std::vector<GLuint>& indices, std::vector<resources::Handle<Texture>>& textures, bool dynamic)
     {
         this->vertices = vertices;
         this->indices = indices;
         this->textures = textures;
+        this->dynamic = dynamic;
+        for (const resources::Handle<Texture>& t : textures)
+        {
+            resourceManager.retain(t);
+        }
 
         vao.init();
         vao.bind();
         // Generates Vertex Buffer Object and links it to vertices
-        VertexBuffer vbo;
-        vbo.init(vertices.data(), vertices.size());
+        vbo.init(vertices.data(), vertices.size(), dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
         // Generates Element Buffer Object and links it to indices
-        ElementBuffer ebo;
         ebo.init(indices.data(), indices.size());
         // Links VBO attributes such as coordinates and colors to VAO
         vao.enableAttrib(vbo, 0, 3, GL_FLOAT, sizeof(Vertex), (void*)0);
@@ -44,10 +47,8 @@ namespace runa::runtime::opengl
         vao.init();
         vao.bind();
         // Generates Vertex Buffer Object and links it to vertices
-        VertexBuffer vbo;
         vbo.init(vertices.data(), vertices.size());
         // Generates Element Buffer Object and links it to indices
-        ElementBuffer ebo;
         ebo.init(indices.data(), indices.size());
         // Links VBO attributes such as coordinates and colors to VAO
         vao.enableAttrib(vbo, 0, 3, GL_FLOAT, sizeof(Vertex), (void*)0);
@@ -65,16 +66,43 @@ namespace runa::runtime::opengl
     void Mesh::deinit()
     {
         vao.deinit();
+        vbo.deinit();
+        ebo.deinit();
         vertices.clear();
         indices.clear();
-        for (Texture& t : textures)
+        for (const resources::Handle<Texture>& t : textures)
         {
-            t.denit();
+            resourceManager.release(t);
         }
         textures.clear();
+        dynamic = false;
+    }
+
+    void Mesh::updateVertices(const Vertex* updated, size_t count)
+    {
+        if (!dynamic) return;
+        vbo.update(updated, count < vertices.size() ? count : vertices.size());
     }
 
     void Mesh::draw(const Shader& shader, const Camera& camera)
+    {
+        Texture* resolved[maxTextures];
+        size_t count = resolveTextures(resolved, maxTextures);
+        draw(shader, camera.pos, camera.cameraMatrix, resolved, count);
+    }
+
+    size_t Mesh::resolveTextures(Texture** out, size_t max) const
+    {
+        size_t count = textures.size() < max ? textures.size() : max;
+        for (size_t i = 0; i < count; i++)
+        {
+            // Still loading or failed, draw without it
+            out[i] = resourceManager.get(textures[i]);
+        }
+        return count;
+    }
+
+    void Mesh::draw(const Shader& shader, const glm::vec3& camPos, const glm::mat4& camMatrix, Texture* const* resolved, size_t count)
     {
         // Bind shader to be able to access uniforms
         shader.use();
@@ -84,9 +112,12 @@ namespace runa::runtime::opengl
         unsigned int numDiffuse = 0;
         unsigned int numSpecular = 0;
 
-        for (unsigned int i = 0; i < textures.size(); i++)
+        for (unsigned int i = 0; i < count; i++)
         {
-            const char* type = textures[i].getType();
+            Texture* texture = resolved[i];
+            if (!texture) continue;
+
+            const char* type = texture->getType();
             char uniform[128];
             if (SDL_strcmp(type, "diffuse") == 0)
             {
@@ -106,12 +137,13 @@ namespace runa::runtime::opengl
                     continue;
                 }
             }
-            textures[i].texUnit(shader, uniform, i);
-            textures[i].bind();
+            texture->texUnit(shader, uniform, i);
+            // Shared textures may have been created for another unit
+            texture->bind(i);
         }
         // Take care of the camera Matrix
-        glUniform3f(glGetUniformLocation(shader.getID(), "camPos"), camera.pos.x, camera.pos.y, camera.pos.z);
-        camera.matrix(shader, "camMatrix");
+        glUniform3f(glGetUniformLocation(shader.getID(), "camPos"), camPos.x, camPos.y, camPos.z);
+        glUniformMatrix4fv(glGetUniformLocation(shader.getID(), "camMatrix"), 1, GL_FALSE, glm::value_ptr(camMatrix));
 
         // Draw the actual mesh
         glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
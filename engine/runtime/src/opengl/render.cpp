@@ -1,11 +1,15 @@
 #include "opengl/render.h"
 #include "runtime.h"
 #include "utils/logs.h"
+#include "utils/profiler.h"
+#include "utils/hash.h"
+#include "utils/system.h"
 #include "settings.h"
 #include "input.h"
 #include <imgui_impl_sdl3.h>
 #include <imgui_impl_opengl3.h>
 #include <glad/glad.h>
+#include <algorithm>
 
 namespace runa::runtime::opengl {
     Backend::~Backend()
@@ -21,6 +25,13 @@ namespace runa::runtime::opengl {
             return false;
         }
 
+        driverType = driver;
+        if (driver == headless)
+        {
+            // Must be set before the video subsystem starts
+            SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        }
+
         if (!SDL_InitSubSystem(SDL_INIT_VIDEO))
         {
             utils::Logs::sdlError();
@@ -65,13 +76,33 @@ namespace runa::runtime::opengl {
             }
             glslVersion = "#version 460";
             break;
+        case headless:
+            if (!SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE))
+            {
+                utils::Logs::sdlError();
+                return false;
+            }
+            // Highest core version llvmpipe reliably exposes
+            if (!SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4))
+            {
+                utils::Logs::sdlError();
+                return false;
+            }
+            if (!SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5))
+            {
+                utils::Logs::sdlError();
+                return false;
+            }
+            glslVersion = "#version 450";
+            break;
         default:
             SDL_Quit();
             return 1;
         }
 
         // Create a SDL window
-        windowPtr = SDL_CreateWindow("Runa", 1024, 576, SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL);
+        SDL_WindowFlags flags = driver == headless ? SDL_WINDOW_HIDDEN | SDL_WINDOW_OPENGL : SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL;
+        windowPtr = SDL_CreateWindow("Runa", 1024, 576, flags);
         if (!windowPtr) {
             utils::Logs::sdlError();
             SDL_Quit();
@@ -173,6 +204,153 @@ namespace runa::runtime::opengl {
         return io;
     }
 
+    void ImGuiBackend::drawProfiler()
+    {
+        if (!initialized) return;
+        if (!ImGui::Begin("Profiler"))
+        {
+            ImGui::End();
+            return;
+        }
+
+        bool enabled = profiler.isEnabled();
+        if (ImGui::Checkbox("Record", &enabled)) profiler.setEnabled(enabled);
+        ImGui::SameLine();
+        ImGui::Checkbox("Pause", &profilePaused);
+        ImGui::SameLine();
+        if (ImGui::Button("Export trace"))
+        {
+            std::string path = utils::joinPaths({ utils::baseDir(), "trace.json" });
+            if (profiler.exportChromeTrace(path.c_str())) utils::Logs::success("Trace written to %s", path.c_str());
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120.0f);
+        // The render thread runs a frame behind and GPU results come back a few frames late
+        ImGui::SliderInt("Frames", &profileFrames, 1, 16);
+#if !defined(ENGINE_PROFILER)
+        ImGui::TextDisabled("Built without ENGINE_PROFILER, only GPU zones are recorded");
+#endif
+
+        if (!profilePaused && !profiler.lastFrames((uint32_t)profileFrames, profileStartNS, profileEndNS))
+        {
+            ImGui::End();
+            return;
+        }
+        if (!profilePaused) profiler.collect(profileStartNS, profileEndNS, profileTracks);
+        ImGui::Text("%.3f ms", (profileEndNS - profileStartNS) / 1e6);
+
+        ImDrawList* draw = ImGui::GetWindowDrawList();
+        float width = ImGui::GetContentRegionAvail().x;
+        float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+        double scale = width / (double)(profileEndNS - profileStartNS);
+
+        for (const utils::ProfileTrack& track : profileTracks)
+        {
+            if (track.events.empty()) continue;
+
+            uint32_t rows = 1;
+            for (const utils::ProfileEvent& event : track.events) rows = std::max(rows, event.depth + 1);
+
+            ImGui::TextUnformatted(track.name.c_str());
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            ImGui::PushID((int)track.id);
+            ImGui::InvisibleButton("track", ImVec2(width, rowHeight * rows));
+            ImGui::PopID();
+
+            for (const utils::ProfileEvent& event : track.events)
+            {
+                uint64_t start = std::max(event.startNS, profileStartNS);
+                uint64_t end = std::min(event.endNS, profileEndNS);
+                ImVec2 min(origin.x + (float)((start - profileStartNS) * scale), origin.y + event.depth * rowHeight);
+                ImVec2 max(std::max(min.x + 1.0f, origin.x + (float)((end - profileStartNS) * scale)), min.y + rowHeight - 1.0f);
+
+                // Same zone, same color in every frame
+                float hue = (utils::hash(event.name) % 360) / 360.0f;
+                draw->AddRectFilled(min, max, ImColor::HSV(hue, 0.5f, 0.65f));
+                if (max.x - min.x > 8.0f)
+                {
+                    draw->PushClipRect(min, max, true);
+                    draw->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32_WHITE, event.name);
+                    draw->PopClipRect();
+                }
+                if (ImGui::IsMouseHoveringRect(min, max))
+                {
+                    ImGui::SetTooltip("%s\n%.3f ms", event.name, (event.endNS - event.startNS) / 1e6);
+                }
+            }
+        }
+
+        ImGui::End();
+    }
+
+    void ImGuiBackend::drawGpuMemory()
+    {
+        if (!initialized) return;
+        if (!ImGui::Begin("GPU memory"))
+        {
+            ImGui::End();
+            return;
+        }
+
+        constexpr double megabyte = 1024.0 * 1024.0;
+        GpuMemoryStats stats = gpuMemory.getStats();
+        if (ImGui::BeginTable("categories", 5))
+        {
+            ImGui::TableSetupColumn("Category");
+            ImGui::TableSetupColumn("Objects");
+            ImGui::TableSetupColumn("MB");
+            ImGui::TableSetupColumn("Peak MB");
+            ImGui::TableSetupColumn("Budget");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i <= GpuMemoryStats::categories; i++)
+            {
+                bool total = i == GpuMemoryStats::categories;
+                size_t bytes = total ? stats.total : stats.bytes[i];
+                size_t peak = total ? stats.totalPeak : stats.peak[i];
+                size_t budget = total ? stats.totalBudget : stats.budget[i];
+                size_t count = 0;
+                if (total) for (size_t c = 0; c < GpuMemoryStats::categories; c++) count += stats.count[c];
+                else count = stats.count[i];
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(total ? "Total" : GpuMemory::categoryName((EGpuMemoryCategory)i));
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", count);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", bytes / megabyte);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", peak / megabyte);
+                ImGui::TableNextColumn();
+                if (budget > 0)
+                {
+                    char overlay[32];
+                    SDL_snprintf(overlay, sizeof(overlay), "%.0f MB", budget / megabyte);
+                    ImGui::ProgressBar((float)bytes / (float)budget, ImVec2(-1.0f, 0.0f), overlay);
+                }
+                else
+                {
+                    ImGui::TextUnformatted("-");
+                }
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::CollapsingHeader("Largest allocations"))
+        {
+            gpuMemory.getAllocations(gpuAllocations, 64);
+            for (const GpuAllocation& allocation : gpuAllocations)
+            {
+                ImGui::Text("%8.2f MB  %-14s %s #%u", allocation.bytes / megabyte,
+                    GpuMemory::categoryName(allocation.category),
+                    allocation.owner.empty() ? "" : allocation.owner.c_str(), allocation.id);
+            }
+        }
+
+        ImGui::End();
+    }
+
     Render::~Render()
     {
 
@@ -181,22 +359,159 @@ namespace runa::runtime::opengl {
     bool Render::init(EDriver driver, bool useImgui) {
         if (!backend.init(driver)) return false;
         if (useImgui) imguiBackend.init(backend);
+        profiler.setThreadName("Main");
+        if (!gpuProfiler.init()) utils::Logs::log("GPU timestamp queries unavailable, GPU profiling disabled");
+
+        // Settings keep their own copy, the driver is not asked again every frame
+        int interval = 0;
+        if (SDL_GL_GetSwapInterval(&interval)) gameUserSettings.resetVsync((EVSync)interval);
 
         return true;
     }
 
     void Render::deinit() {
+        // The context has to be back on this thread before anything is destroyed
+        renderThread.deinit();
+        mode = immediate;
+        target.deinit();
+        gpuProfiler.deinit();
         imguiBackend.deinit();
         backend.deinit();
     }
 
+    bool Render::setMode(ERenderMode renderMode) {
+        if (renderMode == mode) return true;
+
+        if (renderMode == threaded)
+        {
+            if (!renderThread.init(backend, &gpuProfiler)) return false;
+        }
+        else
+        {
+            renderThread.deinit();
+        }
+        mode = renderMode;
+        return true;
+    }
+
+    RenderStats Render::getStats() {
+        RenderStats result = stats;
+        if (mode == threaded) renderThread.getStats(result);
+        return result;
+    }
+
+    void Render::record(CommandBuffer& buffer) {
+        RUNA_PROFILE_ZONE("Render::record");
+        buffer.reset();
+
+        // Resizes are picked up here instead of in every game's event handler
+        int width = 0, height = 0;
+        if (SDL_GetWindowSizeInPixels(backend.getWindow(), &width, &height) && (width != viewportWidth || height != viewportHeight))
+        {
+            viewportWidth = width;
+            viewportHeight = height;
+            buffer.viewport(0, 0, width, height);
+        }
+
+        EVSync vsync;
+        if (gameUserSettings.takeVsyncChange(vsync))
+        {
+            buffer.record([vsync]() {
+                if (!SDL_GL_SetSwapInterval((int)vsync)) utils::Logs::sdlError();
+            });
+        }
+
+        bool offscreen = backend.isHeadless() || !dumpDirectory.empty() || !capturePath.empty();
+        if (offscreen)
+        {
+            buffer.record([this, width = viewportWidth, height = viewportHeight]() {
+                if (target.resize(width, height)) target.bind();
+            });
+        }
+
+        // Render behind imgui
+        buffer.clear(glm::vec4(0.07f, 0.13f, 0.17f, 1.0f));
+        if (onRecord) onRecord(tick.delta(), buffer);
+
+        if (offscreen) recordTargetEnd(buffer);
+    }
+
+    void Render::recordTargetEnd(CommandBuffer& buffer) {
+        struct TargetEnd
+        {
+            Render* render;
+            bool present;
+            // Frame arena memory, outlives the packet drawing it
+            const char* path;
+
+            void operator()() const {
+                RenderTarget& target = render->target;
+                if (!target.isValid()) return;
+                if (path) target.savePNG(path);
+                // Windowed runs dumping frames still show them, ImGui then draws on top
+                if (present) target.blit(0, target.getWidth(), target.getHeight());
+                else target.unbind();
+            }
+        };
+
+        TargetEnd command{ this, !backend.isHeadless(), nullptr };
+        if (!capturePath.empty())
+        {
+            command.path = frameArenas.copyString(capturePath);
+            capturePath.clear();
+        }
+        else if (!dumpDirectory.empty())
+        {
+            // Directory, separator, frame_ and 20 digits of frame number
+            size_t size = dumpDirectory.size() + 40;
+            char* path = frameArenas.current().allocateArray<char>(size);
+            SDL_snprintf(path, size, "%s/frame_%06llu.png", dumpDirectory.c_str(), (unsigned long long)frames);
+            command.path = path;
+        }
+        buffer.record(command);
+    }
+
+    void Render::dumpFrames(const char* directory) {
+        dumpDirectory = directory ? directory : "";
+    }
+
+    void Render::captureFrame(const char* path) {
+        capturePath = path ? path : "";
+    }
+
     void Render::poll() {
-        bool should_limit = gameUserSettings.getFramerateLimit() > 0 && gameUserSettings.getVsync() == disable;
-        uint64_t frame_time = 0;
-        if (should_limit) {
-            frame_time = 1000000000 / gameUserSettings.getFramerateLimit();
+        profiler.frame();
+        frameArenas.beginFrame();
+        allocationTracker.frame();
+        RUNA_PROFILE_ZONE("Render::poll");
+        RUNA_ALLOCATION_TAG(memory::renderTag);
+
+        // Vsync paces presents on its own
+        uint16_t limit = gameUserSettings.getFramerateLimit();
+        bool should_limit = limit > 0 && gameUserSettings.getVsync() == disable;
+        pacer.setTarget(should_limit ? 1000000000 / limit : 0);
+        {
+            RUNA_PROFILE_ZONE("Pacing");
+            pacer.wait();
         }
 
+        uint64_t now = SDL_GetTicksNS();
+        if (lastPollNS > 0) stats.frameNS = now - lastPollNS;
+        lastPollNS = now;
+
+        if (mode == threaded) pollThreaded();
+        else pollImmediate();
+        stats.frames = ++frames;
+
+        now = SDL_GetTicksNS();
+        pacer.endFrame(now);
+        // Immediate mode just swapped, threaded mode reports the last present of the render thread
+        pacer.presented(mode == threaded ? renderThread.getLastPresentNS() : now);
+    }
+
+    void Render::pollImmediate() {
+        uint64_t start = SDL_GetTicksNS();
+
         // Render imgui
         if (imguiBackend.isInitialized()) {
             ImGui_ImplOpenGL3_NewFrame();
@@ -204,24 +519,62 @@ namespace runa::runtime::opengl {
             ImGui::NewFrame();
         }
 
-        // Render behind imgui
-        glClearColor(0.07f, 0.13f, 0.17f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        if (onRender) onRender(tick.delta());
+        record(commands);
+        gpuProfiler.beginFrame();
+        {
+            RUNA_PROFILE_ZONE("Commands");
+            gpuProfiler.begin("Scene");
+            commands.execute();
+            if (onRender) onRender(tick.delta());
+            gpuProfiler.end();
+        }
 
         if (imguiBackend.isInitialized()) {
+            RUNA_PROFILE_ZONE("ImGui");
             if (onImGuiRender) onImGuiRender(ImGui::GetIO());
             ImGui::Render();
+            gpuProfiler.begin("ImGui");
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            gpuProfiler.end();
         }
 
-        SDL_GL_SwapWindow(backend.getWindow());
-        // Finish render
-        if (should_limit) {
-            if (frame_time > 0 && frame_time > tick.elapsedNS()) {
-                SDL_DelayPrecise(frame_time - tick.elapsedNS());
-            }
+        {
+            RUNA_PROFILE_ZONE("Present");
+            pacer.waitPresent();
+            SDL_GL_SwapWindow(backend.getWindow());
         }
+
+        stats.recordNS = SDL_GetTicksNS() - start;
+        stats.executeNS = stats.recordNS;
+        stats.latencyNS = 0;
+        stats.waitNS = 0;
+        stats.commands = commands.getCount();
     }
-}
 
+    void Render::pollThreaded() {
+        uint64_t start = SDL_GetTicksNS();
+        FramePacket& packet = renderThread.acquire();
+        packet.frame = frames;
+        packet.imgui = nullptr;
+
+        // Overlaps with the render thread drawing the previous packet
+        record(packet.commands);
+
+        uint64_t waited = 0;
+        if (imguiBackend.isInitialized()) {
+            // ImGui reuses its draw buffers on NewFrame
+            waited = renderThread.waitImGui();
+            RUNA_PROFILE_ZONE("ImGui");
+            ImGui_ImplSDL3_NewFrame();
+            ImGui::NewFrame();
+            if (onImGuiRender) onImGuiRender(ImGui::GetIO());
+            ImGui::Render();
+            packet.imgui = ImGui::GetDrawData();
+        }
+
+        stats.commands = packet.commands.getCount();
+        stats.recordNS = SDL_GetTicksNS() - start - waited;
+        RUNA_PROFILE_ZONE("Submit");
+        stats.waitNS = waited + renderThread.submit();
+    }
+}
@@ -0,0 +1,132 @@
+#include "opengl/render_target.h"
+#include "opengl/gpu_memory.h"
+#include "utils/logs.h"
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+#include <cstring>
+
+namespace runa::runtime::opengl {
+    RenderTarget::~RenderTarget()
+    {
+        if (framebuffer > 0) deinit();
+    }
+
+    bool RenderTarget::init(int w, int h)
+    {
+        if (w <= 0 || h <= 0) return false;
+        width = w;
+        height = h;
+
+        glGenTextures(1, &color);
+        glBindTexture(GL_TEXTURE_2D, color);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        gpuMemory.track(textureObject, color, targetMemory, GpuMemory::textureBytes(GL_RGBA8, width, height, false), "Render target color");
+
+        glGenRenderbuffers(1, &depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        gpuMemory.track(renderbufferObject, depth, targetMemory, GpuMemory::textureBytes(GL_DEPTH24_STENCIL8, width, height, false), "Render target depth");
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            utils::Logs::error("Render target %dx%d incomplete: 0x%x", width, height, status);
+            deinit();
+            return false;
+        }
+        return true;
+    }
+
+    void RenderTarget::deinit()
+    {
+        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+        gpuMemory.untrack(renderbufferObject, depth);
+        if (depth) glDeleteRenderbuffers(1, &depth);
+        gpuMemory.untrack(textureObject, color);
+        if (color) glDeleteTextures(1, &color);
+        framebuffer = 0;
+        depth = 0;
+        color = 0;
+        width = 0;
+        height = 0;
+    }
+
+    bool RenderTarget::resize(int w, int h)
+    {
+        if (framebuffer && w == width && h == height) return true;
+        deinit();
+        return init(w, h);
+    }
+
+    void RenderTarget::bind() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+
+    void RenderTarget::unbind() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void RenderTarget::blit(GLuint destination, int destinationWidth, int destinationHeight) const
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destination);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, destinationWidth, destinationHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, destination);
+    }
+
+    bool RenderTarget::readPixels(std::vector<uint8_t>& pixels) const
+    {
+        if (!framebuffer) return false;
+
+        size_t pitch = (size_t)width * 4;
+        pixels.resize(pitch * height);
+
+        GLint previous = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)previous);
+
+        // GL rows start at the bottom
+        std::vector<uint8_t> row(pitch);
+        for (int y = 0; y < height / 2; y++)
+        {
+            uint8_t* top = pixels.data() + y * pitch;
+            uint8_t* bottom = pixels.data() + (height - 1 - y) * pitch;
+            std::memcpy(row.data(), top, pitch);
+            std::memcpy(top, bottom, pitch);
+            std::memcpy(bottom, row.data(), pitch);
+        }
+        return true;
+    }
+
+    bool RenderTarget::savePNG(const char* path) const
+    {
+        std::vector<uint8_t> pixels;
+        if (!readPixels(pixels)) return false;
+
+        SDL_Surface* surface = SDL_CreateSurfaceFrom(width, height, SDL_PIXELFORMAT_RGBA32, pixels.data(), width * 4);
+        if (!surface)
+        {
+            utils::Logs::sdlError();
+            return false;
+        }
+        bool saved = IMG_SavePNG(surface, path);
+        if (!saved) utils::Logs::error("Failed to save frame %s: %s", path, SDL_GetError());
+        SDL_DestroySurface(surface);
+        return saved;
+    }
+}
@@ -0,0 +1,203 @@
+#include "opengl/render_thread.h"
+#include "opengl/render.h"
+#include "opengl/gpu_profiler.h"
+#include "utils/logs.h"
+#include "utils/profiler.h"
+#include "memory/allocation_tracker.h"
+#include <imgui_impl_opengl3.h>
+
+namespace runa::runtime::opengl
+{
+    RenderThread::~RenderThread()
+    {
+        deinit();
+    }
+
+    bool RenderThread::init(Backend& owner, GpuProfiler* gpu)
+    {
+        if (running) return false;
+
+        backend = &owner;
+        gpuProfiler = gpu;
+        stopping = false;
+        started = false;
+        contextFailed = false;
+        pending = nullptr;
+        busy = false;
+        imguiDone = true;
+        writeIndex = 0;
+
+        // A context can only be current on one thread
+        if (!SDL_GL_MakeCurrent(backend->getWindow(), nullptr))
+        {
+            utils::Logs::sdlError();
+            return false;
+        }
+
+        int result = thread.create([this]() { loop(); });
+        if (result < 0)
+        {
+            utils::Logs::error("Failed to create render thread: %s", uv_strerror(result));
+            SDL_GL_MakeCurrent(backend->getWindow(), backend->getContext());
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return started; });
+        if (contextFailed)
+        {
+            lock.unlock();
+            thread.join();
+            SDL_GL_MakeCurrent(backend->getWindow(), backend->getContext());
+            return false;
+        }
+
+        running = true;
+        return true;
+    }
+
+    void RenderThread::deinit()
+    {
+        if (!running) return;
+
+        finish();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        thread.join();
+        running = false;
+
+        if (!SDL_GL_MakeCurrent(backend->getWindow(), backend->getContext()))
+        {
+            utils::Logs::sdlError();
+        }
+    }
+
+    FramePacket& RenderThread::acquire()
+    {
+        return packets[writeIndex];
+    }
+
+    uint64_t RenderThread::submit()
+    {
+        FramePacket& packet = packets[writeIndex];
+        uint64_t start = SDL_GetTicksNS();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return !busy && !pending; });
+        uint64_t waited = SDL_GetTicksNS() - start;
+
+        packet.submittedNS = SDL_GetTicksNS();
+        pending = &packet;
+        imguiDone = !packet.imgui;
+        lock.unlock();
+        condition.notify_all();
+
+        writeIndex ^= 1;
+        return waited;
+    }
+
+    uint64_t RenderThread::waitImGui()
+    {
+        uint64_t start = SDL_GetTicksNS();
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return imguiDone; });
+        return SDL_GetTicksNS() - start;
+    }
+
+    void RenderThread::finish()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return !busy && !pending; });
+    }
+
+    void RenderThread::getStats(RenderStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.executeNS = executeNS;
+        stats.latencyNS = latencyNS;
+    }
+
+    uint64_t RenderThread::getLastPresentNS()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lastPresentNS;
+    }
+
+    void RenderThread::loop()
+    {
+        bool current = SDL_GL_MakeCurrent(backend->getWindow(), backend->getContext());
+        if (!current) utils::Logs::sdlError();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            started = true;
+            contextFailed = !current;
+        }
+        condition.notify_all();
+        if (!current) return;
+
+        profiler.setThreadName("Render");
+        RUNA_ALLOCATION_TAG(memory::renderTag);
+
+        for (;;)
+        {
+            FramePacket* packet;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return pending || stopping; });
+                if (!pending) break;
+                packet = pending;
+                pending = nullptr;
+                busy = true;
+            }
+
+            uint64_t start = SDL_GetTicksNS();
+            draw(*packet);
+            uint64_t end = SDL_GetTicksNS();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                executeNS = end - start;
+                latencyNS = end - packet->submittedNS;
+                lastPresentNS = end;
+                busy = false;
+            }
+            condition.notify_all();
+        }
+
+        SDL_GL_MakeCurrent(backend->getWindow(), nullptr);
+    }
+
+    void RenderThread::draw(FramePacket& packet)
+    {
+        RUNA_PROFILE_ZONE("RenderThread::draw");
+        if (gpuProfiler) gpuProfiler->beginFrame();
+
+        {
+            RUNA_PROFILE_ZONE("Commands");
+            if (gpuProfiler) gpuProfiler->begin("Scene");
+            packet.commands.execute();
+            if (gpuProfiler) gpuProfiler->end();
+        }
+
+        if (packet.imgui)
+        {
+            RUNA_PROFILE_ZONE("ImGui");
+            if (gpuProfiler) gpuProfiler->begin("ImGui");
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplOpenGL3_RenderDrawData(packet.imgui);
+            if (gpuProfiler) gpuProfiler->end();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                imguiDone = true;
+            }
+            // The game thread can start its next ImGui frame while we present
+            condition.notify_all();
+        }
+
+        RUNA_PROFILE_ZONE("Swap");
+        SDL_GL_SwapWindow(backend->getWindow());
+    }
+}
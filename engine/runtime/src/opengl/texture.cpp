@@ -1,4 +1,5 @@
 #include "opengl/texture.h"
+#include "opengl/gpu_memory.h"
 #include "utils/logs.h"
 #include <SDL3_image/SDL_image.h>
 
@@ -9,15 +10,23 @@ namespace runa::runtime::opengl {
 
     bool Texture::init(const char* filepath, const char* textype, GLenum slot, GLenum channels, GLenum pixeltype)
     {
-        // Assigns the type of the texture to the texture object
-        type = textype;
-
         SDL_Surface* surf = IMG_Load(filepath);
         if (!surf) {
             utils::Logs::error("Failed to load texture file %s", filepath);
             return false;
         }
 
+        bool result = init(surf, textype, slot, channels, pixeltype, filepath);
+        SDL_DestroySurface(surf);
+
+        return result;
+    }
+
+    bool Texture::init(SDL_Surface* surf, const char* textype, GLenum slot, GLenum channels, GLenum pixeltype, const char* owner)
+    {
+        // Assigns the type of the texture to the texture object
+        type = textype;
+
         const SDL_PixelFormatDetails* details = SDL_GetPixelFormatDetails(surf->format);
         if (!details) {
             utils::Logs::error("Failed to get texture details");
@@ -36,7 +45,7 @@ namespace runa::runtime::opengl {
             break;
         case 3:
             texChannels = GL_RGB;
-            if (internalChannels = 0) {
+            if (internalChannels == 0) {
                 internalChannels = texChannels;
             }
             else if (internalChannels == GL_ALPHA) {
@@ -74,10 +83,9 @@ namespace runa::runtime::opengl {
         glTexImage2D(GL_TEXTURE_2D, 0, internalChannels, surf->w, surf->h, 0, texChannels, pixeltype, surf->pixels);
         // Generates MipMaps
         glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Deletes the image data as it is already in the OpenGL Texture object
-        //stbi_image_free(bytes);
-        SDL_DestroySurface(surf);
+        width = surf->w;
+        height = surf->h;
+        gpuMemory.track(textureObject, id, textureMemory, GpuMemory::textureBytes(internalChannels, width, height, true), owner);
 
         // Unbinds the OpenGL Texture object so that it can't accidentally be modified
         glBindTexture(GL_TEXTURE_2D, 0);
@@ -87,10 +95,13 @@ namespace runa::runtime::opengl {
 
     void Texture::denit()
     {
+        gpuMemory.untrack(textureObject, id);
         glDeleteTextures(1, &id);
         id = 0;
         type = 0;
         unit = 0;
+        width = 0;
+        height = 0;
     }
 
     void Texture::texUnit(const Shader& shader, const char* uniform, GLuint unit)
@@ -108,6 +119,11 @@ namespace runa::runtime::opengl {
         glBindTexture(GL_TEXTURE_2D, id);
     }
 
+    void Texture::bind(GLuint slot) const {
+        glActiveTexture(GL_TEXTURE0 + slot);
+        glBindTexture(GL_TEXTURE_2D, id);
+    }
+
     void Texture::unbind() const {
         glBindTexture(GL_TEXTURE_2D, 0);
     }
@@ -13,6 +13,7 @@ namespace runa::runtime::opengl {
     void VertexArray::deinit()
     {
         glDeleteVertexArrays(1, &id);
+        id = 0;
     }
 
     void VertexArray::bind() const {
@@ -1,4 +1,5 @@
 #include "opengl/vertex_buffer.h"
+#include "opengl/gpu_memory.h"
 
 namespace runa::runtime::opengl {
     VertexBuffer::~VertexBuffer()
@@ -6,19 +7,28 @@ namespace runa::runtime::opengl {
         if (id > 0) deinit();
     }
 
-    void VertexBuffer::init(const Vertex* vertices, GLsizeiptr count)
+    void VertexBuffer::init(const Vertex* vertices, GLsizeiptr count, GLenum usage)
     {
         glGenBuffers(1, &id);
         glBindBuffer(GL_ARRAY_BUFFER, id);
-        glBufferData(GL_ARRAY_BUFFER, count * sizeof(Vertex), vertices, GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(Vertex), vertices, usage);
+        gpuMemory.track(bufferObject, id, vertexMemory, count * sizeof(Vertex));
     }
 
     void VertexBuffer::deinit()
     {
+        gpuMemory.untrack(bufferObject, id);
         glDeleteBuffers(1, &id);
         id = 0;
     }
 
+    void VertexBuffer::update(const Vertex* vertices, GLsizeiptr count)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, id);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Vertex), vertices);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
     void VertexBuffer::bind() const {
         glBindBuffer(GL_ARRAY_BUFFER, id);
     }
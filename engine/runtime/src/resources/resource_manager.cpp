@@ -0,0 +1,234 @@
+#include "resources/resource_manager.h"
+#include "utils/hash.h"
+#include "utils/logs.h"
+#include "utils/profiler.h"
+#include "memory/allocation_tracker.h"
+#include "utils/system.h"
+#include "io/async.h"
+#include <SDL3_image/SDL_image.h>
+
+namespace runa::runtime::resources
+{
+    ResourceManager::~ResourceManager()
+    {
+        deinit();
+    }
+
+    void ResourceManager::deinit()
+    {
+        // IMG_Load cannot be interrupted, the decodes in flight are handed back before their
+        // textures go away. Must not be called from a callback of that loop
+        while (pendingDecodes > 0 && decodeLoop) uv_run(decodeLoop, UV_RUN_ONCE);
+        decodeLoop = nullptr;
+
+        // Meshes release their textures, so they go first
+        meshes.clear();
+        textures.clear();
+    }
+
+    uint64_t ResourceManager::textureKey(const char* filepath)
+    {
+        return utils::hash(utils::normalizePath(filepath));
+    }
+
+    TextureHandle ResourceManager::loadTexture(const char* filepath, const char* textype, GLenum channels, GLenum pixeltype)
+    {
+        uint64_t key = textureKey(filepath);
+        TextureHandle handle = textures.find(key);
+        if (handle.isValid())
+        {
+            textureHits++;
+            return handle;
+        }
+        textureMisses++;
+
+        RUNA_PROFILE_ZONE("ResourceManager::loadTexture");
+        RUNA_ALLOCATION_TAG(memory::resourceTag);
+        handle = textures.create(key);
+        if (!textures.get(handle)->init(filepath, textype, 0, channels, pixeltype))
+        {
+            textures.setState(handle, failed);
+            return handle;
+        }
+        textures.setState(handle, loaded);
+
+        return handle;
+    }
+
+    TextureHandle ResourceManager::loadTexture(uint64_t key, const void* bytes, size_t size, const char* textype, const char* owner, GLenum channels, GLenum pixeltype)
+    {
+        if (key != 0)
+        {
+            TextureHandle handle = textures.find(key);
+            if (handle.isValid())
+            {
+                textureHits++;
+                return handle;
+            }
+        }
+        textureMisses++;
+
+        RUNA_PROFILE_ZONE("ResourceManager::loadTexture");
+        RUNA_ALLOCATION_TAG(memory::resourceTag);
+        TextureHandle handle = textures.create(key);
+        SDL_Surface* surface = IMG_Load_IO(SDL_IOFromConstMem(bytes, size), true);
+        if (!surface)
+        {
+            utils::Logs::error("Failed to decode texture of %s: %s", owner, SDL_GetError());
+            textures.setState(handle, failed);
+            return handle;
+        }
+
+        bool uploaded = textures.get(handle)->init(surface, textype, 0, channels, pixeltype, owner);
+        SDL_DestroySurface(surface);
+        textures.setState(handle, uploaded ? loaded : failed);
+
+        return handle;
+    }
+
+    TextureHandle ResourceManager::loadTextureAsync(uv_loop_t* loop, const char* filepath, const char* textype, GLenum channels, GLenum pixeltype)
+    {
+        uint64_t key = textureKey(filepath);
+        TextureHandle handle = textures.find(key);
+        if (handle.isValid())
+        {
+            textureHits++;
+            return handle;
+        }
+        textureMisses++;
+
+        handle = textures.create(key);
+        textures.setState(handle, loading);
+
+        decodeLoop = loop;
+        pendingDecodes++;
+        decodeTexture(loop, handle, filepath, textype, channels, pixeltype).detach();
+
+        return handle;
+    }
+
+    task_c<void> ResourceManager::decodeTexture(uv_loop_t* loop, TextureHandle handle, std::string path, std::string textype, GLenum channels, GLenum pixeltype)
+    {
+        // Arguments are copied into the frame, deinit waits for pendingDecodes so this outlives nothing
+        std::optional<SDL_Surface*> surface = co_await work(loop, [&path]() {
+            RUNA_PROFILE_ZONE("ResourceManager::decodeTexture");
+            RUNA_ALLOCATION_TAG(memory::resourceTag);
+            return IMG_Load(path.c_str());
+        });
+
+        RUNA_PROFILE_ZONE("ResourceManager::uploadTexture");
+        // Nothing is awaited past this point, the tag is restored on the same thread
+        RUNA_ALLOCATION_TAG(memory::resourceTag);
+        // Back on the loop thread, the texture may have been released while it was decoding
+        opengl::Texture* texture = textures.get(handle);
+        if (texture)
+        {
+            if (!surface || !*surface)
+            {
+                utils::Logs::error("Failed to load texture file %s", path.c_str());
+                textures.setState(handle, failed);
+            }
+            else if (texture->init(*surface, textype.c_str(), 0, channels, pixeltype, path.c_str()))
+            {
+                textures.setState(handle, loaded);
+            }
+            else
+            {
+                textures.setState(handle, failed);
+            }
+        }
+
+        if (surface && *surface) SDL_DestroySurface(*surface);
+        pendingDecodes--;
+    }
+
+    opengl::Texture* ResourceManager::get(TextureHandle handle) const
+    {
+        if (textures.getState(handle) != loaded) return nullptr;
+        return textures.get(handle);
+    }
+
+    EResourceState ResourceManager::getState(TextureHandle handle) const
+    {
+        return textures.getState(handle);
+    }
+
+    void ResourceManager::retain(TextureHandle handle)
+    {
+        textures.addRef(handle);
+    }
+
+    void ResourceManager::release(TextureHandle handle)
+    {
+        textures.release(handle);
+    }
+
+    MeshHandle ResourceManager::createMesh(uint64_t key, std::vector<opengl::Vertex>& vertices, std::vector<GLuint>& indices, std::vector<TextureHandle>& textures, bool dynamic)
+    {
+        if (key != 0)
+        {
+            MeshHandle handle = meshes.find(key);
+            if (handle.isValid())
+            {
+                meshHits++;
+                return handle;
+            }
+        }
+        meshMisses++;
+
+        RUNA_ALLOCATION_TAG(memory::resourceTag);
+        MeshHandle handle = meshes.create(key);
+        if (!meshes.get(handle)->init(vertices, indices, textures, dynamic))
+        {
+            meshes.setState(handle, failed);
+            return handle;
+        }
+        meshes.setState(handle, loaded);
+
+        return handle;
+    }
+
+    MeshHandle ResourceManager::findMesh(uint64_t key)
+    {
+        MeshHandle handle = meshes.find(key);
+        if (handle.isValid()) meshHits++;
+        return handle;
+    }
+
+    opengl::Mesh* ResourceManager::get(MeshHandle handle) const
+    {
+        if (meshes.getState(handle) != loaded) return nullptr;
+        return meshes.get(handle);
+    }
+
+    void ResourceManager::retain(MeshHandle handle)
+    {
+        meshes.addRef(handle);
+    }
+
+    void ResourceManager::release(MeshHandle handle)
+    {
+        meshes.release(handle);
+    }
+
+    ResourceStats ResourceManager::getStats() const
+    {
+        ResourceStats stats;
+        stats.textures = textures.count();
+        textures.forEach([&](const opengl::Texture&, EResourceState state, uint32_t refs) {
+            if (state == loading) stats.texturesLoading++;
+            if (state == failed) stats.texturesFailed++;
+            stats.textureRefs += refs;
+        });
+        stats.meshes = meshes.count();
+        meshes.forEach([&](const opengl::Mesh&, EResourceState, uint32_t refs) {
+            stats.meshRefs += refs;
+        });
+        stats.textureHits = textureHits;
+        stats.textureMisses = textureMisses;
+        stats.meshHits = meshHits;
+        stats.meshMisses = meshMisses;
+
+        return stats;
+    }
+}
@@ -2,9 +2,17 @@
 
 namespace runa::runtime
 {
+    // First, every other global may still record zones while it is destroyed
+    utils::Profiler profiler;
+    // Before anything that may allocate frame memory while it is destroyed
+    memory::FrameArenas frameArenas;
     GameUserSettings gameUserSettings = GameUserSettings();
+    // Before render, GL objects are untracked while it is destroyed
+    opengl::GpuMemory gpuMemory;
     opengl::Render render = opengl::Render();
     io::Event event = io::Event();
     Tick tick = Tick();
     Input input = Input();
+    resources::ResourceManager resourceManager;
+    jobs::JobSystem jobSystem;
 }
\ No newline at end of file
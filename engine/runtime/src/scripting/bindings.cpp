@@ -0,0 +1,510 @@
+#include "scripting/bindings.h"
+#include "scripting/script_system.h"
+#include "ecs/components.h"
+#include "runtime.h"
+#include <lua.h>
+#include <lualib.h>
+#include <cstring>
+#include <new>
+#include <string_view>
+
+namespace runa::runtime::scripting
+{
+    namespace
+    {
+        ScriptSystem& systemOf(lua_State* L)
+        {
+            return *static_cast<ScriptSystem*>(lua_callbacks(L)->userdata);
+        }
+
+        ecs::Transform& checkTransform(lua_State* L, int index, bool write)
+        {
+            ecs::Entity entity = checkEntity(L, index);
+            ecs::World* world = systemOf(L).getWorld();
+            // Reads do not mark the chunk changed, TransformSystem only recomposes what was written
+            ecs::Transform* transform = !world ? nullptr
+                : write ? world->get<ecs::Transform>(entity) : const_cast<ecs::Transform*>(world->read<ecs::Transform>(entity));
+            if (!transform) luaL_error(L, "entity has no Transform");
+            return *transform;
+        }
+
+        void pushVector(lua_State* L, const glm::vec3& value)
+        {
+            lua_pushvector(L, value.x, value.y, value.z);
+        }
+
+        glm::vec3 checkVector(lua_State* L, int index)
+        {
+            const float* value = luaL_checkvector(L, index);
+            return glm::vec3(value[0], value[1], value[2]);
+        }
+
+        // Under a deferred system the world is read only while scripts run, the write is recorded for
+        // the owner to apply. False when it should be done now
+        bool defer(lua_State* L, EScriptWrite op, float x, float y, float z, float w = 0.0f)
+        {
+            ScriptSystem& system = systemOf(L);
+            if (!system.isDeferred()) return false;
+            // Same error as an immediate write
+            checkTransform(L, 1, false);
+            float value[4] = { x, y, z, w };
+            system.deferWrite(op, checkEntity(L, 1), value);
+            return true;
+        }
+
+        int transformPosition(lua_State* L)
+        {
+            pushVector(L, checkTransform(L, 1, false).position);
+            return 1;
+        }
+
+        int transformSetPosition(lua_State* L)
+        {
+            glm::vec3 position = checkVector(L, 2);
+            if (!defer(L, writePosition, position.x, position.y, position.z)) checkTransform(L, 1, true).position = position;
+            return 0;
+        }
+
+        int transformTranslate(lua_State* L)
+        {
+            glm::vec3 offset = checkVector(L, 2);
+            if (!defer(L, writeTranslate, offset.x, offset.y, offset.z)) checkTransform(L, 1, true).position += offset;
+            return 0;
+        }
+
+        // x, y, z, w, vectors only have three lanes
+        int transformRotation(lua_State* L)
+        {
+            const glm::quat& rotation = checkTransform(L, 1, false).rotation;
+            lua_pushnumber(L, rotation.x);
+            lua_pushnumber(L, rotation.y);
+            lua_pushnumber(L, rotation.z);
+            lua_pushnumber(L, rotation.w);
+            return 4;
+        }
+
+        int transformSetRotation(lua_State* L)
+        {
+            glm::quat rotation((float)luaL_checknumber(L, 5), (float)luaL_checknumber(L, 2), (float)luaL_checknumber(L, 3), (float)luaL_checknumber(L, 4));
+            if (!defer(L, writeRotation, rotation.x, rotation.y, rotation.z, rotation.w)) checkTransform(L, 1, true).rotation = glm::normalize(rotation);
+            return 0;
+        }
+
+        int transformScale(lua_State* L)
+        {
+            pushVector(L, checkTransform(L, 1, false).scale);
+            return 1;
+        }
+
+        int transformSetScale(lua_State* L)
+        {
+            glm::vec3 scale = checkVector(L, 2);
+            if (!defer(L, writeScale, scale.x, scale.y, scale.z)) checkTransform(L, 1, true).scale = scale;
+            return 0;
+        }
+
+        // Methods of TransformView, the VM tags their names with these atoms when it interns them so
+        // __namecall switches on an integer instead of comparing strings
+        enum EViewAtom : int16_t
+        {
+            countAtom = 0,
+            entityAtom,
+            positionsAtom,
+            setPositionsAtom,
+            rotationsAtom,
+            setRotationsAtom,
+            scalesAtom,
+            setScalesAtom,
+            viewAtoms
+        };
+
+        constexpr std::string_view viewMethods[viewAtoms] = {
+            "count", "entity", "positions", "setPositions", "rotations", "setRotations", "scales", "setScales"
+        };
+
+        int16_t atomOf(const char* name, size_t length)
+        {
+            std::string_view string(name, length);
+            for (int16_t atom = 0; atom < viewAtoms; atom++)
+            {
+                if (viewMethods[atom] == string) return atom;
+            }
+            return -1;
+        }
+
+        // Every entity with a Transform, in chunk order. Holds nothing, the world is read on each call,
+        // so a script keeps one view for its lifetime
+        struct TransformView
+        {
+            uint32_t reserved = 0;
+        };
+
+        // Reads go through readChunks, scripts of several systems may walk the world at once
+        uint32_t countTransforms(const ecs::World& world)
+        {
+            uint32_t count = 0;
+            world.readChunks<const ecs::Transform>([&count](const ecs::Entity*, uint32_t chunkCount, const ecs::Transform*) { count += chunkCount; });
+            return count;
+        }
+
+        ecs::World& checkWorld(lua_State* L)
+        {
+            ecs::World* world = systemOf(L).getWorld();
+            if (!world) luaL_error(L, "scripts have no world");
+            return *world;
+        }
+
+        // Buffer at index holding stride bytes per transform, raises an error when it is too small
+        std::byte* checkBuffer(lua_State* L, int index, ecs::World& world, size_t stride, uint32_t& count)
+        {
+            size_t length = 0;
+            void* data = luaL_checkbuffer(L, index, &length);
+            count = countTransforms(world);
+            if (length < (size_t)count * stride) luaL_error(L, "buffer holds %d transforms, %d needed", (int)(length / stride), (int)count);
+            return static_cast<std::byte*>(data);
+        }
+
+        // Copies a member of every transform into the buffer as packed floats, one chunk at a time
+        template <typename F>
+        int gather(lua_State* L, size_t stride, F&& write)
+        {
+            ecs::World& world = checkWorld(L);
+            uint32_t count;
+            std::byte* out = checkBuffer(L, 2, world, stride, count);
+            world.readChunks<const ecs::Transform>([&](const ecs::Entity*, uint32_t chunkCount, const ecs::Transform* transforms) {
+                for (uint32_t i = 0; i < chunkCount; i++, out += stride) write(out, transforms[i]);
+            });
+            lua_pushunsigned(L, count);
+            return 1;
+        }
+
+        using ReadFunction = void (*)(const std::byte* in, ecs::Transform& transform);
+
+        void readPosition(const std::byte* in, ecs::Transform& transform)
+        {
+            std::memcpy(&transform.position, in, sizeof(glm::vec3));
+        }
+
+        void readRotation(const std::byte* in, ecs::Transform& transform)
+        {
+            float rotation[4];
+            std::memcpy(rotation, in, sizeof(rotation));
+            transform.rotation = glm::quat(rotation[3], rotation[0], rotation[1], rotation[2]);
+        }
+
+        void readScale(const std::byte* in, ecs::Transform& transform)
+        {
+            std::memcpy(&transform.scale, in, sizeof(glm::vec3));
+        }
+
+        // Copies count packed values into the transforms, in the order the gathers wrote them
+        void scatterInto(ecs::World& world, const std::byte* in, size_t stride, uint32_t count, ReadFunction read)
+        {
+            world.eachChunk<ecs::Transform>([&](const ecs::Entity*, uint32_t chunkCount, ecs::Transform* transforms) {
+                for (uint32_t i = 0; i < chunkCount && count > 0; i++, count--, in += stride) read(in, transforms[i]);
+            });
+        }
+
+        int scatter(lua_State* L, size_t stride, EScriptWrite op, ReadFunction read)
+        {
+            ecs::World& world = checkWorld(L);
+            uint32_t count;
+            const std::byte* in = checkBuffer(L, 2, world, stride, count);
+            ScriptSystem& system = systemOf(L);
+            if (system.isDeferred()) system.deferWrite(op, in, (size_t)count * stride);
+            else scatterInto(world, in, stride, count, read);
+            return 0;
+        }
+
+        int viewEntity(lua_State* L)
+        {
+            ecs::World& world = checkWorld(L);
+            uint32_t index = luaL_checkunsigned(L, 2);
+            ecs::Entity found;
+            world.readChunks<const ecs::Transform>([&](const ecs::Entity* entities, uint32_t chunkCount, const ecs::Transform*) {
+                if (!found.isValid() && index < chunkCount) found = entities[index];
+                else if (!found.isValid()) index -= chunkCount;
+            });
+            if (found.isValid()) pushEntity(L, found);
+            else lua_pushnil(L);
+            return 1;
+        }
+
+        int viewNamecall(lua_State* L)
+        {
+            // The tag check is a compare, luaL_checkudata would look the metatable up by name
+            if (!lua_touserdatatagged(L, 1, viewTag)) luaL_typeerror(L, 1, "TransformView");
+            int atom = -1;
+            const char* name = lua_namecallatom(L, &atom);
+            switch (atom)
+            {
+            case countAtom:
+                lua_pushunsigned(L, countTransforms(checkWorld(L)));
+                return 1;
+            case entityAtom:
+                return viewEntity(L);
+            case positionsAtom:
+                return gather(L, sizeof(glm::vec3), [](std::byte* out, const ecs::Transform& transform) { std::memcpy(out, &transform.position, sizeof(glm::vec3)); });
+            case setPositionsAtom:
+                return scatter(L, sizeof(glm::vec3), writePositions, readPosition);
+            case rotationsAtom:
+                return gather(L, 4 * sizeof(float), [](std::byte* out, const ecs::Transform& transform) {
+                    float rotation[4] = { transform.rotation.x, transform.rotation.y, transform.rotation.z, transform.rotation.w };
+                    std::memcpy(out, rotation, sizeof(rotation));
+                });
+            case setRotationsAtom:
+                return scatter(L, 4 * sizeof(float), writeRotations, readRotation);
+            case scalesAtom:
+                return gather(L, sizeof(glm::vec3), [](std::byte* out, const ecs::Transform& transform) { std::memcpy(out, &transform.scale, sizeof(glm::vec3)); });
+            case setScalesAtom:
+                return scatter(L, sizeof(glm::vec3), writeScales, readScale);
+            default:
+                luaL_error(L, "%s is not a method of TransformView", name ? name : "?");
+            }
+        }
+
+        int transformView(lua_State* L)
+        {
+            new (lua_newuserdatataggedwithmetatable(L, sizeof(TransformView), viewTag)) TransformView();
+            return 1;
+        }
+
+        const luaL_Reg transformLib[] = {
+            { "view", transformView },
+            { "position", transformPosition },
+            { "setPosition", transformSetPosition },
+            { "translate", transformTranslate },
+            { "rotation", transformRotation },
+            { "setRotation", transformSetRotation },
+            { "scale", transformScale },
+            { "setScale", transformSetScale },
+            { nullptr, nullptr },
+        };
+
+        // Names are resolved once, scripts keep the code and pass it every frame
+        int inputKey(lua_State* L)
+        {
+            SDL_Scancode scancode = SDL_GetScancodeFromName(luaL_checkstring(L, 1));
+            if (scancode == SDL_SCANCODE_UNKNOWN) luaL_error(L, "unknown key %s", lua_tostring(L, 1));
+            lua_pushinteger(L, scancode);
+            return 1;
+        }
+
+        SDL_Scancode checkScancode(lua_State* L, int index)
+        {
+            return (SDL_Scancode)luaL_checkinteger(L, index);
+        }
+
+        int inputHeld(lua_State* L)
+        {
+            lua_pushboolean(L, input.keyHeld(checkScancode(L, 1)));
+            return 1;
+        }
+
+        int inputPressed(lua_State* L)
+        {
+            lua_pushboolean(L, input.keyPressed(checkScancode(L, 1)));
+            return 1;
+        }
+
+        int inputReleased(lua_State* L)
+        {
+            lua_pushboolean(L, input.keyReleased(checkScancode(L, 1)));
+            return 1;
+        }
+
+        int inputAxis(lua_State* L)
+        {
+            lua_pushnumber(L, input.inputAxis(checkScancode(L, 1), checkScancode(L, 2)));
+            return 1;
+        }
+
+        // nil when no action has the name
+        int inputAction(lua_State* L)
+        {
+            InputAction action = input.findAction(luaL_checkstring(L, 1));
+            if (action == UINT16_MAX) lua_pushnil(L);
+            else lua_pushinteger(L, action);
+            return 1;
+        }
+
+        int inputActionHeld(lua_State* L)
+        {
+            lua_pushboolean(L, input.actionHeld((InputAction)luaL_checkinteger(L, 1)));
+            return 1;
+        }
+
+        int inputActionPressed(lua_State* L)
+        {
+            lua_pushboolean(L, input.actionPressed((InputAction)luaL_checkinteger(L, 1)));
+            return 1;
+        }
+
+        int inputActionReleased(lua_State* L)
+        {
+            lua_pushboolean(L, input.actionReleased((InputAction)luaL_checkinteger(L, 1)));
+            return 1;
+        }
+
+        const luaL_Reg inputLib[] = {
+            { "key", inputKey },
+            { "held", inputHeld },
+            { "pressed", inputPressed },
+            { "released", inputReleased },
+            { "axis", inputAxis },
+            { "action", inputAction },
+            { "actionHeld", inputActionHeld },
+            { "actionPressed", inputActionPressed },
+            { "actionReleased", inputActionReleased },
+            { nullptr, nullptr },
+        };
+
+        int startTimer(lua_State* L, bool repeat)
+        {
+            double seconds = luaL_checknumber(L, 1);
+            luaL_checktype(L, 2, LUA_TFUNCTION);
+            if (repeat && seconds <= 0.0) luaL_argerror(L, 1, "interval must be positive");
+            int callback = lua_ref(L, 2);
+            lua_pushunsigned(L, systemOf(L).addTimer(L, seconds, repeat ? seconds : 0.0, callback));
+            return 1;
+        }
+
+        int timerAfter(lua_State* L)
+        {
+            return startTimer(L, false);
+        }
+
+        int timerEvery(lua_State* L)
+        {
+            return startTimer(L, true);
+        }
+
+        int timerCancel(lua_State* L)
+        {
+            systemOf(L).cancelTimer(luaL_checkunsigned(L, 1));
+            return 0;
+        }
+
+        // Script clock in seconds, it only moves with ScriptSystem::update
+        int timerNow(lua_State* L)
+        {
+            lua_pushnumber(L, systemOf(L).getTime());
+            return 1;
+        }
+
+        const luaL_Reg timerLib[] = {
+            { "after", timerAfter },
+            { "every", timerEvery },
+            { "cancel", timerCancel },
+            { "now", timerNow },
+            { nullptr, nullptr },
+        };
+
+        // send(to, name, value), value is nil, a boolean, a number or a vector. The scripts on to get
+        // onMessage(from, name, value) next update, scripts never touch another VM directly
+        int messageSend(lua_State* L)
+        {
+            ScriptMessage message;
+            message.to = checkEntity(L, 1);
+            size_t length = 0;
+            const char* name = luaL_checklstring(L, 2, &length);
+            message.name = MessageRegistry::id(std::string_view(name, length));
+            message.type = lua_type(L, 3);
+            switch (message.type)
+            {
+            case LUA_TNONE:
+                message.type = LUA_TNIL;
+                break;
+            case LUA_TNIL:
+                break;
+            case LUA_TBOOLEAN:
+                message.number = lua_toboolean(L, 3) ? 1.0 : 0.0;
+                break;
+            case LUA_TNUMBER:
+                message.number = lua_tonumber(L, 3);
+                break;
+            case LUA_TVECTOR:
+                std::memcpy(message.vector, lua_tovector(L, 3), sizeof(message.vector));
+                break;
+            default:
+                luaL_typeerror(L, 3, "nil, boolean, number or vector");
+            }
+            systemOf(L).send(std::move(message));
+            return 0;
+        }
+
+        const luaL_Reg messageLib[] = {
+            { "send", messageSend },
+            { nullptr, nullptr },
+        };
+    }
+
+    // Index and generation fill the 64 bits of the pointer
+    static_assert(sizeof(void*) == sizeof(uint64_t), "Entities are packed into light userdata");
+
+    void pushEntity(lua_State* L, ecs::Entity entity)
+    {
+        lua_pushlightuserdatatagged(L, reinterpret_cast<void*>((uintptr_t)(((uint64_t)entity.generation << 32) | entity.index)), entityTag);
+    }
+
+    ecs::Entity checkEntity(lua_State* L, int index)
+    {
+        if (lua_type(L, index) != LUA_TLIGHTUSERDATA || lua_lightuserdatatag(L, index) != entityTag) luaL_typeerror(L, index, "entity");
+        uint64_t packed = (uint64_t)reinterpret_cast<uintptr_t>(lua_tolightuserdatatagged(L, index, entityTag));
+        return { (uint32_t)packed, (uint32_t)(packed >> 32) };
+    }
+
+    void openEngineLibs(lua_State* L)
+    {
+        lua_callbacks(L)->useratom = atomOf;
+        lua_setlightuserdataname(L, entityTag, "entity");
+
+        // Shared by every view through its tag
+        lua_newtable(L);
+        lua_pushcfunction(L, viewNamecall, "TransformView.__namecall");
+        lua_setfield(L, -2, "__namecall");
+        lua_pushstring(L, "TransformView");
+        lua_setfield(L, -2, "__type");
+        lua_setreadonly(L, -1, true);
+        lua_setuserdatametatable(L, viewTag);
+
+        // Registered before luaL_sandbox marks the globals safe, transform.position then compiles to an
+        // import resolved once when the script loads instead of two table lookups per call
+        luaL_register(L, "transform", transformLib);
+        luaL_register(L, "input", inputLib);
+        luaL_register(L, "timer", timerLib);
+        luaL_register(L, "message", messageLib);
+        lua_pop(L, 4);
+    }
+
+    void applyWrite(ecs::World& world, const ScriptWrite& write, const std::byte* payload)
+    {
+        const float* value = write.value;
+        switch (write.op)
+        {
+        case writePositions:
+            scatterInto(world, payload + write.offset, sizeof(glm::vec3), write.size / sizeof(glm::vec3), readPosition);
+            return;
+        case writeRotations:
+            scatterInto(world, payload + write.offset, 4 * sizeof(float), write.size / (4 * sizeof(float)), readRotation);
+            return;
+        case writeScales:
+            scatterInto(world, payload + write.offset, sizeof(glm::vec3), write.size / sizeof(glm::vec3), readScale);
+            return;
+        default:
+            break;
+        }
+
+        // Destroyed since it was recorded
+        ecs::Transform* transform = world.get<ecs::Transform>(write.entity);
+        if (!transform) return;
+        switch (write.op)
+        {
+        case writePosition: transform->position = glm::vec3(value[0], value[1], value[2]); break;
+        case writeTranslate: transform->position += glm::vec3(value[0], value[1], value[2]); break;
+        case writeRotation: transform->rotation = glm::normalize(glm::quat(value[3], value[0], value[1], value[2])); break;
+        case writeScale: transform->scale = glm::vec3(value[0], value[1], value[2]); break;
+        default: break;
+        }
+    }
+}
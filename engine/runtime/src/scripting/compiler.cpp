@@ -0,0 +1,36 @@
+#include "scripting/compiler.h"
+#include <luacode.h>
+#include <cstdlib>
+
+namespace runa::runtime::scripting
+{
+    bool compile(std::string_view source, std::string& bytecode, std::string& error)
+    {
+        lua_CompileOptions options = {};
+        // Inlining and constant folding, keeps line info for error messages
+        options.optimizationLevel = 2;
+        options.debugLevel = 1;
+
+        size_t size = 0;
+        char* data = luau_compile(source.data(), source.size(), &options, &size);
+        if (!data)
+        {
+            error = "out of memory";
+            return false;
+        }
+
+        // A failed compile returns a 0 version byte followed by the message
+        bool compiled = size > 0 && data[0] != 0;
+        if (compiled) bytecode.assign(data, size);
+        else error.assign(size > 1 ? data + 1 : "", size > 1 ? size - 1 : 0);
+        std::free(data);
+        return compiled;
+    }
+
+    std::string bytecodePath(std::string_view path)
+    {
+        std::string_view stem = path;
+        if (stem.ends_with(".luau")) stem.remove_suffix(5);
+        return std::string(stem) + bytecodeExtension;
+    }
+}
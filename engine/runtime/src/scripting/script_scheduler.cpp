@@ -0,0 +1,200 @@
+#include "scripting/script_scheduler.h"
+#include "scripting/bindings.h"
+#include "utils/profiler.h"
+#include <SDL3/SDL_timer.h>
+#include <algorithm>
+
+namespace runa::runtime::scripting
+{
+    namespace
+    {
+        uint64_t keyOf(ecs::Entity entity)
+        {
+            return ((uint64_t)entity.generation << 32) | entity.index;
+        }
+    }
+
+    ScriptScheduler::~ScriptScheduler()
+    {
+        deinit();
+    }
+
+    bool ScriptScheduler::init(ecs::World* initWorld, jobs::JobSystem* initJobs, uint32_t vmCount)
+    {
+        if (!vms.empty()) return true;
+
+        world = initWorld;
+        jobs = initJobs && initJobs->isInitialized() ? initJobs : nullptr;
+        if (vmCount == 0) vmCount = jobs ? jobs->getWorkerCount() : 1;
+
+        for (uint32_t i = 0; i < vmCount; i++)
+        {
+            auto vm = std::make_unique<ScriptSystem>();
+            if (!vm->init(world, true))
+            {
+                deinit();
+                return false;
+            }
+            vms.push_back(std::move(vm));
+        }
+        loads.assign(vmCount, 0);
+        return true;
+    }
+
+    void ScriptScheduler::deinit()
+    {
+        vms.clear();
+        loads.clear();
+        owners.clear();
+        routes.clear();
+        pending.clear();
+        world = nullptr;
+        jobs = nullptr;
+    }
+
+    ScriptId ScriptScheduler::load(const char* path, ecs::Entity entity)
+    {
+        if (vms.empty()) return noScript;
+
+        uint32_t vm = pick(entity);
+        return added(vms[vm]->load(path, entity, nextScript), vm, entity);
+    }
+
+    ScriptId ScriptScheduler::loadBytecode(const char* name, const std::string& bytecode, ecs::Entity entity)
+    {
+        if (vms.empty()) return noScript;
+
+        uint32_t vm = pick(entity);
+        return added(vms[vm]->loadBytecode(name, bytecode, entity, nextScript), vm, entity);
+    }
+
+    void ScriptScheduler::unload(ScriptId id)
+    {
+        auto it = owners.find(id);
+        if (it == owners.end()) return;
+
+        auto [vm, entity] = it->second;
+        vms[vm]->unload(id);
+        loads[vm]--;
+        auto route = routes.find(keyOf(entity));
+        if (route != routes.end() && --route->second.scripts == 0) routes.erase(route);
+        owners.erase(it);
+    }
+
+    void ScriptScheduler::update(double delta)
+    {
+        if (vms.empty()) return;
+
+        RUNA_PROFILE_ZONE("ScriptScheduler::update");
+        uint64_t start = SDL_GetTicksNS();
+        // VMs share nothing, one job each
+        auto run = [this, delta](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) vms[i]->update(delta);
+        };
+        if (jobs) jobs->parallelFor((uint32_t)vms.size(), run, 1);
+        else run(0, (uint32_t)vms.size());
+
+        uint64_t ran = SDL_GetTicksNS();
+        applyWrites();
+        routeMessages();
+        for (std::unique_ptr<ScriptSystem>& vm : vms) vm->clearDeferred();
+
+        uint64_t end = SDL_GetTicksNS();
+        applyNS = end - ran;
+        updateNS = end - start;
+    }
+
+    ScriptStats ScriptScheduler::getStats() const
+    {
+        ScriptStats stats;
+        for (const std::unique_ptr<ScriptSystem>& vm : vms)
+        {
+            ScriptStats vmStats = vm->getStats();
+            stats.scripts += vmStats.scripts;
+            stats.timers += vmStats.timers;
+            stats.memoryBytes += vmStats.memoryBytes;
+            stats.errors += vmStats.errors;
+        }
+        stats.vms = (uint32_t)vms.size();
+        stats.updateNS = updateNS;
+        stats.applyNS = applyNS;
+        stats.writes = writes;
+        stats.messages = messages;
+        return stats;
+    }
+
+    uint32_t ScriptScheduler::pick(ecs::Entity entity)
+    {
+        // Messages to an entity reach all of its scripts in one VM
+        if (entity.isValid())
+        {
+            auto route = routes.find(keyOf(entity));
+            if (route != routes.end()) return route->second.vm;
+        }
+        return (uint32_t)(std::min_element(loads.begin(), loads.end()) - loads.begin());
+    }
+
+    ScriptId ScriptScheduler::added(ScriptId id, uint32_t vm, ecs::Entity entity)
+    {
+        if (id == noScript) return noScript;
+
+        nextScript = id + 1;
+        loads[vm]++;
+        owners[id] = { vm, entity };
+        if (entity.isValid())
+        {
+            Route& route = routes[keyOf(entity)];
+            route.vm = vm;
+            route.scripts++;
+        }
+        return id;
+    }
+
+    void ScriptScheduler::applyWrites()
+    {
+        pending.clear();
+        for (uint32_t vm = 0; vm < vms.size(); vm++)
+        {
+            const std::vector<ScriptWrite>& recorded = vms[vm]->getWrites();
+            for (uint32_t i = 0; i < recorded.size(); i++) pending.push_back({ recorded[i].script, vm, i });
+        }
+        sortPending();
+
+        // A later script overwrites an earlier one, the same way it would on a single VM
+        for (const Pending& write : pending)
+        {
+            applyWrite(*world, vms[write.vm]->getWrites()[write.index], vms[write.vm]->getPayload());
+        }
+        writes = pending.size();
+    }
+
+    void ScriptScheduler::routeMessages()
+    {
+        pending.clear();
+        for (uint32_t vm = 0; vm < vms.size(); vm++)
+        {
+            const std::vector<ScriptMessage>& sent = vms[vm]->getOutbox();
+            for (uint32_t i = 0; i < sent.size(); i++) pending.push_back({ sent[i].sender, vm, i });
+        }
+        sortPending();
+
+        // Posted in sender order, the VM of the receiver delivers them at the start of the next update
+        messages = 0;
+        for (const Pending& message : pending)
+        {
+            const ScriptMessage& sent = vms[message.vm]->getOutbox()[message.index];
+            auto route = routes.find(keyOf(sent.to));
+            if (route == routes.end()) continue;
+            vms[route->second.vm]->post(sent);
+            messages++;
+        }
+    }
+
+    void ScriptScheduler::sortPending()
+    {
+        // A script's entries all come from one VM, their index keeps the order it recorded them in
+        std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+            return a.script != b.script ? a.script < b.script : a.index < b.index;
+        });
+    }
+}
@@ -0,0 +1,411 @@
+#include "scripting/script_system.h"
+#include "scripting/compiler.h"
+#include "scripting/bindings.h"
+#include "utils/logs.h"
+#include "utils/profiler.h"
+#include "utils/system.h"
+#include "utils/hash.h"
+#include "config.h"
+#include <lua.h>
+#include <lualib.h>
+#include <SDL3/SDL_timer.h>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#if defined(ENGINE_SCRIPT_COMPILER)
+#include <filesystem>
+#endif
+
+namespace runa::runtime::scripting
+{
+    namespace
+    {
+        uint64_t keyOf(ecs::Entity entity)
+        {
+            return ((uint64_t)entity.generation << 32) | entity.index;
+        }
+
+        // Looks names up by string_view, a known name costs no allocation
+        struct NameHash
+        {
+            using is_transparent = void;
+            size_t operator()(std::string_view name) const { return (size_t)utils::hash(name); }
+        };
+
+        struct MessageNames
+        {
+            std::shared_mutex mutex;
+            std::unordered_map<std::string, MessageName, NameHash, std::equal_to<>> ids;
+            // A deque never moves its strings, views of them stay valid
+            std::deque<std::string> names;
+        };
+
+        MessageNames& messageNames()
+        {
+            static MessageNames table;
+            return table;
+        }
+    }
+
+    MessageName MessageRegistry::id(std::string_view name)
+    {
+        MessageNames& table = messageNames();
+        {
+            std::shared_lock lock(table.mutex);
+            auto found = table.ids.find(name);
+            if (found != table.ids.end()) return found->second;
+        }
+
+        // Another thread may have added it between the locks
+        std::unique_lock lock(table.mutex);
+        auto [it, added] = table.ids.try_emplace(std::string(name), (MessageName)table.names.size());
+        if (added) table.names.emplace_back(name);
+        return it->second;
+    }
+
+    std::string_view MessageRegistry::name(MessageName id)
+    {
+        MessageNames& table = messageNames();
+        std::shared_lock lock(table.mutex);
+        return id < table.names.size() ? std::string_view(table.names[id]) : std::string_view();
+    }
+
+    ScriptSystem::~ScriptSystem()
+    {
+        deinit();
+    }
+
+    bool ScriptSystem::init(ecs::World* initWorld, bool deferWrites)
+    {
+        if (state) return true;
+
+        state = luaL_newstate();
+        if (!state)
+        {
+            utils::Logs::error("Failed to create the script VM");
+            return false;
+        }
+        world = initWorld;
+        deferred = deferWrites;
+        // Bindings find the system through the callbacks every thread of the VM shares
+        lua_callbacks(state)->userdata = this;
+
+        openEngineLibs(state);
+        luaL_openlibs(state);
+        // Libraries and globals turn read only, scripts write to their own thread globals
+        luaL_sandbox(state);
+        return true;
+    }
+
+    void ScriptSystem::deinit()
+    {
+        if (!state) return;
+        // Closing the VM frees the threads and every reference
+        scripts.clear();
+        timers.clear();
+        receivers.clear();
+        inbox.clear();
+        clearDeferred();
+        lua_close(state);
+        state = nullptr;
+        world = nullptr;
+        deferred = false;
+        time = 0.0;
+    }
+
+    ScriptId ScriptSystem::load(const char* path, ecs::Entity entity, ScriptId id)
+    {
+        if (!state) return noScript;
+
+        std::string bytecode;
+        if (!readBytecode(path, bytecode)) return noScript;
+        return loadBytecode(path, bytecode, entity, id);
+    }
+
+    ScriptId ScriptSystem::loadBytecode(const char* name, const std::string& bytecode, ecs::Entity entity, ScriptId id)
+    {
+        if (!state) return noScript;
+        if (id != noScript && find(id))
+        {
+            utils::Logs::error("Script %s: id %u is taken", name, id);
+            return noScript;
+        }
+
+        Script script;
+        script.id = id != noScript ? id : nextScript;
+        nextScript = std::max(nextScript, script.id + 1);
+        script.name = name;
+        script.entity = entity;
+        script.thread = lua_newthread(state);
+        script.threadRef = lua_ref(state, -1);
+        lua_pop(state, 1);
+        // Fresh globals that fall back to the read only ones
+        luaL_sandboxthread(script.thread);
+
+        pushEntity(script.thread, entity);
+        lua_setglobal(script.thread, "entity");
+
+        std::string chunkname = "@" + script.name;
+        if (luau_load(script.thread, chunkname.c_str(), bytecode.data(), bytecode.size(), 0) != 0)
+        {
+            utils::Logs::error("Failed to load script %s: %s", name, lua_tostring(script.thread, -1));
+            release(script);
+            return noScript;
+        }
+        // Top level code runs once, it defines update and onMessage and starts timers
+        current = script.id;
+        bool loaded = call(script.thread, 0, script.name);
+        current = noScript;
+        if (!loaded)
+        {
+            // Timers it started before failing die with it
+            for (Timer& timer : timers)
+            {
+                if (timer.script == script.id) cancelTimer(timer.id);
+            }
+            release(script);
+            return noScript;
+        }
+
+        lua_getglobal(script.thread, "update");
+        if (lua_isfunction(script.thread, -1)) script.updateRef = lua_ref(script.thread, -1);
+        lua_pop(script.thread, 1);
+        lua_getglobal(script.thread, "onMessage");
+        if (lua_isfunction(script.thread, -1))
+        {
+            script.messageRef = lua_ref(script.thread, -1);
+            receivers[keyOf(entity)].push_back(script.id);
+        }
+        lua_pop(script.thread, 1);
+
+        ScriptId added = script.id;
+        auto it = std::lower_bound(scripts.begin(), scripts.end(), added, [](const Script& other, ScriptId value) { return other.id < value; });
+        scripts.insert(it, std::move(script));
+        return added;
+    }
+
+    void ScriptSystem::unload(ScriptId id)
+    {
+        auto it = std::lower_bound(scripts.begin(), scripts.end(), id, [](const Script& script, ScriptId value) { return script.id < value; });
+        if (it == scripts.end() || it->id != id) return;
+        for (Timer& timer : timers)
+        {
+            if (timer.script == id) cancelTimer(timer.id);
+        }
+        if (it->messageRef != LUA_NOREF)
+        {
+            std::vector<ScriptId>& ids = receivers[keyOf(it->entity)];
+            ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+            if (ids.empty()) receivers.erase(keyOf(it->entity));
+        }
+        release(*it);
+        scripts.erase(it);
+    }
+
+    void ScriptSystem::update(double delta)
+    {
+        if (!state) return;
+
+        RUNA_PROFILE_ZONE("ScriptSystem::update");
+        uint64_t start = SDL_GetTicksNS();
+        // Deferred systems get their messages posted by the owner
+        if (!deferred) inbox.swap(outbox);
+        deliverMessages();
+        time += delta;
+        runTimers();
+        for (Script& script : scripts)
+        {
+            if (script.updateRef == LUA_NOREF) continue;
+            current = script.id;
+            lua_getref(script.thread, script.updateRef);
+            lua_pushnumber(script.thread, delta);
+            call(script.thread, 1, script.name);
+        }
+        current = noScript;
+        updateNS = SDL_GetTicksNS() - start;
+    }
+
+    void ScriptSystem::clearDeferred()
+    {
+        // Capacity stays and messages only hold interned names, once every name was sent a steady
+        // frame allocates nothing outside of the VM
+        writes.clear();
+        payload.clear();
+        outbox.clear();
+    }
+
+    uint32_t ScriptSystem::addTimer(lua_State* thread, double delay, double interval, int callback)
+    {
+        uint32_t id = nextTimer++;
+        timers.push_back({ id, current, thread, time + delay, interval, callback });
+        return id;
+    }
+
+    void ScriptSystem::cancelTimer(uint32_t id)
+    {
+        for (Timer& timer : timers)
+        {
+            if (timer.id != id || timer.callback == LUA_NOREF) continue;
+            // Erased by runTimers, a callback may be cancelling itself
+            lua_unref(state, timer.callback);
+            timer.callback = LUA_NOREF;
+        }
+    }
+
+    void ScriptSystem::deferWrite(EScriptWrite op, ecs::Entity entity, const float* value)
+    {
+        ScriptWrite& write = writes.emplace_back();
+        write.script = current;
+        write.op = op;
+        write.entity = entity;
+        std::memcpy(write.value, value, sizeof(write.value));
+    }
+
+    void ScriptSystem::deferWrite(EScriptWrite op, const void* data, size_t size)
+    {
+        ScriptWrite& write = writes.emplace_back();
+        write.script = current;
+        write.op = op;
+        write.offset = (uint32_t)payload.size();
+        write.size = (uint32_t)size;
+        payload.resize(payload.size() + size);
+        std::memcpy(payload.data() + write.offset, data, size);
+    }
+
+    void ScriptSystem::send(ScriptMessage&& message)
+    {
+        Script* script = find(current);
+        message.sender = current;
+        message.from = script ? script->entity : ecs::Entity();
+        outbox.push_back(std::move(message));
+    }
+
+    ScriptStats ScriptSystem::getStats() const
+    {
+        ScriptStats stats;
+        stats.scripts = scripts.size();
+        stats.timers = timers.size();
+        stats.updateNS = updateNS;
+        stats.errors = errors;
+        if (state) stats.memoryBytes = (size_t)lua_gc(state, LUA_GCCOUNT, 0) * 1024 + lua_gc(state, LUA_GCCOUNTB, 0);
+        return stats;
+    }
+
+    bool ScriptSystem::readBytecode(const char* path, std::string& bytecode)
+    {
+        std::string cooked = bytecodePath(path);
+#if defined(ENGINE_SCRIPT_COMPILER)
+        // Resources copied without the cook step, or a script added since
+        std::error_code code;
+        if (!std::filesystem::exists(cooked, code))
+        {
+            std::string source, error;
+            if (!utils::readTextFile(path, source)) return false;
+            if (!compile(source, bytecode, error))
+            {
+                utils::Logs::error("%s%s", path, error.c_str());
+                return false;
+            }
+            return true;
+        }
+#endif
+        std::vector<uint8_t> data;
+        if (!utils::readFile(cooked.c_str(), data))
+        {
+            utils::Logs::error("No cooked bytecode for script %s", path);
+            return false;
+        }
+        bytecode.assign(data.begin(), data.end());
+        return true;
+    }
+
+    ScriptSystem::Script* ScriptSystem::find(ScriptId id)
+    {
+        auto it = std::lower_bound(scripts.begin(), scripts.end(), id, [](const Script& script, ScriptId value) { return script.id < value; });
+        return it != scripts.end() && it->id == id ? &*it : nullptr;
+    }
+
+    void ScriptSystem::deliverMessages()
+    {
+        // Sent in order, each receiver sees them in the order they were sent
+        for (const ScriptMessage& message : inbox)
+        {
+            auto found = receivers.find(keyOf(message.to));
+            if (found == receivers.end()) continue;
+            for (ScriptId id : found->second)
+            {
+                Script* script = find(id);
+                if (!script || script->messageRef == LUA_NOREF) continue;
+
+                lua_State* thread = script->thread;
+                current = id;
+                lua_getref(thread, script->messageRef);
+                pushEntity(thread, message.from);
+                std::string_view name = MessageRegistry::name(message.name);
+                lua_pushlstring(thread, name.data(), name.size());
+                switch (message.type)
+                {
+                case LUA_TBOOLEAN: lua_pushboolean(thread, message.number != 0.0); break;
+                case LUA_TNUMBER: lua_pushnumber(thread, message.number); break;
+                case LUA_TVECTOR: lua_pushvector(thread, message.vector[0], message.vector[1], message.vector[2]); break;
+                default: lua_pushnil(thread); break;
+                }
+                call(thread, 3, script->name);
+            }
+        }
+        current = noScript;
+        inbox.clear();
+    }
+
+    void ScriptSystem::runTimers()
+    {
+        // Timers started by callbacks wait for the next update
+        size_t count = timers.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (timers[i].callback == LUA_NOREF || timers[i].due > time) continue;
+
+            int callback = timers[i].callback;
+            lua_State* thread = timers[i].thread;
+            current = timers[i].script;
+            if (timers[i].interval > 0.0)
+            {
+                // Keeps the cadence, a long frame fires once instead of catching up
+                timers[i].due = std::max(timers[i].due + timers[i].interval, time);
+            }
+            else
+            {
+                timers[i].callback = LUA_NOREF;
+            }
+
+            // On the thread of the script that started it, timers it starts belong to the same script
+            lua_getref(thread, callback);
+            if (timers[i].callback == LUA_NOREF) lua_unref(state, callback);
+            call(thread, 0, "timer");
+        }
+        current = noScript;
+        timers.erase(std::remove_if(timers.begin(), timers.end(), [](const Timer& timer) { return timer.callback == LUA_NOREF; }), timers.end());
+    }
+
+    bool ScriptSystem::call(lua_State* thread, int args, const std::string& name)
+    {
+        if (lua_pcall(thread, args, 0, 0) == LUA_OK) return true;
+        utils::Logs::error("Script %s: %s", name.c_str(), lua_tostring(thread, -1));
+        lua_pop(thread, 1);
+        errors++;
+        return false;
+    }
+
+    void ScriptSystem::release(Script& script)
+    {
+        if (script.updateRef != LUA_NOREF) lua_unref(state, script.updateRef);
+        if (script.messageRef != LUA_NOREF) lua_unref(state, script.messageRef);
+        if (script.threadRef != LUA_NOREF) lua_unref(state, script.threadRef);
+        script.updateRef = LUA_NOREF;
+        script.messageRef = LUA_NOREF;
+        script.threadRef = LUA_NOREF;
+        script.thread = nullptr;
+    }
+}
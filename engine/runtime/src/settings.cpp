@@ -6,13 +6,23 @@ using namespace runa::runtime;
 
 namespace runa::runtime {
     void GameUserSettings::setVsync(EVSync value) {
-        SDL_GL_SetSwapInterval((int)value);
+        vsync = value;
+        vsyncChanged = true;
     }
 
-    EVSync GameUserSettings::getVsync() {
-        int value = 0;
-        SDL_GL_GetSwapInterval(&value);
-        return (EVSync)value;
+    EVSync GameUserSettings::getVsync() const {
+        return vsync;
+    }
+
+    bool GameUserSettings::takeVsyncChange(EVSync& value) {
+        if (!vsyncChanged) return false;
+        vsyncChanged = false;
+        value = vsync;
+        return true;
+    }
+
+    void GameUserSettings::resetVsync(EVSync value) {
+        vsync = value;
     }
 
     void GameUserSettings::setFramerateLimit(uint16_t value) {
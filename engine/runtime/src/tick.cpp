@@ -1,4 +1,5 @@
 #include "tick.h"
+#include "utils/profiler.h"
 #include <SDL3/SDL_timer.h>
 
 namespace runa::runtime
@@ -10,7 +11,7 @@ namespace runa::runtime
 
     void Tick::updateDeltaTime()
     {
-        deltaTimeNS = SDL_GetTicksNS() - currentTickNS;
+        deltaTimeNS = frameDeltaNS > 0 ? frameDeltaNS : SDL_GetTicksNS() - currentTickNS;
     }
 
     uint64_t Tick::elapsedNS()
@@ -27,4 +28,64 @@ namespace runa::runtime
     {
         return double(deltaTimeNS) / 1000000000.0;
     }
+
+    void Tick::setFixedRate(uint32_t hz)
+    {
+        fixedRate = hz;
+        fixedStepNS = hz > 0 ? 1000000000 / hz : 0;
+        accumulatorNS = 0;
+        interpolation = 0.0;
+    }
+
+    void Tick::update()
+    {
+        RUNA_PROFILE_ZONE("Tick::update");
+        uint64_t now = SDL_GetTicksNS();
+        uint64_t elapsed = lastUpdateNS > 0 ? now - lastUpdateNS : 0;
+        lastUpdateNS = now;
+        if (frameDeltaNS > 0) elapsed = frameDeltaNS;
+
+        if (fixedStepNS == 0)
+        {
+            interpolation = 1.0;
+            if (onUpdate) onUpdate(delta(), interpolation);
+            return;
+        }
+
+        accumulatorNS += elapsed;
+        // Spiral of death, a slow frame must not schedule more work than the next one can do
+        uint64_t budget = fixedStepNS * maxSteps;
+        if (accumulatorNS > budget)
+        {
+            droppedNS += accumulatorNS - budget;
+            accumulatorNS = budget;
+        }
+
+        double step = fixedDelta();
+        while (accumulatorNS >= fixedStepNS)
+        {
+            if (onFixedUpdate)
+            {
+                RUNA_PROFILE_ZONE("Tick::fixedUpdate");
+                onFixedUpdate(step);
+            }
+            accumulatorNS -= fixedStepNS;
+            steps++;
+        }
+
+        interpolation = double(accumulatorNS) / double(fixedStepNS);
+        if (onUpdate) onUpdate(delta(), interpolation);
+    }
+
+    void Tick::simulate(uint64_t count)
+    {
+        if (fixedStepNS == 0) return;
+
+        double step = fixedDelta();
+        for (uint64_t i = 0; i < count; i++)
+        {
+            if (onFixedUpdate) onFixedUpdate(step);
+            steps++;
+        }
+    }
 }
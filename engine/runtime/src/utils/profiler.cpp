@@ -0,0 +1,218 @@
+#include "utils/profiler.h"
+#include "utils/logs.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+
+namespace runa::runtime::utils
+{
+    namespace
+    {
+        thread_local void* currentBuffer = nullptr;
+        // Kept until the thread records its first zone, naming a thread does not allocate its buffer
+        thread_local char currentName[32] = "";
+
+        void writeEscaped(SDL_IOStream* file, const char* text)
+        {
+            for (const char* c = text; *c; c++)
+            {
+                if (*c == '"' || *c == '\\') SDL_IOprintf(file, "\\%c", *c);
+                else if ((unsigned char)*c >= 0x20) SDL_IOprintf(file, "%c", *c);
+            }
+        }
+    }
+
+    Profiler::~Profiler() = default;
+
+    void Profiler::setThreadName(const char* name)
+    {
+        SDL_strlcpy(currentName, name, sizeof(currentName));
+        if (!currentBuffer) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        static_cast<ThreadBuffer*>(currentBuffer)->name = currentName;
+    }
+
+    void Profiler::begin(const char* name)
+    {
+        ThreadBuffer* buffer = threadBuffer();
+        // Deeper zones are dropped, end() still has to balance them
+        if (buffer->depth < maxDepth)
+        {
+            buffer->open[buffer->depth] = { name, SDL_GetTicksNS() };
+        }
+        buffer->depth++;
+    }
+
+    void Profiler::end()
+    {
+        ThreadBuffer* buffer = threadBuffer();
+        if (buffer->depth == 0) return;
+
+        buffer->depth--;
+        if (buffer->depth < maxDepth)
+        {
+            const OpenZone& zone = buffer->open[buffer->depth];
+            write(*buffer, zone.name, zone.startNS, SDL_GetTicksNS(), buffer->depth);
+        }
+    }
+
+    void Profiler::recordGpu(const char* name, uint64_t startNS, uint64_t endNS, uint32_t depth)
+    {
+        if (!gpu)
+        {
+            ThreadBuffer* buffer = createBuffer("GPU");
+            std::lock_guard<std::mutex> lock(mutex);
+            gpu = buffer;
+        }
+        write(*gpu, name, startNS, endNS, depth);
+    }
+
+    void Profiler::frame()
+    {
+        uint64_t index = frameCount.load(std::memory_order_relaxed);
+        frames[index % frameHistory].store(SDL_GetTicksNS(), std::memory_order_relaxed);
+        frameCount.store(index + 1, std::memory_order_release);
+    }
+
+    bool Profiler::lastFrames(uint32_t count, uint64_t& startNS, uint64_t& endNS) const
+    {
+        uint64_t marks = frameCount.load(std::memory_order_acquire);
+        if (marks < 2 || count == 0) return false;
+
+        uint64_t span = std::min<uint64_t>({ count, marks - 1, frameHistory - 1 });
+        startNS = frames[(marks - 1 - span) % frameHistory].load(std::memory_order_relaxed);
+        endNS = frames[(marks - 1) % frameHistory].load(std::memory_order_relaxed);
+        return true;
+    }
+
+    void Profiler::collect(uint64_t fromNS, uint64_t toNS, std::vector<ProfileTrack>& tracks)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tracks.resize(threads.size());
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            tracks[i].id = threads[i]->id;
+            tracks[i].name = threads[i]->name;
+            tracks[i].events.clear();
+            read(*threads[i], fromNS, toNS, tracks[i].events);
+        }
+    }
+
+    bool Profiler::exportChromeTrace(const char* path)
+    {
+        std::vector<ProfileTrack> tracks;
+        collect(0, UINT64_MAX, tracks);
+
+        SDL_IOStream* file = SDL_IOFromFile(path, "w");
+        if (!file)
+        {
+            Logs::sdlError();
+            return false;
+        }
+
+        SDL_IOprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        bool first = true;
+        for (const ProfileTrack& track : tracks)
+        {
+            SDL_IOprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                first ? "" : ",", track.id);
+            writeEscaped(file, track.name.c_str());
+            SDL_IOprintf(file, "\"}}");
+            first = false;
+
+            for (const ProfileEvent& event : track.events)
+            {
+                // Chrome wants microseconds
+                SDL_IOprintf(file, ",\n{\"name\":\"");
+                writeEscaped(file, event.name);
+                SDL_IOprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    track.id, event.startNS / 1000.0, (event.endNS - event.startNS) / 1000.0);
+            }
+        }
+        SDL_IOprintf(file, "\n]}\n");
+
+        if (!SDL_CloseIO(file))
+        {
+            Logs::sdlError();
+            return false;
+        }
+        return true;
+    }
+
+    Profiler::ThreadBuffer* Profiler::threadBuffer()
+    {
+        if (!currentBuffer)
+        {
+            if (currentName[0] == '\0')
+            {
+                SDL_snprintf(currentName, sizeof(currentName), "Thread %llu", (unsigned long long)SDL_GetCurrentThreadID());
+            }
+            currentBuffer = createBuffer(currentName);
+        }
+        return static_cast<ThreadBuffer*>(currentBuffer);
+    }
+
+    Profiler::ThreadBuffer* Profiler::createBuffer(const char* name)
+    {
+        // Never freed before the profiler, a thread may exit while its events are still shown
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->name = name;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer->id = (uint32_t)threads.size() + 1;
+        threads.push_back(std::move(buffer));
+        return threads.back().get();
+    }
+
+    void Profiler::write(ThreadBuffer& buffer, const char* name, uint64_t startNS, uint64_t endNS, uint32_t depth)
+    {
+        uint64_t head = buffer.head.load(std::memory_order_relaxed);
+        Slot& slot = buffer.slots[head % eventsPerThread];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.startNS.store(startNS, std::memory_order_relaxed);
+        slot.endNS.store(endNS, std::memory_order_relaxed);
+        slot.depth.store(depth, std::memory_order_relaxed);
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    void Profiler::read(const ThreadBuffer& buffer, uint64_t fromNS, uint64_t toNS, std::vector<ProfileEvent>& out)
+    {
+        uint64_t head = buffer.head.load(std::memory_order_acquire);
+        // Leave some room for the writer, slots close to it may change while we copy
+        constexpr uint64_t margin = 64;
+        uint64_t available = eventsPerThread - margin;
+        uint64_t first = head > available ? head - available : 0;
+
+        // Slot of every copied event, to drop the ones the writer reached in the meantime
+        thread_local std::vector<uint64_t> indices;
+        indices.clear();
+
+        size_t base = out.size();
+        for (uint64_t i = first; i < head; i++)
+        {
+            const Slot& slot = buffer.slots[i % eventsPerThread];
+            ProfileEvent event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.startNS = slot.startNS.load(std::memory_order_relaxed);
+            event.endNS = slot.endNS.load(std::memory_order_relaxed);
+            event.depth = slot.depth.load(std::memory_order_relaxed);
+            if (event.endNS >= fromNS && event.startNS <= toNS)
+            {
+                out.push_back(event);
+                indices.push_back(i);
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t now = buffer.head.load(std::memory_order_relaxed);
+        if (now - first <= available) return;
+
+        uint64_t valid = now - available;
+        size_t kept = base;
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            if (indices[i] >= valid) out[kept++] = out[base + i];
+        }
+        out.resize(kept);
+    }
+}
@@ -1,6 +1,7 @@
 #include "utils/system.h"
 #include "utils/logs.h"
 #include <SDL3/SDL.h>
+#include <filesystem>
 
 #ifdef _WIN64
 const char PATH_SEPARATOR = '\\';
@@ -180,6 +181,15 @@ namespace runa::runtime::utils
         }
     }
 
+    std::string normalizePath(const char* path)
+    {
+        std::error_code code;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, code);
+        std::string normalized = code ? std::string(path) : canonical.lexically_normal().string();
+        nativeSeparator(normalized);
+        return normalized;
+    }
+
     std::string getHomeDir()
     {
         std::string homeDir;
@@ -0,0 +1,87 @@
+#include "scripting/compiler.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace runa::runtime;
+
+// runtime_cook <source dir> <output dir>
+// Compiles every .luau under the source directory to bytecode at the same relative path in the output
+// directory. Files whose bytecode is newer than the source are skipped
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::fprintf(stderr, "usage: runtime_cook <source dir> <output dir>\n");
+        return 1;
+    }
+
+    std::filesystem::path sourceDir = argv[1];
+    std::filesystem::path outputDir = argv[2];
+    std::error_code code;
+    bool isDirectory = std::filesystem::is_directory(sourceDir, code);
+    if (code && code != std::errc::no_such_file_or_directory)
+    {
+        std::fprintf(stderr, "Failed to read %s: %s\n", sourceDir.string().c_str(), code.message().c_str());
+        return 1;
+    }
+    // Nothing to cook
+    if (!isDirectory) return 0;
+
+    // Every filesystem call takes an error code, an unreadable directory fails the cook instead of throwing
+    int failed = 0;
+    int cooked = 0;
+    std::error_code walk;
+    std::filesystem::recursive_directory_iterator it(sourceDir, walk);
+    for (; !walk && it != std::filesystem::recursive_directory_iterator(); it.increment(walk))
+    {
+        const std::filesystem::directory_entry& entry = *it;
+        if (!entry.is_regular_file(code) || entry.path().extension() != ".luau") continue;
+
+        std::filesystem::path relative = std::filesystem::relative(entry.path(), sourceDir, code);
+        std::filesystem::file_time_type sourceTime;
+        if (!code) sourceTime = entry.last_write_time(code);
+        if (code)
+        {
+            std::fprintf(stderr, "Failed to read %s: %s\n", entry.path().string().c_str(), code.message().c_str());
+            failed++;
+            continue;
+        }
+        std::filesystem::path output = outputDir / scripting::bytecodePath(relative.generic_string());
+        if (std::filesystem::exists(output, code) && std::filesystem::last_write_time(output, code) >= sourceTime) continue;
+
+        std::ifstream input(entry.path(), std::ios::binary);
+        std::stringstream source;
+        source << input.rdbuf();
+
+        std::string bytecode, error;
+        if (!scripting::compile(source.str(), bytecode, error))
+        {
+            // Same format as compiler errors so IDEs can jump to the line
+            std::fprintf(stderr, "%s%s\n", entry.path().string().c_str(), error.c_str());
+            failed++;
+            continue;
+        }
+
+        std::filesystem::create_directories(output.parent_path(), code);
+        std::ofstream file(output, std::ios::binary | std::ios::trunc);
+        file.write(bytecode.data(), (std::streamsize)bytecode.size());
+        if (!file)
+        {
+            std::fprintf(stderr, "Failed to write %s\n", output.string().c_str());
+            failed++;
+            continue;
+        }
+        cooked++;
+    }
+
+    if (walk)
+    {
+        std::fprintf(stderr, "Failed to read %s: %s\n", sourceDir.string().c_str(), walk.message().c_str());
+        return 1;
+    }
+
+    std::printf("Cooked %d scripts, %d failed\n", cooked, failed);
+    return failed > 0 ? 1 : 0;
+}